@@ -20,6 +20,9 @@ if(BUILD_MQT_CORE_BINDINGS)
   find_package(pybind11 2.13 CONFIG REQUIRED)
 endif()
 
+# the DD package uses threads for parallelizing independent computations
+find_package(Threads REQUIRED)
+
 set(JSON_VERSION
     3.11.3
     CACHE STRING "nlohmann_json version")
@@ -7,6 +7,8 @@
 #include "algorithms/WState.hpp"
 #include "circuit_optimizer/CircuitOptimizer.hpp"
 #include "dd/FunctionalityConstruction.hpp"
+#include "dd/NoiseFunctionality.hpp"
+#include "dd/Operations.hpp"
 #include "dd/Package.hpp"
 #include "dd/Simulation.hpp"
 #include "dd/statistics/PackageStatistics.hpp"
@@ -17,6 +19,7 @@
 #include <chrono>
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <exception>
 #include <fstream>
 #include <ios>
@@ -24,8 +27,11 @@
 #include <map>
 #include <memory>
 #include <nlohmann/json.hpp>
+#include <random>
+#include <set>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace dd {
 
@@ -61,6 +67,27 @@ struct FunctionalityConstructionExperiment : public Experiment {
   }
 };
 
+struct ExportExperiment : public Experiment {
+  std::size_t amplitudes{};
+
+  [[nodiscard]] bool success() const noexcept override {
+    return amplitudes != 0U;
+  }
+
+  [[nodiscard]] double amplitudesPerSecond() const noexcept {
+    return static_cast<double>(amplitudes) / runtime.count();
+  }
+};
+
+struct NoiseExperiment : public Experiment {
+  std::unique_ptr<Package<DensityMatrixSimulatorDDPackageConfig>> densityDD;
+  dEdge state{};
+
+  [[nodiscard]] bool success() const noexcept override {
+    return state.p != nullptr;
+  }
+};
+
 template <class Config>
 MatrixDD buildFunctionality(const qc::Grover* qc, Package<Config>& dd) {
   QuantumComputation groverIteration(qc->getNqubits());
@@ -187,6 +214,155 @@ benchmarkFunctionalityConstruction(const QuantumComputation& qc,
   return exp;
 }
 
+std::unique_ptr<FunctionalityConstructionExperiment>
+benchmarkParallelFunctionalityConstruction(const QuantumComputation& qc,
+                                           const std::size_t nthreads) {
+  std::unique_ptr<FunctionalityConstructionExperiment> exp =
+      std::make_unique<FunctionalityConstructionExperiment>();
+  const auto nq = qc.getNqubits();
+  exp->dd = std::make_unique<Package<>>(nq);
+  const auto start = std::chrono::high_resolution_clock::now();
+  exp->func = buildFunctionalityParallel(&qc, *(exp->dd), nthreads);
+  const auto end = std::chrono::high_resolution_clock::now();
+  exp->runtime =
+      std::chrono::duration_cast<std::chrono::duration<double>>(end - start);
+  exp->stats = dd::getStatistics(exp->dd.get());
+  return exp;
+}
+
+std::unique_ptr<ExportExperiment>
+benchmarkVectorExport(const QuantumComputation& qc,
+                      const std::size_t nthreads) {
+  std::unique_ptr<ExportExperiment> exp = std::make_unique<ExportExperiment>();
+  const auto nq = qc.getNqubits();
+  exp->dd = std::make_unique<Package<>>(nq);
+  const auto in = exp->dd->makeZeroState(nq);
+  const auto state = simulate(&qc, in, *(exp->dd));
+  CVec vec(1ULL << nq);
+  const auto start = std::chrono::high_resolution_clock::now();
+  state.writeVector(vec.data(), 0., nthreads);
+  const auto end = std::chrono::high_resolution_clock::now();
+  exp->runtime =
+      std::chrono::duration_cast<std::chrono::duration<double>>(end - start);
+  exp->amplitudes = vec.size();
+  exp->stats = dd::getStatistics(exp->dd.get());
+  return exp;
+}
+
+std::unique_ptr<ExportExperiment>
+benchmarkMatrixExport(const QuantumComputation& qc,
+                      const std::size_t nthreads) {
+  std::unique_ptr<ExportExperiment> exp = std::make_unique<ExportExperiment>();
+  const auto nq = qc.getNqubits();
+  exp->dd = std::make_unique<Package<>>(nq);
+  const auto func = buildFunctionality(&qc, *(exp->dd));
+  const std::size_t dim = 1ULL << nq;
+  CVec mat(dim * dim);
+  const auto start = std::chrono::high_resolution_clock::now();
+  func.writeMatrix(nq, mat.data(), 0., nthreads);
+  const auto end = std::chrono::high_resolution_clock::now();
+  exp->runtime =
+      std::chrono::duration_cast<std::chrono::duration<double>>(end - start);
+  exp->amplitudes = mat.size();
+  exp->stats = dd::getStatistics(exp->dd.get());
+  return exp;
+}
+
+WeightedPauliSum randomPauliSum(const std::size_t nq, const std::size_t terms,
+                                const std::size_t seed) {
+  std::mt19937_64 mt(seed);
+  std::uniform_int_distribution<std::uint8_t> pauliDist(0U, 3U);
+  std::uniform_real_distribution<fp> coefficientDist(-1., 1.);
+  WeightedPauliSum observable(terms);
+  for (auto& [coefficient, pauli] : observable) {
+    coefficient = coefficientDist(mt);
+    pauli.resize(nq);
+    for (auto& p : pauli) {
+      p = static_cast<Pauli>(pauliDist(mt));
+    }
+  }
+  return observable;
+}
+
+std::unique_ptr<FunctionalityConstructionExperiment>
+benchmarkPauliSum(const WeightedPauliSum& observable, const std::size_t nq,
+                  const bool naive) {
+  std::unique_ptr<FunctionalityConstructionExperiment> exp =
+      std::make_unique<FunctionalityConstructionExperiment>();
+  exp->dd = std::make_unique<Package<>>(nq);
+  auto& dd = *(exp->dd);
+  const std::array matrices{I_MAT, X_MAT, Y_MAT, Z_MAT};
+  const auto start = std::chrono::high_resolution_clock::now();
+  if (naive) {
+    // sum up the Kronecker products of the single-qubit operators (appending
+    // one qubit at a time from the top)
+    auto sum = mEdge::zero();
+    for (const auto& [coefficient, pauli] : observable) {
+      auto term = dd.makeGateDD(
+          matrices[static_cast<std::size_t>(pauli[nq - 1U])], 0);
+      for (auto q = nq - 1U; q > 0U; --q) {
+        term = dd.kronecker(
+            term,
+            dd.makeGateDD(matrices[static_cast<std::size_t>(pauli[q - 1U])],
+                          0),
+            1U);
+      }
+      term.w = dd.cn.lookup(term.w * coefficient);
+      const auto tmp = dd.add(sum, term);
+      dd.incRef(tmp);
+      dd.decRef(sum);
+      sum = tmp;
+      dd.garbageCollect();
+    }
+    exp->func = sum;
+  } else {
+    exp->func = dd.makePauliSumDD(observable);
+  }
+  const auto end = std::chrono::high_resolution_clock::now();
+  exp->runtime =
+      std::chrono::duration_cast<std::chrono::duration<double>>(end - start);
+  exp->stats = dd::getStatistics(exp->dd.get());
+  return exp;
+}
+
+std::unique_ptr<NoiseExperiment>
+benchmarkNoisySimulation(const QuantumComputation& qc, const bool batched) {
+  const auto layers = groupIntoDisjointLayers(qc);
+
+  std::unique_ptr<NoiseExperiment> exp = std::make_unique<NoiseExperiment>();
+  const auto nq = qc.getNqubits();
+  exp->densityDD =
+      std::make_unique<Package<DensityMatrixSimulatorDDPackageConfig>>(nq);
+  auto& dd = *exp->densityDD;
+  auto noise = DeterministicNoiseFunctionality(exp->densityDD, nq, 0.001,
+                                               0.002, 0.002, 0.004, "APD");
+  const auto start = std::chrono::high_resolution_clock::now();
+  auto state = dd.makeZeroDensityOperator(nq);
+  dd.incRef(state);
+  for (const auto& layer : layers) {
+    std::vector<std::set<qc::Qubit>> usedQubits{};
+    for (const auto i : layer) {
+      const auto& op = qc.at(i);
+      dd.applyOperationToDensity(state, getDD(op.get(), dd));
+      if (batched) {
+        usedQubits.emplace_back(op->getUsedQubits());
+      } else {
+        noise.applyNoiseEffects(state, op);
+      }
+    }
+    if (batched) {
+      noise.applyNoiseEffects(state, usedQubits);
+    }
+    dd.garbageCollect();
+  }
+  exp->state = state;
+  const auto end = std::chrono::high_resolution_clock::now();
+  exp->runtime =
+      std::chrono::duration_cast<std::chrono::duration<double>>(end - start);
+  exp->stats = dd::getStatistics(exp->densityDD.get());
+  return exp;
+}
+
 std::map<std::string, std::size_t>
 benchmarkSimulateWithShots(const qc::QuantumComputation& qc,
                            const std::size_t shots) {
@@ -223,6 +399,9 @@ protected:
     auto& entry = j[name][type][std::to_string(qc.getNqubits())];
 
     entry["runtime"] = exp.runtime.count();
+    if (const auto* exportExp = dynamic_cast<const ExportExperiment*>(&exp)) {
+      entry["amplitudesPerSecond"] = exportExp->amplitudesPerSecond();
+    }
 
     // collect statistics from DD package
     entry["dd"] = exp.stats;
@@ -298,6 +477,8 @@ protected:
       auto qc = qc::QFT(nq, false);
       auto exp = benchmarkFunctionalityConstruction(qc);
       verifyAndSave("QFT", "Functionality", qc, *exp);
+      exp = benchmarkParallelFunctionalityConstruction(qc, 0U);
+      verifyAndSave("QFT", "ParallelFunctionality", qc, *exp);
     }
   }
 
@@ -399,6 +580,52 @@ protected:
       auto qc = qc::RandomCliffordCircuit(nq, nq * nq, SEED);
       auto exp = benchmarkFunctionalityConstruction(qc);
       verifyAndSave("RandomClifford", "Functionality", qc, *exp);
+      exp = benchmarkParallelFunctionalityConstruction(qc, 0U);
+      verifyAndSave("RandomClifford", "ParallelFunctionality", qc, *exp);
+    }
+  }
+
+  void runNoisySimulation() {
+    const std::array<std::size_t, 5> nqubits = {6U, 7U, 8U, 9U, 10U};
+    std::cout << "Running QFT Noisy Simulation..." << '\n';
+    for (const auto& nq : nqubits) {
+      auto qc = qc::QFT(nq, false);
+      auto exp = benchmarkNoisySimulation(qc, false);
+      verifyAndSave("QFT", "NoisyPerOperation", qc, *exp);
+      exp = benchmarkNoisySimulation(qc, true);
+      verifyAndSave("QFT", "NoisyBatched", qc, *exp);
+    }
+  }
+
+  void runExport() {
+    const std::array nqubitsVec = {20U, 21U, 22U, 23U, 24U};
+    std::cout << "Running QFT Vector Export..." << '\n';
+    for (const auto& nq : nqubitsVec) {
+      auto qc = qc::QFT(nq, false);
+      auto exp = benchmarkVectorExport(qc, 0U);
+      verifyAndSave("QFT", "VectorExport", qc, *exp);
+    }
+    const std::array nqubitsMat = {8U, 9U, 10U, 11U, 12U};
+    std::cout << "Running QFT Matrix Export..." << '\n';
+    for (const auto& nq : nqubitsMat) {
+      auto qc = qc::QFT(nq, false);
+      auto exp = benchmarkMatrixExport(qc, 0U);
+      verifyAndSave("QFT", "MatrixExport", qc, *exp);
+    }
+  }
+
+  void runPauliSum() {
+    constexpr std::size_t nq = 12U;
+    const std::array nterms = {100U, 1000U, 10000U};
+    std::cout << "Running Pauli Sum Construction..." << '\n';
+    for (const auto& terms : nterms) {
+      const auto observable = randomPauliSum(nq, terms, SEED);
+      const auto name = "PauliSum" + std::to_string(terms);
+      auto qc = qc::QuantumComputation(nq);
+      auto exp = benchmarkPauliSum(observable, nq, true);
+      verifyAndSave(name, "KroneckerAdd", qc, *exp);
+      exp = benchmarkPauliSum(observable, nq, false);
+      verifyAndSave(name, "Builder", qc, *exp);
     }
   }
 
@@ -414,6 +641,9 @@ public:
     runGrover();
     runQPE();
     runRandomClifford();
+    runNoisySimulation();
+    runExport();
+    runPauliSum();
   }
 };
 
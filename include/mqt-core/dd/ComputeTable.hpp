@@ -1,27 +1,44 @@
 #pragma once
 
 #include "Definitions.hpp"
+#include "dd/DDDefinitions.hpp"
 #include "dd/Node.hpp"
 #include "dd/statistics/TableStatistics.hpp"
 
-#include <array>
-#include <bitset>
 #include <cstddef>
 #include <functional>
 #include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 namespace dd {
 
+/// An operand of a computation whose result depends on a level offset, e.g.,
+/// the lower operand of a Kronecker product with the upper operand shifted up
+template <class Node> struct OffsetOperand {
+  Node* p = nullptr;
+  Qubit offset = 0U;
+
+  bool operator==(const OffsetOperand& other) const noexcept {
+    return p == other.p && offset == other.offset;
+  }
+  bool operator!=(const OffsetOperand& other) const noexcept {
+    return !(*this == other);
+  }
+};
+
 /// Data structure for caching computed results
 /// \tparam LeftOperandType type of the operation's left operand
 /// \tparam RightOperandType type of the operation's right operand
 /// \tparam ResultType type of the operation's result
-/// \tparam NBUCKET number of hash buckets to use (has to be a power of two)
+/// \tparam NBUCKET initial number of hash buckets to use (has to be a power of
+/// two). The table can be resized at runtime (see \ref resize).
 template <class LeftOperandType, class RightOperandType, class ResultType,
           std::size_t NBUCKET = 16384>
 class ComputeTable {
 public:
-  ComputeTable() {
+  ComputeTable() : table(NBUCKET), valid(NBUCKET) {
     stats.entrySize = sizeof(Entry);
     stats.numBuckets = NBUCKET;
   }
@@ -32,10 +49,8 @@ public:
     ResultType result;
   };
 
-  static constexpr std::size_t MASK = NBUCKET - 1;
-
-  static std::size_t hash(const LeftOperandType& leftOperand,
-                          const RightOperandType& rightOperand) {
+  [[nodiscard]] std::size_t hash(const LeftOperandType& leftOperand,
+                                 const RightOperandType& rightOperand) const {
     auto h1 = std::hash<LeftOperandType>{}(leftOperand);
     if constexpr (std::is_same_v<LeftOperandType, dNode*>) {
       if (!dNode::isTerminal(leftOperand)) {
@@ -51,7 +66,7 @@ public:
       }
     }
     const auto hash = qc::combineHash(h1, h2);
-    return hash & MASK;
+    return hash & mask;
   }
 
   /// Get a reference to the table
@@ -67,7 +82,7 @@ public:
       ++stats.collisions;
     } else {
       stats.trackInsert();
-      valid.set(key);
+      valid[key] = true;
     }
     table[key] = {leftOperand, rightOperand, result};
   }
@@ -106,7 +121,35 @@ public:
   }
 
   void clear() {
-    valid.reset();
+    valid.assign(valid.size(), false);
+    stats.reset();
+  }
+
+  /// Get the current number of buckets
+  [[nodiscard]] std::size_t getNumBuckets() const noexcept {
+    return table.size();
+  }
+
+  /**
+   * @brief Change the number of buckets of the table.
+   * @details All cached results are discarded. The lookup and hit counters
+   * are kept so that the statistics cover the whole lifetime of the table.
+   * @param numBuckets The new number of buckets (has to be a power of two)
+   * @throws std::invalid_argument if the number of buckets is not a power of
+   * two
+   */
+  void resize(const std::size_t numBuckets) {
+    if (numBuckets == 0U || (numBuckets & (numBuckets - 1U)) != 0U) {
+      throw std::invalid_argument(
+          "The number of compute table buckets has to be a power of two, but " +
+          std::to_string(numBuckets) + " was requested.");
+    }
+    table.assign(numBuckets, Entry{});
+    table.shrink_to_fit();
+    valid.assign(numBuckets, false);
+    valid.shrink_to_fit();
+    mask = numBuckets - 1U;
+    stats.numBuckets = numBuckets;
     stats.reset();
   }
 
@@ -115,8 +158,17 @@ public:
   }
 
 private:
-  std::array<Entry, NBUCKET> table{};
-  std::bitset<NBUCKET> valid{};
+  std::vector<Entry> table;
+  std::vector<bool> valid;
+  std::size_t mask = NBUCKET - 1U;
   TableStatistics stats{};
 };
 } // namespace dd
+
+namespace std {
+template <class Node> struct hash<dd::OffsetOperand<Node>> {
+  std::size_t operator()(const dd::OffsetOperand<Node>& o) const noexcept {
+    return qc::combineHash(std::hash<Node*>{}(o.p), o.offset);
+  }
+};
+} // namespace std
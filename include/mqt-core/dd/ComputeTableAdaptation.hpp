@@ -0,0 +1,109 @@
+#pragma once
+
+#include "dd/statistics/TableStatistics.hpp"
+
+#include <cstddef>
+#include <nlohmann/json_fwd.hpp>
+#include <string>
+#include <vector>
+
+namespace dd {
+
+/// Parameters of the adaptive compute table sizing
+struct AdaptiveComputeTableConfig {
+  /// Whether the compute tables are resized at runtime
+  bool enabled = false;
+  /// The number of garbage collection calls between two adaptation rounds
+  std::size_t interval = 64U;
+  /// The memory all adaptive compute tables may use together (in MiB)
+  double memoryBudgetMiB = 256.;
+  /// The minimum number of lookups in a round for a table to be grown
+  std::size_t minLookups = 4096U;
+  /// Tables whose collision ratio in a round exceeds this value are grown
+  double growCollisionRatio = 0.25;
+  /// Tables with fewer lookups per bucket in a round are shrunk
+  double shrinkLookupsPerBucket = 0.125;
+  /// The smallest and largest number of buckets a table may be resized to
+  std::size_t minBuckets = 1024U;
+  std::size_t maxBuckets = 1U << 22U;
+};
+
+/// The usage of a compute table as seen by the adaptation
+struct ComputeTableUsage {
+  /// The name of the table (as used in the package statistics)
+  std::string name;
+  /// The statistics of the table
+  const TableStatistics* stats = nullptr;
+};
+
+/// A single decision taken by the adaptive compute table sizing
+struct ComputeTableResize {
+  /// The adaptation round the decision was taken in
+  std::size_t round = 0U;
+  /// The name of the table
+  std::string table;
+  /// Why the table was (or was not) resized: `collisions`, `cold`, or `budget`
+  std::string reason;
+  std::size_t fromBuckets = 0U;
+  std::size_t toBuckets = 0U;
+  /// The lookups, hit ratio and collision ratio of the table in the round
+  std::size_t lookups = 0U;
+  double hitRatio = 0.;
+  double colRatio = 0.;
+
+  [[nodiscard]] nlohmann::json json() const;
+};
+
+/**
+ * @brief Runtime sizing policy for the compute tables of a package.
+ * @details Every round inspects the lookups, hits and collisions each table
+ * accumulated since the previous round. Tables that were barely used are
+ * halved, then tables with a high collision ratio are doubled (most collisions
+ * first) as long as all adaptive tables together stay within the memory
+ * budget. Tables configured with a single bucket are never touched. All
+ * decisions are logged and reported in the package statistics.
+ */
+class ComputeTableAdaptation {
+public:
+  AdaptiveComputeTableConfig config{};
+
+  /**
+   * @brief Count a garbage collection call.
+   * @return Whether an adaptation round is due.
+   */
+  [[nodiscard]] bool tick() noexcept;
+
+  /**
+   * @brief Perform an adaptation round.
+   * @param tables The adaptive tables of the package (always in the same
+   * order)
+   * @return The new number of buckets for each table
+   */
+  [[nodiscard]] std::vector<std::size_t>
+  adapt(const std::vector<ComputeTableUsage>& tables);
+
+  /// The decisions taken so far
+  [[nodiscard]] const auto& getDecisions() const noexcept { return decisions; }
+
+  /// Get a JSON summary of the adaptation including all decisions
+  [[nodiscard]] nlohmann::json json() const;
+
+private:
+  struct TableState {
+    std::string name;
+    std::size_t numBuckets = 0U;
+    double memoryMiB = 0.;
+    std::size_t lookups = 0U;
+    std::size_t hits = 0U;
+    std::size_t collisions = 0U;
+    std::size_t grows = 0U;
+    std::size_t shrinks = 0U;
+  };
+
+  std::vector<TableState> states;
+  std::vector<ComputeTableResize> decisions;
+  std::size_t calls = 0U;
+  std::size_t rounds = 0U;
+};
+
+} // namespace dd
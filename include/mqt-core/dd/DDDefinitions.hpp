@@ -7,6 +7,7 @@
 #include <complex>
 #include <cstddef>
 #include <cstdint>
+#include <stdexcept>
 #include <string>
 #include <type_traits>
 #include <unordered_map>
@@ -78,6 +79,69 @@ using CMat = std::vector<CVec>;
 using SparseCMat = std::unordered_map<std::pair<std::size_t, std::size_t>,
                                       std::complex<fp>, PairHash>;
 
+/**
+ * @brief A square sparse matrix in compressed sparse row (CSR) format
+ * @details The entries of row i are stored at the positions
+ * [rowPtr[i], rowPtr[i + 1]) of colIdx and values, sorted by column.
+ */
+struct CSRMat {
+  std::size_t dim = 0U;
+  std::vector<std::size_t> rowPtr;
+  std::vector<std::size_t> colIdx;
+  CVec values;
+};
+
+/// Single-qubit Pauli operators
+enum class Pauli : std::uint8_t {
+  I, // NOLINT(readability-identifier-naming)
+  X, // NOLINT(readability-identifier-naming)
+  Y, // NOLINT(readability-identifier-naming)
+  Z  // NOLINT(readability-identifier-naming)
+};
+
+/**
+ * @brief A tensor product of single-qubit Pauli operators
+ * @details Entry q acts on qubit q. Qubits beyond the end of the string are
+ * acted on by the identity.
+ */
+using PauliString = std::vector<Pauli>;
+
+/// A weighted sum of Pauli strings, e.g., a Hamiltonian
+using WeightedPauliSum = std::vector<std::pair<fp, PauliString>>;
+
+/**
+ * @brief Parses a Pauli string (big endian)
+ * @param str The string consisting of the characters I, X, Y, and Z, where the
+ * first character acts on the highest qubit, e.g., "XIZ" applies Z to qubit 0
+ * and X to qubit 2
+ * @return The Pauli string
+ * @throws std::invalid_argument if the string contains any other character
+ */
+[[nodiscard]] inline PauliString makePauliString(const std::string& str) {
+  PauliString pauli(str.size(), Pauli::I);
+  for (std::size_t j = 0; j < str.size(); ++j) {
+    auto& p = pauli[str.size() - 1 - j];
+    switch (str[j]) {
+    case 'I':
+      p = Pauli::I;
+      break;
+    case 'X':
+      p = Pauli::X;
+      break;
+    case 'Y':
+      p = Pauli::Y;
+      break;
+    case 'Z':
+      p = Pauli::Z;
+      break;
+    default:
+      throw std::invalid_argument("Invalid Pauli operator '" +
+                                  std::string(1, str[j]) + "'.");
+    }
+  }
+  return pauli;
+}
+
 using GateMatrix = std::array<std::complex<fp>, NEDGE>;
 using TwoQubitGateMatrix =
     std::array<std::array<std::complex<fp>, NEDGE>, NEDGE>;
@@ -15,7 +15,10 @@ namespace dd {
 /// \tparam OperandType type of the operation's operand
 /// \tparam ResultType type of the operation's result
 /// \tparam NBUCKET number of hash buckets to use (has to be a power of two)
-template <class OperandType, class ResultType, std::size_t NBUCKET = 32768>
+/// \tparam Key sequence of integers identifying the noise that is applied
+/// (the qubits affected by noise by default)
+template <class OperandType, class ResultType, std::size_t NBUCKET = 32768,
+          class Key = std::vector<Qubit>>
 class DensityNoiseTable { // todo: Inherit from UnaryComputerTable
 public:
   DensityNoiseTable() {
@@ -26,7 +29,7 @@ public:
   struct Entry {
     OperandType operand;
     ResultType result;
-    std::vector<dd::Qubit> usedQubits;
+    Key usedQubits;
   };
 
   static constexpr size_t MASK = NBUCKET - 1;
@@ -37,8 +40,7 @@ public:
   /// Get a reference to the statistics
   [[nodiscard]] const auto& getStats() const noexcept { return stats; }
 
-  static std::size_t hash(const OperandType& a,
-                          const std::vector<Qubit>& usedQubits) {
+  static std::size_t hash(const OperandType& a, const Key& usedQubits) {
     std::size_t i = 0;
     for (const auto qubit : usedQubits) {
       i = (i << 3U) + i * static_cast<std::size_t>(qubit) +
@@ -48,7 +50,7 @@ public:
   }
 
   void insert(const OperandType& operand, const ResultType& result,
-              const std::vector<Qubit>& usedQubits) {
+              const Key& usedQubits) {
     const auto key = hash(operand, usedQubits);
     if (valid[key]) {
       ++stats.collisions;
@@ -59,8 +61,7 @@ public:
     table[key] = {operand, result, usedQubits};
   }
 
-  ResultType lookup(const OperandType& operand,
-                    const std::vector<Qubit>& usedQubits) {
+  ResultType lookup(const OperandType& operand, const Key& usedQubits) {
     ResultType result{};
     ++stats.lookups;
     const auto key = hash(operand, usedQubits);
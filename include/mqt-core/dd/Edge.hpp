@@ -10,6 +10,7 @@
 #include <string>
 #include <type_traits>
 #include <unordered_set>
+#include <vector>
 
 namespace dd {
 
@@ -168,15 +169,49 @@ public:
   template <typename T = Node, isVector<T> = true>
   [[nodiscard]] std::complex<fp> getValueByIndex(std::size_t i) const;
 
+  /**
+   * @brief Get multiple elements of the vector represented by the DD
+   * @details The requested indices are sorted and the DD is descended only
+   * once. Indices sharing a common prefix share the traversal of the nodes
+   * along that prefix. Independent subtrees may be processed in parallel.
+   * @tparam T template parameter to enable this function only for vNode
+   * @param indices the indices of the elements
+   * @param nthreads the number of threads to use (0 for all available)
+   * @return the complex values of the amplitudes in the order of the requested
+   * indices
+   */
+  template <typename T = Node, isVector<T> = true>
+  [[nodiscard]] CVec getValuesByIndices(const std::vector<std::size_t>& indices,
+                                        std::size_t nthreads = 1U) const;
+
   /**
    * @brief Get the vector represented by the DD
    * @tparam T template parameter to enable this function only for vNode
    * @param threshold amplitudes with a magnitude below this threshold will be
    * ignored
+   * @param nthreads the number of threads to use (0 for all available)
    * @return the vector
+   * @see writeVector
    */
   template <typename T = Node, isVector<T> = true>
-  [[nodiscard]] CVec getVector(fp threshold = 0.) const;
+  [[nodiscard]] CVec getVector(fp threshold = 0.,
+                               std::size_t nthreads = 1U) const;
+
+  /**
+   * @brief Write the vector represented by the DD into a preallocated buffer
+   * @details Every entry of the buffer is written. Zero subtrees and subtrees
+   * below the threshold are filled with zeros without being traversed.
+   * Independent subtrees may be processed in parallel.
+   * @tparam T template parameter to enable this function only for vNode
+   * @param vec the buffer, which has to hold 2^n entries for a DD on n qubits
+   * (a single entry for a terminal)
+   * @param threshold amplitudes with a magnitude below this threshold will be
+   * ignored
+   * @param nthreads the number of threads to use (0 for all available)
+   */
+  template <typename T = Node, isVector<T> = true>
+  void writeVector(std::complex<fp>* vec, fp threshold = 0.,
+                   std::size_t nthreads = 1U) const;
 
   /**
    * @brief Get the sparse vector represented by the DD
@@ -273,10 +308,31 @@ public:
    * @param numQubits number of qubits in the considered DD
    * @param threshold entries with a magnitude below this threshold will be
    * ignored
+   * @param nthreads the number of threads to use (0 for all available)
    * @return the matrix
+   * @see writeMatrix
    */
   template <typename T = Node, isMatrixVariant<T> = true>
-  [[nodiscard]] CMat getMatrix(std::size_t numQubits, fp threshold = 0.) const;
+  [[nodiscard]] CMat getMatrix(std::size_t numQubits, fp threshold = 0.,
+                               std::size_t nthreads = 1U) const;
+
+  /**
+   * @brief Write the matrix represented by the DD into a preallocated buffer
+   * @details Every entry of the buffer is written. Zero blocks and blocks
+   * below the threshold are filled with zeros without being traversed.
+   * Independent blocks may be processed in parallel (density matrices are
+   * always exported on the calling thread).
+   * @tparam T template parameter to enable this function only for matrix nodes
+   * @param numQubits number of qubits in the considered DD
+   * @param mat the buffer, which has to hold the 2^n x 2^n entries in row-major
+   * order
+   * @param threshold entries with a magnitude below this threshold will be
+   * ignored
+   * @param nthreads the number of threads to use (0 for all available)
+   */
+  template <typename T = Node, isMatrixVariant<T> = true>
+  void writeMatrix(std::size_t numQubits, std::complex<fp>* mat,
+                   fp threshold = 0., std::size_t nthreads = 1U) const;
 
   /**
    * @brief Get the sparse matrix represented by the DD
@@ -290,6 +346,23 @@ public:
   [[nodiscard]] SparseCMat getSparseMatrix(std::size_t numQubits,
                                            fp threshold = 0.) const;
 
+  /**
+   * @brief Get the sparse matrix represented by the DD in CSR format
+   * @details The rows are split into bands that are collected independently
+   * (and in parallel if requested). Zero blocks are skipped.
+   * @tparam T template parameter to enable this function only for matrix nodes
+   * @param numQubits number of qubits in the considered DD
+   * @param threshold entries with a magnitude below this threshold will be
+   * ignored
+   * @param nthreads the number of threads to use (0 for all available, density
+   * matrices are always exported on the calling thread)
+   * @return the sparse matrix
+   */
+  template <typename T = Node, isMatrixVariant<T> = true>
+  [[nodiscard]] CSRMat getSparseMatrixCSR(std::size_t numQubits,
+                                          fp threshold = 0.,
+                                          std::size_t nthreads = 1U) const;
+
   /**
    * @brief Print the matrix represented by the DD
    * @tparam T template parameter to enable this function only for matrix nodes
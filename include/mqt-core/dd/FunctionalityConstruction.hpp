@@ -7,6 +7,7 @@
 #include "ir/operations/OpType.hpp"
 
 #include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <ostream>
 #include <stack>
@@ -28,6 +29,74 @@ bool buildFunctionalityRecursive(const QuantumComputation* qc,
                                  std::stack<MatrixDD>& s,
                                  Permutation& permutation, Package<Config>& dd);
 
+/**
+ * @brief Builds the functionality of a circuit as a balanced tree of products
+ * whose independent subtrees are evaluated in parallel.
+ * @details The operations are split into contiguous ranges, one per worker,
+ * that are multiplied in private packages. Neighbouring partial products are
+ * then combined level by level, transferring the right operand into the
+ * package of the left one. The result is transferred to `dd`.
+ * @param qc the circuit
+ * @param dd the package
+ * @param nthreads the number of threads to use (0 for all available)
+ * @return the functionality of the circuit (holding a reference)
+ */
+template <class Config>
+MatrixDD buildFunctionalityParallel(const QuantumComputation* qc,
+                                    Package<Config>& dd,
+                                    std::size_t nthreads = 0U);
+
+/// Orders in which the operations of two circuits are applied to the miter
+enum class EquivalenceCheckingStrategy : std::uint8_t {
+  /// all operations of the first circuit, then those of the second one
+  Naive,
+  /// one operation of either circuit at a time
+  OneToOne,
+  /// operations of both circuits in proportion to their numbers of operations
+  Proportional,
+  /// in each step, the operation (of either circuit) that yields the smaller
+  /// DD
+  Lookahead,
+};
+
+/// Parameters of the alternating equivalence check
+struct EquivalenceCheckingConfig {
+  EquivalenceCheckingStrategy strategy =
+      EquivalenceCheckingStrategy::Proportional;
+  /// the tolerance passed to Package::isCloseToIdentity
+  fp tolerance = 1e-10;
+};
+
+struct EquivalenceCheckingResult {
+  /// whether the circuits are equivalent up to a global phase
+  bool equivalent = false;
+  /// the largest number of nodes of the miter during the check
+  std::size_t peakNodes = 0U;
+};
+
+/**
+ * @brief Checks two circuits for equivalence on a single miter DD.
+ * @details Instead of constructing both functionalities G and G', the
+ * operations of G are applied from the left and the inverted operations of G'
+ * from the right to a single matrix DD, which yields G·G'† in the end. For
+ * equivalent circuits, a suitable interleaving keeps the miter close to the
+ * identity, so its size typically stays orders of magnitude below that of
+ * either functionality. Ancillary and garbage qubits as well as the initial
+ * layouts and output permutations of both circuits are taken into account.
+ * @param qc1 the first circuit
+ * @param qc2 the second circuit
+ * @param dd the package
+ * @param config the strategy and tolerance of the check
+ * @return whether the circuits are equivalent and the peak size of the miter
+ * @throws std::invalid_argument if the circuits act on different numbers of
+ * qubits
+ */
+template <class Config>
+EquivalenceCheckingResult
+checkEquivalence(const QuantumComputation* qc1, const QuantumComputation* qc2,
+                 Package<Config>& dd,
+                 const EquivalenceCheckingConfig& config = {});
+
 inline void dumpTensorNetwork(std::ostream& of, const QuantumComputation& qc) {
   of << "{\"tensors\": [\n";
 
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "dd/DDDefinitions.hpp"
+#include "dd/Edge.hpp"
+#include "dd/Node.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace dd {
+
+/**
+ * @brief A cache for the probabilities associated with the nodes of a state
+ * vector decision diagram.
+ * @details For the state it has been computed for, the cache stores for every
+ * node
+ *  - the probability of reaching the node from the root, i.e., the sum of the
+ *    squared magnitudes of all paths from the root node to the node, and
+ *  - the squared norm of the sub-vector represented by the node.
+ * Together, these allow to determine measurement probabilities and marginal
+ * distributions by only looking at the nodes of the respective levels.
+ * The values are computed lazily: the reach probabilities only down to the
+ * lowest level queried so far and the sub-vector norms only when needed.
+ * The values are kept in a flat, open-addressing hash table whose entries are
+ * stamped with an epoch. Switching to another state or invalidating the cache
+ * merely increments the epoch. Hence, once the table and the per-level node
+ * lists have grown to the size of the largest state, no further allocations
+ * are necessary.
+ * @note The cache identifies states by their root node and stores raw node
+ * pointers. It has to be invalidated whenever vector nodes are collected.
+ */
+class NodeProbabilityCache {
+public:
+  /**
+   * @brief Prepare the cache for the given state.
+   * @details Computes the reach probabilities of all nodes at or above level
+   * `lowest` top-down and, if requested, the sub-vector probabilities of all
+   * nodes bottom-up. Values already computed for the root node of the state
+   * are reused, so that, e.g., measuring the top qubit of a fresh state only
+   * visits the root node. The probabilities do not include the weight of the
+   * root edge.
+   * @param root the root edge of the state
+   * @param lowest the lowest level whose nodes and reach probabilities are
+   * needed
+   * @param subtrees whether the sub-vector probabilities are needed (which
+   * requires visiting all nodes)
+   */
+  void compute(const vEdge& root, Qubit lowest = 0U, bool subtrees = true);
+
+  /// Invalidate all cached values
+  void invalidate() noexcept { valid = false; }
+
+  /// Check whether the values for the given state are cached
+  [[nodiscard]] bool isCached(const vEdge& root) const noexcept {
+    return valid && root.p == rootNode;
+  }
+
+  /// Get the nodes of the cached state residing at the given level
+  [[nodiscard]] const std::vector<const vNode*>& nodesAt(Qubit level) const;
+
+  /// Get the probability of reaching a node from the root of the cached state
+  [[nodiscard]] fp reachProbability(const vNode* node) const noexcept;
+
+  /// Get the squared norm of the sub-vector represented by a node (one for the
+  /// terminal node)
+  [[nodiscard]] fp subtreeProbability(const vNode* node) const noexcept;
+
+  /**
+   * @brief Determine the probabilities of measuring a qubit of the cached
+   * state.
+   * @param index the index of the qubit
+   * @param assumeProbabilityNormalization whether to assume that all nodes
+   * represent normalized sub-vectors
+   * @return the (unnormalized) probabilities of measuring `0` and `1`
+   */
+  [[nodiscard]] std::pair<fp, fp>
+  measurementProbabilities(Qubit index,
+                           bool assumeProbabilityNormalization) const;
+
+  /// Get the number of nodes of the cached state
+  [[nodiscard]] std::size_t size() const noexcept { return entries; }
+
+private:
+  struct Entry {
+    const vNode* node = nullptr;
+    std::uint32_t epoch = 0U;
+    fp reach = 0.;
+    fp subtree = 0.;
+  };
+
+  static constexpr std::size_t INITIAL_CAPACITY = 1024U;
+
+  [[nodiscard]] std::size_t hash(const vNode* node) const noexcept;
+  [[nodiscard]] const Entry* find(const vNode* node) const noexcept;
+  /// Get the entry of a node that is known to be part of the cached state
+  [[nodiscard]] Entry& at(const vNode* node) noexcept;
+  /// Insert a node into the table and return whether it was newly inserted
+  bool insert(const vNode* node);
+  void grow();
+  /// Start caching the values of another state
+  void reset(const vEdge& root);
+  /// Propagate the reach probabilities down to the given level
+  void expand(Qubit lowest);
+
+  std::vector<Entry> table{};
+  std::size_t shift = 0U;
+  std::size_t entries = 0U;
+  std::uint32_t epoch = 0U;
+
+  bool valid = false;
+  const vNode* rootNode = nullptr;
+  /// the levels at or above this one have passed on their reach probabilities
+  std::size_t unexpanded = 0U;
+  bool subtreesComputed = false;
+
+  std::vector<std::vector<const vNode*>> levels{};
+  std::vector<const vNode*> stack{};
+};
+
+} // namespace dd
@@ -5,6 +5,7 @@
 #include "dd/DDpackageConfig.hpp"
 #include "dd/Node.hpp"
 #include "dd/Package.hpp"
+#include "ir/QuantumComputation.hpp"
 #include "ir/operations/OpType.hpp"
 #include "ir/operations/Operation.hpp"
 
@@ -12,6 +13,7 @@
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <map>
 #include <memory>
 #include <random>
 #include <set>
@@ -94,6 +96,76 @@ protected:
                                                 bool multiQubitNoiseFlag) const;
 };
 
+/// Configuration of a quantum-trajectory simulation
+struct TrajectoryConfig {
+  /// the number of noisy trajectories to sample
+  std::size_t trajectories = 1000U;
+  /// the number of measurements sampled from the final state of a trajectory
+  std::size_t shotsPerTrajectory = 1U;
+  /// the number of worker threads (0 for all available)
+  std::size_t nthreads = 0U;
+  /// the seed of the trajectories (0 for a random seed)
+  std::size_t seed = 0U;
+  /// the noise model (see StochasticNoiseFunctionality)
+  double gateNoiseProbability = 0.001;
+  double amplitudeDampingProbability = 0.002;
+  double multiQubitGateFactor = 2.;
+  std::string noiseEffects = "APD";
+  /// the z-score of the reported confidence intervals (1.96 for 95%)
+  fp zScore = 1.96;
+};
+
+/// An estimate together with the half width of its confidence interval
+struct TrajectoryEstimate {
+  fp mean = 0.;
+  fp halfWidth = 0.;
+};
+
+/// The aggregated outcome of a quantum-trajectory simulation
+struct TrajectoryResult {
+  /// the measurement outcomes of all trajectories (qubit 0 is the last
+  /// character)
+  std::map<std::string, std::size_t> counts;
+  /// the estimated expectation value of each observable
+  std::vector<TrajectoryEstimate> observables;
+  /// the runtime of each trajectory in seconds
+  std::vector<double> runtimes;
+};
+
+/**
+ * @brief Simulates a circuit under stochastic noise by sampling independent
+ * quantum trajectories in parallel.
+ * @details The trajectories are distributed over a pool of worker threads.
+ * Each worker owns a DD package and StochasticNoiseFunctionality and reuses
+ * the DDs of the operations for all of its trajectories. Each trajectory draws
+ * from its own generator derived from the seed and its index, such that the
+ * results do not depend on the number of threads.
+ * @param qc the circuit (consisting of unitary operations only)
+ * @param config the configuration of the simulation
+ * @param observables the observables to estimate on the final states
+ * @return the measurement counts, the observable estimates with their
+ * confidence intervals, and the runtime of each trajectory
+ * @throws std::invalid_argument if the circuit contains non-unitary operations
+ * or no trajectories are requested
+ */
+TrajectoryResult
+simulateTrajectories(const qc::QuantumComputation& qc,
+                     const TrajectoryConfig& config,
+                     const std::vector<WeightedPauliSum>& observables = {});
+
+/**
+ * @brief Greedily groups the operations of a circuit into layers acting on
+ * disjoint qubits.
+ * @details Every operation is placed in the first layer after the last layer
+ * using any of its qubits. The layers can be passed (via the qubits used by
+ * their operations) to the layer overload of
+ * DeterministicNoiseFunctionality::applyNoiseEffects.
+ * @param qc the circuit
+ * @return the indices of the operations in each layer, in circuit order
+ */
+std::vector<std::vector<std::size_t>>
+groupIntoDisjointLayers(const qc::QuantumComputation& qc);
+
 class DeterministicNoiseFunctionality {
 public:
   DeterministicNoiseFunctionality(
@@ -119,11 +191,43 @@ public:
   void applyNoiseEffects(dEdge& originalEdge,
                          const std::unique_ptr<qc::Operation>& qcOperation);
 
+  /**
+   * @brief Applies the noise of a whole layer of operations in a single
+   * traversal.
+   * @details Equivalent to calling applyNoiseEffects for every operation of
+   * the layer once all of them have been applied. The channels of all qubits
+   * are applied level by level in one recursion. Its intermediate results are
+   * cached in the density noise table of the package.
+   * @param originalEdge the density matrix
+   * @param layer the qubits used by each operation of the layer (have to be
+   * disjoint)
+   */
+  void applyNoiseEffects(dEdge& originalEdge,
+                         const std::vector<std::set<qc::Qubit>>& layer);
+
 private:
+  /// The noise acting on the qubits during a layer of operations
+  struct LayerNoise {
+    /// per qubit: 0 if it is not used, 1 if it is used by a single-qubit and 2
+    /// if it is used by a multi-qubit operation
+    std::vector<std::uint8_t> kinds;
+    /// identifies the noise below every level, once for edges off and once
+    /// for edges on the first path (used as key of the density noise table)
+    std::array<std::vector<std::vector<Qubit>>, 2U> signatures;
+    /// the lowest qubit affected by noise
+    Qubit lowest;
+  };
+
   dCachedEdge applyNoiseEffects(dEdge& originalEdge,
                                 const std::set<qc::Qubit>& usedQubits,
                                 bool firstPathEdge, Qubit level);
 
+  dCachedEdge applyLayerNoiseEffects(dEdge& originalEdge,
+                                     const LayerNoise& noise,
+                                     bool firstPathEdge, Qubit level);
+
+  void applyNoiseChannels(ArrayOfEdges& e, bool multiQubit);
+
   static void applyPhaseFlipToEdges(ArrayOfEdges& e, double probability);
 
   void applyAmplitudeDampingToEdges(ArrayOfEdges& e, double probability);
@@ -131,4 +235,126 @@ private:
   void applyDepolarisationToEdges(ArrayOfEdges& e, double probability);
 };
 
+/// A noise channel acting on one or two qubits, given by its Kraus operators
+struct KrausChannel {
+  /// the Kraus operators of a single-qubit channel
+  std::vector<GateMatrix> singleQubitOperators;
+  /// the Kraus operators of a (correlated) two-qubit channel, where the first
+  /// target is the lower one (see Package::makeTwoQubitGateDD)
+  std::vector<TwoQubitGateMatrix> twoQubitOperators;
+
+  [[nodiscard]] std::size_t getNqubits() const {
+    return twoQubitOperators.empty() ? 1U : 2U;
+  }
+
+  /// Check whether the Kraus operators satisfy sum_k K_k^dagger K_k = I
+  [[nodiscard]] bool isTracePreserving(fp tolerance = 1e-10) const;
+
+  /// Amplitude damping with the given decay probability
+  static KrausChannel amplitudeDamping(fp probability);
+  /// Phase flip applying Z with the given probability
+  static KrausChannel phaseFlip(fp probability);
+  /// Bit flip applying X with the given probability
+  static KrausChannel bitFlip(fp probability);
+  /// Depolarization replacing the state by the maximally mixed state with the
+  /// given probability
+  static KrausChannel depolarization(fp probability);
+  /// Correlated two-qubit depolarization replacing the state of both qubits by
+  /// the maximally mixed state with the given probability
+  static KrausChannel twoQubitDepolarization(fp probability);
+};
+
+/// Assigns Kraus channels to qubits and types of operations
+struct KrausNoiseModel {
+  /// channels applied to a qubit after every operation acting on it
+  std::map<qc::Qubit, std::vector<KrausChannel>> qubitChannels;
+  /// channels applied after every operation of a type. Single-qubit channels
+  /// act on every qubit used by the operation, two-qubit channels on the two
+  /// qubits used by the operation.
+  std::map<qc::OpType, std::vector<KrausChannel>> gateChannels;
+};
+
+/**
+ * @brief Deterministic noise-aware simulation with user-defined Kraus channels
+ * @details A channel is applied to a density matrix as
+ * sum_k K_k rho K_k^dagger. The DDs of the Kraus operators of the model are
+ * built once per channel and set of targets. The results of applying a channel
+ * are cached in the density channel table of the package, such that recurring
+ * density matrices are not processed again. Gate channels are applied before
+ * qubit channels.
+ */
+class KrausNoiseFunctionality {
+public:
+  /**
+   * @param dd the package the density matrices belong to
+   * @param nq the number of qubits
+   * @param model the noise model
+   * @throws std::invalid_argument if a channel is not trace preserving, does
+   * not have any Kraus operators, mixes single- and two-qubit Kraus operators,
+   * or acts on a qubit that does not exist
+   */
+  KrausNoiseFunctionality(
+      const std::unique_ptr<Package<DensityMatrixSimulatorDDPackageConfig>>& dd,
+      std::size_t nq, KrausNoiseModel model);
+
+  KrausNoiseFunctionality(const KrausNoiseFunctionality&) = delete;
+  KrausNoiseFunctionality& operator=(const KrausNoiseFunctionality&) = delete;
+
+  ~KrausNoiseFunctionality();
+
+  /**
+   * @brief Applies the noise associated with an operation.
+   * @param originalEdge the density matrix
+   * @param qcOperation the operation that has just been applied
+   * @throws std::invalid_argument if a two-qubit channel is associated with an
+   * operation that does not use exactly two qubits
+   */
+  void applyNoiseEffects(dEdge& originalEdge,
+                         const std::unique_ptr<qc::Operation>& qcOperation);
+
+  /**
+   * @brief Applies a channel to a density matrix.
+   * @param originalEdge the density matrix
+   * @param channel the channel
+   * @param targets the qubits the channel acts on (one per qubit of the
+   * channel)
+   * @throws std::invalid_argument if the channel is invalid (see the
+   * constructor) or the number of targets does not match the channel
+   */
+  void applyChannel(dEdge& originalEdge, const KrausChannel& channel,
+                    const std::vector<qc::Qubit>& targets);
+
+protected:
+  Package<DensityMatrixSimulatorDDPackageConfig>* package;
+  std::size_t nQubits;
+  KrausNoiseModel model;
+
+  /// Throws if a channel is empty, mixed, or not trace preserving
+  static void checkChannel(const KrausChannel& channel);
+
+  /// the DDs of the Kraus operators of a channel acting on some targets
+  struct KrausOperators {
+    std::vector<mEdge> operators;
+    std::vector<mEdge> adjoints;
+    /// identifies the channel in the density channel table
+    std::vector<std::uintptr_t> key;
+  };
+  /// the Kraus operators of the channels of the model (built on demand)
+  std::map<std::pair<const KrausChannel*, std::vector<qc::Qubit>>,
+           KrausOperators>
+      modelOperators;
+
+  KrausOperators makeKrausOperators(const KrausChannel& channel,
+                                    const std::vector<qc::Qubit>& targets);
+
+  void releaseKrausOperators(KrausOperators& kraus);
+
+  void applyModelChannel(dEdge& originalEdge, const KrausChannel& channel,
+                         const std::vector<qc::Qubit>& targets);
+
+  void applyKrausOperators(dEdge& originalEdge, const KrausOperators& kraus);
+
+  dEdge addDensityMatrices(const dEdge& x, const dEdge& y);
+};
+
 } // namespace dd
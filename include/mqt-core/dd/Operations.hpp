@@ -12,22 +12,23 @@
 #include "ir/operations/Operation.hpp"
 #include "ir/operations/StandardOperation.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <cstddef>
+#include <map>
+#include <numeric>
 #include <ostream>
 #include <sstream>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
 namespace dd {
-// single-target Operations
-template <class Config>
-qc::MatrixDD
-getStandardOperationDD(const qc::StandardOperation* op, Package<Config>& dd,
-                       const qc::Controls& controls, const qc::Qubit target,
-                       const bool inverse) {
+// matrix of a single-target operation
+inline GateMatrix getStandardOperationMatrix(const qc::StandardOperation* op,
+                                             const bool inverse) {
   GateMatrix gm;
 
   const auto type = op->getType();
@@ -98,23 +99,28 @@ getStandardOperationDD(const qc::StandardOperation* op, Package<Config>& dd,
     oss << "DD for gate" << op->getName() << " not available!";
     throw qc::QFRException(oss.str());
   }
-  return dd.makeGateDD(gm, controls, target);
+  return gm;
 }
 
-// two-target Operations
+// single-target Operations
 template <class Config>
 qc::MatrixDD
 getStandardOperationDD(const qc::StandardOperation* op, Package<Config>& dd,
-                       const qc::Controls& controls, qc::Qubit target0,
-                       qc::Qubit target1, const bool inverse) {
+                       const qc::Controls& controls, const qc::Qubit target,
+                       const bool inverse) {
+  return dd.makeGateDD(getStandardOperationMatrix(op, inverse), controls,
+                       target);
+}
+
+// matrix of a two-target operation (the row index is `2 * q0 + q1` for the
+// states `q0` and `q1` of the first and second target). The inverse of DCX is
+// obtained by swapping its targets and, hence, not reflected in the matrix.
+inline TwoQubitGateMatrix
+getStandardOperationTwoQubitMatrix(const qc::StandardOperation* op,
+                                   const bool inverse) {
   const auto type = op->getType();
   const auto& parameter = op->getParameter();
 
-  if (type == qc::DCX && inverse) {
-    // DCX is not self-inverse, but the inverse is just swapping the targets
-    std::swap(target0, target1);
-  }
-
   TwoQubitGateMatrix gm;
   switch (type) {
   case qc::SWAP:
@@ -163,8 +169,21 @@ getStandardOperationDD(const qc::StandardOperation* op, Package<Config>& dd,
     oss << "DD for gate " << op->getName() << " not available!";
     throw qc::QFRException(oss.str());
   }
+  return gm;
+}
 
-  return dd.makeTwoQubitGateDD(gm, controls, target0, target1);
+// two-target Operations
+template <class Config>
+qc::MatrixDD
+getStandardOperationDD(const qc::StandardOperation* op, Package<Config>& dd,
+                       const qc::Controls& controls, qc::Qubit target0,
+                       qc::Qubit target1, const bool inverse) {
+  if (op->getType() == qc::DCX && inverse) {
+    // DCX is not self-inverse, but the inverse is just swapping the targets
+    std::swap(target0, target1);
+  }
+  return dd.makeTwoQubitGateDD(getStandardOperationTwoQubitMatrix(op, inverse),
+                               controls, target0, target1);
 }
 
 // The methods with a permutation parameter apply these Operations according to
@@ -267,8 +286,9 @@ void dumpTensor(qc::Operation* op, std::ostream& of,
                 std::vector<std::size_t>& inds, std::size_t& gateIdx,
                 Package<Config>& dd);
 
-// apply swaps 'on' DD in order to change 'from' to 'to'
-// where |from| >= |to|
+// relabel the qubits of 'on' in order to change 'from' to 'to'
+// where |from| >= |to|. States are extended by qubits in |0> if one of
+// their qubits is moved above them.
 template <class DDType, class Config>
 void changePermutation(DDType& on, qc::Permutation& from,
                        const qc::Permutation& to, Package<Config>& dd,
@@ -278,13 +298,23 @@ void changePermutation(DDType& on, qc::Permutation& from,
     return;
   }
 
+  // the circuit qubit mapped to each DD qubit
+  std::map<qc::Qubit, qc::Qubit> inverse{};
+  for (const auto& [key, value] : from) {
+    inverse[value] = key;
+  }
+  // the original level of the DD qubit that ends up at each level
+  std::vector<Qubit> sources(dd.qubits());
+  std::iota(sources.begin(), sources.end(), Qubit{0U});
+  bool changed = false;
+
   // iterate over (k,v) pairs of second permutation
   for (const auto& [i, goal] : to) {
     // search for key in the first map
     auto it = from.find(i);
     if (it == from.end()) {
       throw qc::QFRException(
-          "[changePermutation] Key " + std::to_string(it->first) +
+          "[changePermutation] Key " + std::to_string(i) +
           " was not found in first permutation. This should never happen.");
     }
     auto current = it->second;
@@ -295,36 +325,60 @@ void changePermutation(DDType& on, qc::Permutation& from,
     }
 
     // search for goal value in first permutation
-    qc::Qubit j = 0;
-    for (const auto& [key, value] : from) {
-      if (value == goal) {
-        j = key;
-        break;
-      }
-    }
+    const auto jt = inverse.find(goal);
+    const qc::Qubit j = jt != inverse.end() ? jt->second : 0U;
 
-    // swap i and j
-    auto saved = on;
-    const auto swapDD = dd.makeTwoQubitGateDD(SWAP_MAT, from.at(i), from.at(j));
-    if constexpr (std::is_same_v<DDType, qc::VectorDD>) {
-      on = dd.multiply(swapDD, on);
-    } else {
-      // the regular flag only has an effect on matrix DDs
-      if (regular) {
-        on = dd.multiply(swapDD, on);
-      } else {
-        on = dd.multiply(on, swapDD);
-      }
-    }
-
-    dd.incRef(on);
-    dd.decRef(saved);
-    dd.garbageCollect();
+    // swap the DD qubits of i and j
+    std::swap(sources.at(from.at(i)), sources.at(from.at(j)));
+    changed = true;
 
     // update permutation
     from.at(i) = goal;
     from.at(j) = current;
+    inverse[goal] = i;
+    inverse[current] = j;
+  }
+  if (!changed) {
+    return;
+  }
+
+  // apply all swaps at once
+  const auto stateLevels = on.isTerminal()
+                               ? std::size_t{0U}
+                               : static_cast<std::size_t>(on.p->v) + 1U;
+  auto levels = stateLevels;
+  bool crossesTop = false;
+  for (std::size_t level = 0U; level < sources.size(); ++level) {
+    if (sources[level] != level) {
+      levels = std::max(levels, level + 1U);
+    }
+    crossesTop |= (level < stateLevels) != (sources[level] < stateLevels);
+  }
+  auto saved = on;
+  if constexpr (std::is_same_v<DDType, qc::VectorDD>) {
+    if (!crossesTop) {
+      // swaps above the state do not affect it
+      levels = stateLevels;
+    } else if (levels > stateLevels) {
+      // the qubits above the state are in |0>
+      on = dd.kronecker(dd.makeZeroState(levels - stateLevels), on,
+                        stateLevels);
+    }
+  }
+  std::vector<Qubit> permutation(levels);
+  for (std::size_t level = 0U; level < levels; ++level) {
+    permutation[sources[level]] = static_cast<Qubit>(level);
+  }
+
+  if constexpr (std::is_same_v<DDType, qc::VectorDD>) {
+    on = dd.permuteQubits(on, permutation);
+  } else {
+    // the regular flag only has an effect on matrix DDs
+    on = dd.permuteQubits(on, permutation, regular, !regular);
   }
+  dd.incRef(on);
+  dd.decRef(saved);
+  dd.garbageCollect();
 }
 
 } // namespace dd
@@ -6,6 +6,7 @@
 #include "dd/ComplexNumbers.hpp"
 #include "dd/ComplexValue.hpp"
 #include "dd/ComputeTable.hpp"
+#include "dd/ComputeTableAdaptation.hpp"
 #include "dd/DDDefinitions.hpp"
 #include "dd/DDpackageConfig.hpp"
 #include "dd/DensityNoiseTable.hpp"
@@ -13,7 +14,9 @@
 #include "dd/GateMatrixDefinitions.hpp"
 #include "dd/MemoryManager.hpp"
 #include "dd/Node.hpp"
+#include "dd/NodeProbabilityCache.hpp"
 #include "dd/Package_fwd.hpp" // IWYU pragma: export
+#include "dd/Parallel.hpp"
 #include "dd/RealNumber.hpp"
 #include "dd/RealNumberUniqueTable.hpp"
 #include "dd/StochasticNoiseOperationTable.hpp"
@@ -27,18 +30,17 @@
 #include <bitset>
 #include <cassert>
 #include <cmath>
+#include <complex>
 #include <cstddef>
 #include <cstdint>
 #include <fstream>
 #include <iostream>
 #include <iterator>
 #include <limits>
-#include <map>
-#include <queue>
+#include <memory>
+#include <numeric>
 #include <random>
 #include <regex>
-#include <set>
-#include <stack>
 #include <stdexcept>
 #include <string>
 #include <type_traits>
@@ -180,6 +182,7 @@ public:
    * @see RealNumberUniqueTable::clear
    */
   void clearUniqueTables() {
+    nodeProbabilities.invalidate();
     vUniqueTable.clear();
     mUniqueTable.clear();
     dUniqueTable.clear();
@@ -229,6 +232,10 @@ public:
   }
 
   bool garbageCollect(bool force = false) {
+    if (computeTableAdaptation.tick()) {
+      adaptComputeTables();
+    }
+
     // return immediately if no table needs collection
     if (!force && !vUniqueTable.possiblyNeedsCollection() &&
         !mUniqueTable.possiblyNeedsCollection() &&
@@ -250,6 +257,7 @@ public:
     // invalidate all compute tables involving vectors if any vector node has
     // been collected
     if (vCollect > 0) {
+      nodeProbabilities.invalidate();
       vectorAdd.clear();
       vectorInnerProduct.clear();
       vectorKronecker.clear();
@@ -265,13 +273,18 @@ public:
       matrixVectorMultiplication.clear();
       matrixMatrixMultiplication.clear();
       stochasticNoiseOperationCache.clear();
+      // channels are identified by the DDs of their Kraus operators
+      densityChannel.clear();
+      densityOperationApplication.clear();
     }
     // invalidate all compute tables involving density matrices if any density
     // matrix node has been collected
     if (dCollect > 0) {
       densityAdd.clear();
       densityDensityMultiplication.clear();
+      densityOperationApplication.clear();
       densityNoise.clear();
+      densityChannel.clear();
       densityTrace.clear();
     }
     // invalidate all compute tables where any component of the entry contains
@@ -287,7 +300,9 @@ public:
       stochasticNoiseOperationCache.clear();
       densityAdd.clear();
       densityDensityMultiplication.clear();
+      densityOperationApplication.clear();
       densityNoise.clear();
+      densityChannel.clear();
       densityTrace.clear();
     }
     return vCollect > 0 || mCollect > 0 || cCollect > 0;
@@ -462,8 +477,21 @@ public:
     return leftSubtree;
   }
 
-  // generate the decision diagram from an arbitrary state vector
-  vEdge makeStateFromVector(const CVec& stateVector) {
+  /**
+      Generates the decision diagram from an arbitrary state vector
+      @param stateVector A complex vector to convert to a DD.
+      @param threshold Amplitudes with a magnitude below this threshold are
+  treated as zero.
+      @param nthreads The number of threads to use (0 for all available).
+      @return A vEdge that represents the DD.
+      @throws std::invalid_argument If the length of the given vector is not a
+  power of two.
+      @details With more than one thread, the vector is split into independent
+  chunks. Each chunk is converted in a private package on a worker thread. The
+  resulting DDs are then transferred to this package and combined at the top.
+  **/
+  vEdge makeStateFromVector(const CVec& stateVector, const fp threshold = 0.,
+                            const std::size_t nthreads = 1U) {
     if (stateVector.empty()) {
       return vEdge::one();
     }
@@ -474,23 +502,71 @@ public:
     }
 
     if (length == 1) {
-      return vEdge::terminal(cn.lookup(stateVector[0]));
+      return vEdge::terminal(cn.lookup(pruned(stateVector[0], threshold)));
     }
 
     const auto level = static_cast<Qubit>(std::log2(length) - 1);
-    const auto state =
-        makeStateFromVector(stateVector.begin(), stateVector.end(), level);
-    return {state.p, cn.lookup(state.w)};
+    const auto workers = numWorkers(nthreads, length / 2U);
+    if (workers <= 1U) {
+      const auto state = makeStateFromVector(
+          stateVector.begin(), stateVector.end(), level, threshold);
+      return {state.p, cn.lookup(state.w)};
+    }
+
+    // convert the chunks of the vector in parallel
+    const auto depth =
+        static_cast<Qubit>(std::min<std::size_t>(splitDepth(workers), level));
+    const auto chunkLevel = static_cast<Qubit>(level - depth);
+    const auto chunkLength = length >> depth;
+    std::vector<std::unique_ptr<Package>> packages(workers);
+    std::vector<vEdge> chunks(1ULL << depth);
+    parallelFor(chunks.size(), workers,
+                [&](const std::size_t chunk, const std::size_t worker) {
+                  auto& package = packages[worker];
+                  if (!package) {
+                    package = std::make_unique<Package>(chunkLevel + 1U);
+                  }
+                  const auto begin = stateVector.begin() +
+                                     static_cast<std::ptrdiff_t>(
+                                         chunk * chunkLength);
+                  const auto state = package->makeStateFromVector(
+                      begin, begin + static_cast<std::ptrdiff_t>(chunkLength),
+                      chunkLevel, threshold);
+                  chunks[chunk] = {state.p, package->cn.lookup(state.w)};
+                });
+
+    // combine the chunks at the top
+    std::vector<vCachedEdge> edges{};
+    edges.reserve(chunks.size());
+    for (auto& chunk : chunks) {
+      const auto e = transfer(chunk);
+      edges.emplace_back(e.p, e.w);
+    }
+    for (auto l = static_cast<Qubit>(chunkLevel + 1U); l <= level; ++l) {
+      for (std::size_t i = 0U; i < edges.size() / 2U; ++i) {
+        edges[i] = makeDDNode<vNode, CachedEdge>(
+            l, {edges[2U * i], edges[(2U * i) + 1U]});
+      }
+      edges.resize(edges.size() / 2U);
+    }
+    return {edges[0].p, cn.lookup(edges[0].w)};
   }
 
   /**
       Converts a given matrix to a decision diagram
       @param matrix A complex matrix to convert to a DD.
+      @param threshold Entries with a magnitude below this threshold are
+  treated as zero.
+      @param nthreads The number of threads to use (0 for all available).
       @return An mEdge that represents the DD.
       @throws std::invalid_argument If the given matrix is not square or its
   length is not a power of two.
+      @details With more than one thread, the matrix is split into independent
+  blocks. Each block is converted in a private package on a worker thread. The
+  resulting DDs are then transferred to this package and combined at the top.
   **/
-  mEdge makeDDFromMatrix(const CMat& matrix) {
+  mEdge makeDDFromMatrix(const CMat& matrix, const fp threshold = 0.,
+                         const std::size_t nthreads = 1U) {
     if (matrix.empty()) {
       return mEdge::one();
     }
@@ -507,12 +583,62 @@ public:
     }
 
     if (length == 1) {
-      return mEdge::terminal(cn.lookup(matrix[0][0]));
+      return mEdge::terminal(cn.lookup(pruned(matrix[0][0], threshold)));
     }
 
     const auto level = static_cast<Qubit>(std::log2(length) - 1);
-    const auto matrixDD = makeDDFromMatrix(matrix, level, 0, length, 0, width);
-    return {matrixDD.p, cn.lookup(matrixDD.w)};
+    const auto workers = numWorkers(nthreads, length * length / 4U);
+    if (workers <= 1U) {
+      const auto matrixDD =
+          makeDDFromMatrix(matrix, level, 0, length, 0, width, threshold);
+      return {matrixDD.p, cn.lookup(matrixDD.w)};
+    }
+
+    // convert the blocks of the matrix in parallel
+    const auto depth = static_cast<Qubit>(
+        std::min<std::size_t>(splitDepth(workers, NEDGE), level));
+    const auto blockLevel = static_cast<Qubit>(level - depth);
+    const auto blockLength = length >> depth;
+    const std::size_t side = 1ULL << depth;
+    std::vector<std::unique_ptr<Package>> packages(workers);
+    std::vector<mEdge> blocks(side * side);
+    parallelFor(blocks.size(), workers,
+                [&](const std::size_t block, const std::size_t worker) {
+                  auto& package = packages[worker];
+                  if (!package) {
+                    package = std::make_unique<Package>(blockLevel + 1U);
+                  }
+                  const auto row = (block / side) * blockLength;
+                  const auto col = (block % side) * blockLength;
+                  const auto matrixDD = package->makeDDFromMatrix(
+                      matrix, blockLevel, row, row + blockLength, col,
+                      col + blockLength, threshold);
+                  blocks[block] = {matrixDD.p,
+                                   package->cn.lookup(matrixDD.w)};
+                });
+
+    // combine the blocks at the top
+    std::vector<mCachedEdge> edges{};
+    edges.reserve(blocks.size());
+    for (auto& block : blocks) {
+      const auto e = transfer(block);
+      edges.emplace_back(e.p, e.w);
+    }
+    auto n = side;
+    for (auto l = static_cast<Qubit>(blockLevel + 1U); l <= level; ++l) {
+      n /= 2U;
+      for (std::size_t r = 0U; r < n; ++r) {
+        for (std::size_t c = 0U; c < n; ++c) {
+          const auto topLeft = (2U * r * 2U * n) + (2U * c);
+          const auto bottomLeft = topLeft + (2U * n);
+          edges[(r * n) + c] = makeDDNode<mNode, CachedEdge>(
+              l, {edges[topLeft], edges[topLeft + 1U], edges[bottomLeft],
+                  edges[bottomLeft + 1U]});
+        }
+      }
+      edges.resize(n * n);
+    }
+    return {edges[0].p, cn.lookup(edges[0].w)};
   }
 
   ///
@@ -726,21 +852,107 @@ public:
     return {e.p, cn.lookup(e.w)};
   }
 
+  /**
+   * @brief Creates the DD for a weighted sum of Pauli strings, e.g., a
+   * Hamiltonian
+   * @details Instead of summing the Kronecker products of the individual
+   * terms, the terms are recursively grouped by their operator on the highest
+   * remaining qubit. The DDs of the four groups (I, X, Y, Z) only act on the
+   * qubits below and are combined into a single node whose successors are
+   * [I + Z, X - iY, X + iY, I - Z]. Hence, terms sharing a prefix on the upper
+   * qubits are processed together, and the number of additions is bounded by
+   * the number of distinct prefixes.
+   * @param observable the weighted Pauli strings
+   * @return DD representing the sum
+   * @throws std::runtime_error if a Pauli string acts non-trivially on more
+   * qubits than the package supports
+   */
+  mEdge makePauliSumDD(const WeightedPauliSum& observable) {
+    std::size_t nq = 0U;
+    for (const auto& [coefficient, pauli] : observable) {
+      for (auto q = pauli.size(); q > nq; --q) {
+        if (pauli[q - 1U] != Pauli::I) {
+          nq = q;
+          break;
+        }
+      }
+    }
+    if (nq > nqubits) {
+      throw std::runtime_error{
+          "Requested observable acting on " + std::to_string(nq) +
+          " qubits while the package configuration only supports up to " +
+          std::to_string(nqubits) +
+          " qubits. Please allocate a larger package instance."};
+    }
+
+    std::vector<std::size_t> terms(observable.size());
+    std::iota(terms.begin(), terms.end(), 0U);
+    const auto e = makePauliSumDD(observable, terms, nq);
+    return {e.p, cn.lookup(e.w)};
+  }
+
 private:
+  /// DD of the sum of the given terms restricted to the lowest `level` qubits
+  mCachedEdge makePauliSumDD(const WeightedPauliSum& observable,
+                             const std::vector<std::size_t>& terms,
+                             const std::size_t level) {
+    if (level == 0U) {
+      fp sum = 0.;
+      for (const auto t : terms) {
+        sum += observable[t].first;
+      }
+      return mCachedEdge::terminal(ComplexValue{sum});
+    }
+
+    const auto q = static_cast<Qubit>(level - 1U);
+    std::array<std::vector<std::size_t>, 4U> groups{};
+    for (const auto t : terms) {
+      const auto& pauli = observable[t].second;
+      const auto p = q < pauli.size() ? pauli[q] : Pauli::I;
+      groups[static_cast<std::size_t>(p)].emplace_back(t);
+    }
+    std::array<mCachedEdge, 4U> sums{};
+    for (std::size_t p = 0U; p < groups.size(); ++p) {
+      sums[p] = groups[p].empty()
+                    ? mCachedEdge::zero()
+                    : makePauliSumDD(observable, groups[p], level - 1U);
+    }
+    const auto& [i, x, y, z] = sums;
+
+    // the successors are combined on the level below
+    const auto var = static_cast<Qubit>(q == 0U ? 0U : q - 1U);
+    const auto scaled = [](const mCachedEdge& e, const ComplexValue& factor) {
+      return e.w.exactlyZero() ? e : mCachedEdge{e.p, e.w * factor};
+    };
+    return makeDDNode(q, std::array{add2(i, z, var),
+                                    add2(x, scaled(y, {0., -1.}), var),
+                                    add2(x, scaled(y, {0., 1.}), var),
+                                    add2(i, scaled(z, -1.), var)});
+  }
+
+  // amplitudes with a magnitude below the threshold are treated as zero
+  static std::complex<fp> pruned(const std::complex<fp>& amplitude,
+                                 const fp threshold) {
+    return std::abs(amplitude) < threshold ? std::complex<fp>{0.} : amplitude;
+  }
+
   vCachedEdge makeStateFromVector(const CVec::const_iterator& begin,
                                   const CVec::const_iterator& end,
-                                  const Qubit level) {
+                                  const Qubit level, const fp threshold) {
     if (level == 0U) {
       assert(std::distance(begin, end) == 2);
-      const auto zeroSuccessor = vCachedEdge::terminal(*begin);
-      const auto oneSuccessor = vCachedEdge::terminal(*(begin + 1));
+      const auto zeroSuccessor =
+          vCachedEdge::terminal(pruned(*begin, threshold));
+      const auto oneSuccessor =
+          vCachedEdge::terminal(pruned(*(begin + 1), threshold));
       return makeDDNode<vNode, CachedEdge>(0, {zeroSuccessor, oneSuccessor});
     }
 
     const auto half = std::distance(begin, end) / 2;
     const auto zeroSuccessor =
-        makeStateFromVector(begin, begin + half, level - 1);
-    const auto oneSuccessor = makeStateFromVector(begin + half, end, level - 1);
+        makeStateFromVector(begin, begin + half, level - 1, threshold);
+    const auto oneSuccessor =
+        makeStateFromVector(begin + half, end, level - 1, threshold);
     return makeDDNode<vNode, CachedEdge>(level, {zeroSuccessor, oneSuccessor});
   }
 
@@ -754,6 +966,8 @@ private:
   @param rowEnd The ending row of the quadrant being processed.
   @param colStart The starting column of the quadrant being processed.
   @param colEnd The ending column of the quadrant being processed.
+  @param threshold Entries with a magnitude below this threshold are treated as
+  zero.
   @return An mCachedEdge representing the root node of the created DD.
   @details This function recursively breaks down the matrix into quadrants until
   each quadrant has only one element. At each level of recursion, four new edges
@@ -768,16 +982,18 @@ private:
                                const std::size_t rowStart,
                                const std::size_t rowEnd,
                                const std::size_t colStart,
-                               const std::size_t colEnd) {
+                               const std::size_t colEnd, const fp threshold) {
     // base case
     if (level == 0U) {
       assert(rowEnd - rowStart == 2);
       assert(colEnd - colStart == 2);
+      const auto& upper = matrix[rowStart];
+      const auto& lower = matrix[rowStart + 1];
       return makeDDNode<mNode, CachedEdge>(
-          0U, {mCachedEdge::terminal(matrix[rowStart][colStart]),
-               mCachedEdge::terminal(matrix[rowStart][colStart + 1]),
-               mCachedEdge::terminal(matrix[rowStart + 1][colStart]),
-               mCachedEdge::terminal(matrix[rowStart + 1][colStart + 1])});
+          0U, {mCachedEdge::terminal(pruned(upper[colStart], threshold)),
+               mCachedEdge::terminal(pruned(upper[colStart + 1], threshold)),
+               mCachedEdge::terminal(pruned(lower[colStart], threshold)),
+               mCachedEdge::terminal(pruned(lower[colStart + 1], threshold))});
     }
 
     // recursively call the function on all quadrants
@@ -786,10 +1002,15 @@ private:
     const auto l = static_cast<Qubit>(level - 1U);
 
     return makeDDNode<mNode, CachedEdge>(
-        level, {makeDDFromMatrix(matrix, l, rowStart, rowMid, colStart, colMid),
-                makeDDFromMatrix(matrix, l, rowStart, rowMid, colMid, colEnd),
-                makeDDFromMatrix(matrix, l, rowMid, rowEnd, colStart, colMid),
-                makeDDFromMatrix(matrix, l, rowMid, rowEnd, colMid, colEnd)});
+        level,
+        {makeDDFromMatrix(matrix, l, rowStart, rowMid, colStart, colMid,
+                          threshold),
+         makeDDFromMatrix(matrix, l, rowStart, rowMid, colMid, colEnd,
+                          threshold),
+         makeDDFromMatrix(matrix, l, rowMid, rowEnd, colStart, colMid,
+                          threshold),
+         makeDDFromMatrix(matrix, l, rowMid, rowEnd, colMid, colEnd,
+                          threshold)});
   }
 
 public:
@@ -899,10 +1120,53 @@ public:
     stochasticNoiseOperationCache.clear();
     densityAdd.clear();
     densityDensityMultiplication.clear();
+    densityOperationApplication.clear();
     densityNoise.clear();
+    densityChannel.clear();
     densityTrace.clear();
   }
 
+  /// Runtime sizing of the binary compute tables (disabled by default)
+  ComputeTableAdaptation computeTableAdaptation{};
+
+  /**
+   * @brief Perform a round of the adaptive compute table sizing.
+   * @details Called from @ref garbageCollect every
+   * `computeTableAdaptation.config.interval` calls if the adaptation is
+   * enabled. Resizing a table discards its cached results.
+   */
+  void adaptComputeTables() {
+    std::vector<ComputeTableUsage> usage{};
+    forEachAdaptiveComputeTable([&usage](const char* name, auto& table) {
+      usage.push_back({name, &table.getStats()});
+    });
+    const auto sizes = computeTableAdaptation.adapt(usage);
+    std::size_t i = 0U;
+    forEachAdaptiveComputeTable([&sizes, &i](const char*, auto& table) {
+      if (sizes[i] != table.getNumBuckets()) {
+        table.resize(sizes[i]);
+      }
+      ++i;
+    });
+  }
+
+private:
+  template <class F> void forEachAdaptiveComputeTable(const F& f) {
+    f("vector_add", vectorAdd);
+    f("matrix_add", matrixAdd);
+    f("density_matrix_add", densityAdd);
+    f("vector_add_magnitudes", vectorAddMagnitudes);
+    f("matrix_add_magnitudes", matrixAddMagnitudes);
+    f("matrix_vector_mult", matrixVectorMultiplication);
+    f("matrix_matrix_mult", matrixMatrixMultiplication);
+    f("density_density_mult", densityDensityMultiplication);
+    f("density_operation_application", densityOperationApplication);
+    f("vector_kronecker", vectorKronecker);
+    f("matrix_kronecker", matrixKronecker);
+    f("vector_inner_product", vectorInnerProduct);
+  }
+
+public:
   ///
   /// Measurements from state decision diagrams
   ///
@@ -971,110 +1235,233 @@ public:
   }
 
 private:
-  fp assignProbabilities(const vEdge& edge,
-                         std::unordered_map<const vNode*, fp>& probs) {
-    auto it = probs.find(edge.p);
-    if (it != probs.end()) {
-      return ComplexNumbers::mag2(edge.w) * it->second;
-    }
-    double sum{1};
-    if (!edge.isTerminal()) {
-      sum = assignProbabilities(edge.p->e[0], probs) +
-            assignProbabilities(edge.p->e[1], probs);
-    }
+  /**
+   * @brief Cache for the node probabilities of the most recently measured
+   * state.
+   * @see NodeProbabilityCache
+   */
+  NodeProbabilityCache nodeProbabilities{};
 
-    probs.insert({edge.p, sum});
+  /// Scratch space of `marginalProbabilities` that is reused across calls:
+  /// the offset of the marginal distribution of each visited node and the
+  /// distributions themselves
+  std::unordered_map<const vNode*, std::size_t> marginalOffsets{};
+  std::vector<fp> marginalValues{};
 
-    return ComplexNumbers::mag2(edge.w) * sum;
+public:
+  /// Get the cache for the node probabilities of the most recently measured
+  /// state
+  [[nodiscard]] const NodeProbabilityCache&
+  getNodeProbabilities() const noexcept {
+    return nodeProbabilities;
   }
 
-public:
+  /**
+   * @brief Determines the probabilities of measuring the qubit with the given
+   * index in the given state vector decision diagram.
+   * @details The node probabilities of the state are computed lazily and
+   * cached. A query on a fresh state only visits the levels above the qubit
+   * (and, without normalization assumption, the sub-vector norms of all
+   * nodes), while subsequent queries on the same state reuse that work.
+   * @param rootEdge the root edge of the state vector decision diagram
+   * @param index the index of the qubit to be measured
+   * @param assumeProbabilityNormalization whether or not to assume that the
+   * state vector decision diagram has normalized edge weights.
+   * @return the probabilities of measuring '0' and '1'
+   */
   std::pair<dd::fp, dd::fp>
   determineMeasurementProbabilities(const vEdge& rootEdge, const Qubit index,
                                     const bool assumeProbabilityNormalization) {
-    std::map<const vNode*, fp> measurementProbabilities;
-    std::set<const vNode*> visited;
-    std::queue<const vNode*> q;
-
-    measurementProbabilities[rootEdge.p] = ComplexNumbers::mag2(rootEdge.w);
-    visited.insert(rootEdge.p);
-    q.push(rootEdge.p);
-
-    while (q.front()->v != index) {
-      const auto* ptr = q.front();
-      q.pop();
-      const fp prob = measurementProbabilities[ptr];
-
-      const auto& s0 = ptr->e[0];
-      if (const auto s0w = static_cast<ComplexValue>(s0.w);
-          !s0w.approximatelyZero()) {
-        const fp tmp1 = prob * s0w.mag2();
-        if (visited.find(s0.p) != visited.end()) {
-          measurementProbabilities[s0.p] =
-              measurementProbabilities[s0.p] + tmp1;
-        } else {
-          measurementProbabilities[s0.p] = tmp1;
-          visited.insert(s0.p);
-          q.push(s0.p);
-        }
-      }
+    nodeProbabilities.compute(rootEdge, index,
+                              !assumeProbabilityNormalization);
+    const auto [pzero, pone] = nodeProbabilities.measurementProbabilities(
+        index, assumeProbabilityNormalization);
+    const auto rootProbability = ComplexNumbers::mag2(rootEdge.w);
+    return {rootProbability * pzero, rootProbability * pone};
+  }
 
-      const auto& s1 = ptr->e[1];
-      if (const auto s1w = static_cast<ComplexValue>(s1.w);
-          !s1w.approximatelyZero()) {
-        const fp tmp1 = prob * s1w.mag2();
-        if (visited.find(s1.p) != visited.end()) {
-          measurementProbabilities[s1.p] =
-              measurementProbabilities[s1.p] + tmp1;
-        } else {
-          measurementProbabilities[s1.p] = tmp1;
-          visited.insert(s1.p);
-          q.push(s1.p);
-        }
+  /**
+   * @brief Computes the marginal distribution of a subset of qubits of the
+   * given state vector decision diagram.
+   * @details The distribution is computed in a single bottom-up traversal of
+   * the nodes at or above the lowest requested qubit. Below that, the cached
+   * squared norms of the sub-vectors are used. Hence, the cost scales with the
+   * size of the decision diagram times 2^k for k requested qubits.
+   * @param rootEdge the root edge of the state vector decision diagram
+   * @param qubits the qubits whose marginal distribution is requested
+   * @return the probabilities of all 2^k outcomes, where bit i of the index
+   * corresponds to the outcome of qubits[i]
+   * @throws std::invalid_argument if a qubit is out of range or requested
+   * more than once, or if the outcomes cannot be indexed by a `std::size_t`.
+   */
+  std::vector<fp> marginalProbabilities(const vEdge& rootEdge,
+                                        const std::vector<Qubit>& qubits) {
+    constexpr auto maxQubits = std::numeric_limits<std::size_t>::digits;
+    if (qubits.size() >= maxQubits) {
+      throw std::invalid_argument(
+          "Marginal probabilities of at most " + std::to_string(maxQubits - 1) +
+          " qubits can be computed.");
+    }
+    const auto nq = rootEdge.isTerminal()
+                        ? std::size_t{0}
+                        : static_cast<std::size_t>(rootEdge.p->v) + 1U;
+    // the bit of the result index associated with each qubit (if any)
+    std::vector<std::size_t> bits(nq, 0U);
+    auto lowest = static_cast<Qubit>(nq);
+    for (std::size_t i = 0U; i < qubits.size(); ++i) {
+      const auto q = qubits[i];
+      if (static_cast<std::size_t>(q) >= nq) {
+        throw std::invalid_argument("Qubit " + std::to_string(q) +
+                                    " is out of range for a state with " +
+                                    std::to_string(nq) + " qubits.");
+      }
+      if (bits[q] != 0U) {
+        throw std::invalid_argument("Qubit " + std::to_string(q) +
+                                    " is requested more than once.");
       }
+      bits[q] = std::size_t{1} << i;
+      lowest = std::min(lowest, q);
     }
 
-    fp pzero{0};
-    fp pone{0};
+    std::vector<fp> result(std::size_t{1} << qubits.size(), 0.);
+    if (rootEdge.w.approximatelyZero()) {
+      return result;
+    }
+    nodeProbabilities.compute(rootEdge);
+    const auto rootProbability = ComplexNumbers::mag2(rootEdge.w);
+    if (qubits.empty()) {
+      result[0] = rootProbability *
+                  nodeProbabilities.subtreeProbability(rootEdge.p);
+      return result;
+    }
 
-    if (assumeProbabilityNormalization) {
-      while (!q.empty()) {
-        const auto* ptr = q.front();
-        q.pop();
-        const auto& s0 = ptr->e[0];
-        if (const auto s0w = static_cast<ComplexValue>(s0.w);
-            !s0w.approximatelyZero()) {
-          pzero += measurementProbabilities[ptr] * s0w.mag2();
-        }
-        const auto& s1 = ptr->e[1];
-        if (const auto s1w = static_cast<ComplexValue>(s1.w);
-            !s1w.approximatelyZero()) {
-          pone += measurementProbabilities[ptr] * s1w.mag2();
+    marginalOffsets.clear();
+    marginalValues.clear();
+    const auto start = marginalProbabilitiesRecursive(rootEdge.p, bits, lowest,
+                                                      result.size());
+    for (std::size_t i = 0U; i < result.size(); ++i) {
+      result[i] = rootProbability * marginalValues[start + i];
+    }
+    return result;
+  }
+
+private:
+  /// Compute the marginal distribution of a node and return its offset in
+  /// `marginalValues`
+  std::size_t
+  marginalProbabilitiesRecursive(const vNode* node,
+                                 const std::vector<std::size_t>& bits,
+                                 const Qubit lowest,
+                                 const std::size_t numOutcomes) {
+    if (const auto it = marginalOffsets.find(node);
+        it != marginalOffsets.end()) {
+      return it->second;
+    }
+    // the distributions of the children have to be stored before that of the
+    // node, since appending to `marginalValues` may reallocate it
+    std::array<std::size_t, RADIX> children{};
+    for (std::size_t i = 0U; i < RADIX; ++i) {
+      const auto& child = node->e[i];
+      if (!child.w.approximatelyZero() && !child.isTerminal() &&
+          child.p->v >= lowest) {
+        children[i] =
+            marginalProbabilitiesRecursive(child.p, bits, lowest, numOutcomes);
+      }
+    }
+    const auto start = marginalValues.size();
+    marginalValues.resize(start + numOutcomes, 0.);
+    const auto bit = bits[node->v];
+    for (std::size_t i = 0U; i < RADIX; ++i) {
+      const auto& child = node->e[i];
+      if (child.w.approximatelyZero()) {
+        continue;
+      }
+      const auto p = ComplexNumbers::mag2(child.w);
+      const auto offset = i == 0U ? 0U : bit;
+      if (child.isTerminal() || child.p->v < lowest) {
+        marginalValues[start + offset] +=
+            p * nodeProbabilities.subtreeProbability(child.p);
+        continue;
+      }
+      for (std::size_t j = 0U; j < numOutcomes; ++j) {
+        const auto sub = marginalValues[children[i] + j];
+        if (sub != 0.) {
+          marginalValues[start + (j | offset)] += p * sub;
         }
       }
-    } else {
-      std::unordered_map<const vNode*, fp> probs;
-      assignProbabilities(rootEdge, probs);
+    }
+    marginalOffsets.emplace(node, start);
+    return start;
+  }
+
+public:
+  /**
+   * @brief Approximates a state vector by removing edges with a small
+   * contribution to its norm.
+   * @details The contribution of an edge is the share of the squared norm of
+   * the state carried by all paths through the edge. Edges contributing less
+   * than `threshold` are replaced by zero edges and the remaining state is
+   * renormalized. As this projects the state onto the retained basis states,
+   * the fidelity between the original and the approximated state equals the
+   * retained share of the norm.
+   * @param rootEdge the root edge of the state vector decision diagram. It is
+   * expected to be reference counted and is replaced by the approximation.
+   * @param threshold the minimal contribution of an edge to be kept
+   * @return the fidelity between the original and the approximated state
+   */
+  fp approximate(vEdge& rootEdge, const fp threshold) {
+    if (rootEdge.isTerminal() || threshold <= 0.) {
+      return 1.;
+    }
+    nodeProbabilities.compute(rootEdge);
+    const auto norm = nodeProbabilities.subtreeProbability(rootEdge.p);
 
-      while (!q.empty()) {
-        const auto* ptr = q.front();
-        q.pop();
+    std::unordered_map<const vNode*, vCachedEdge> approximations;
+    const auto f =
+        approximateRecursive(rootEdge.p, threshold * norm, approximations);
+    if (f.w.approximatelyZero()) {
+      throw std::invalid_argument(
+          "Approximation threshold removes the entire state.");
+    }
+    // the nodes are normalized, so the weight holds the retained norm
+    const auto retained = f.w.mag2();
+    const auto e =
+        vEdge{f.p, cn.lookup(rootEdge.w * f.w / std::sqrt(retained))};
+    incRef(e);
+    decRef(rootEdge);
+    rootEdge = e;
+    return retained / norm;
+  }
 
-        const auto& s0 = ptr->e[0];
-        if (const auto s0w = static_cast<ComplexValue>(s0.w);
-            !s0w.approximatelyZero()) {
-          pzero += measurementProbabilities[ptr] * probs[s0.p] * s0w.mag2();
-        }
-        const auto& s1 = ptr->e[1];
-        if (const auto s1w = static_cast<ComplexValue>(s1.w);
-            !s1w.approximatelyZero()) {
-          pone += measurementProbabilities[ptr] * probs[s1.p] * s1w.mag2();
-        }
+private:
+  vCachedEdge approximateRecursive(
+      vNode* p, const fp threshold,
+      std::unordered_map<const vNode*, vCachedEdge>& approximations) {
+    if (const auto it = approximations.find(p); it != approximations.end()) {
+      return it->second;
+    }
+    const auto reach = nodeProbabilities.reachProbability(p);
+    std::array<vCachedEdge, RADIX> edges{};
+    for (std::size_t i = 0U; i < RADIX; ++i) {
+      const auto& child = p->e[i];
+      if (child.w.approximatelyZero() ||
+          reach * ComplexNumbers::mag2(child.w) *
+                  nodeProbabilities.subtreeProbability(child.p) <
+              threshold) {
+        edges[i] = vCachedEdge::zero();
+        continue;
+      }
+      if (child.isTerminal()) {
+        edges[i] = {child.p, child.w};
+        continue;
       }
+      edges[i] = approximateRecursive(child.p, threshold, approximations);
+      edges[i].w = edges[i].w * child.w;
     }
-    return {pzero, pone};
+    return approximations.emplace(p, makeDDNode(p->v, edges)).first->second;
   }
 
+public:
   /**
    * @brief Measures the qubit with the given index in the given state vector
    * decision diagram. Collapses the state according to the measurement result.
@@ -1491,18 +1878,119 @@ public:
     }
   }
 
+  ComputeTable<dNode*, dNode*, dCachedEdge, Config::CT_DM_DM_MULT_NBUCKET>
+      densityOperationApplication{};
+
+  /**
+   * @brief Apply an operation to a density matrix, i.e., compute U·ρ·U†.
+   * @details The conjugation is computed in a single traversal of ρ that
+   * exploits its Hermiticity: the lower off-diagonal block of every node on
+   * the diagonal path is derived from the upper one instead of being
+   * computed. Above the topmost qubit the operation acts on, U is the
+   * identity, so the diagonal blocks are conjugated recursively and only the
+   * off-diagonal blocks need to be multiplied. The explicit products ρ·U† and
+   * U·(ρ·U†) are only formed below that level.
+   * @param e The density matrix. It is replaced by the result.
+   * @param operation The operation U to apply.
+   * @return The resulting density matrix.
+   */
   dEdge applyOperationToDensity(dEdge& e, const mEdge& operation) {
-    auto tmp0 = conjugateTranspose(operation);
-    auto tmp1 = multiply(e, densityFromMatrixEdge(tmp0), false);
-    auto tmp2 = multiply(densityFromMatrixEdge(operation), tmp1, true);
-    incRef(tmp2);
+    const auto adjoint = conjugateTranspose(operation);
+    auto xCopy = e;
+    dEdge::applyDmChangesToEdge(xCopy);
+
+    Qubit var{};
+    if (!xCopy.isTerminal()) {
+      var = xCopy.p->v;
+    }
+    if (!operation.isTerminal() && operation.p->v > var) {
+      var = operation.p->v;
+    }
+
+    // the weight of the operation only contributes its squared magnitude
+    const auto u = dEdge{densityFromMatrixEdge(operation).p, Complex::one()};
+    const auto uDagger =
+        dEdge{densityFromMatrixEdge(adjoint).p, Complex::one()};
+    auto r = applyOperationToDensity2(xCopy, u, uDagger, var, true);
+    r.w = r.w * ComplexNumbers::mag2(operation.w);
+    dEdge::revertDmChangesToEdge(xCopy);
+
+    auto tmp = cn.lookup(r);
+    incRef(tmp);
     dEdge::alignDensityEdge(e);
     decRef(e);
-    e = tmp2;
+    e = tmp;
     dEdge::setDensityMatrixTrue(e);
     return e;
   }
 
+private:
+  /**
+   * @brief Recursively compute U·x·U† for the (sub-)matrix x at level var.
+   * @param x The density matrix with its temporary flags applied.
+   * @param u The operation with unit top weight.
+   * @param uDagger The adjoint of the operation with unit top weight.
+   * @param var The current level.
+   * @param hermitian Whether x lies on the diagonal path of the density
+   * matrix, i.e., whether the result may be stored in the reduced form.
+   * @return The resulting edge.
+   */
+  dCachedEdge applyOperationToDensity2(const dEdge& x, const dEdge& u,
+                                       const dEdge& uDagger, const Qubit var,
+                                       const bool hermitian) {
+    if (x.w.exactlyZero()) {
+      return dCachedEdge::zero();
+    }
+    if (u.isTerminal()) {
+      return {x.p, x.w};
+    }
+    if (u.p->v == var) {
+      // the operation acts non-trivially on this level
+      const auto tmp = cn.lookup(multiply2(x, uDagger, var, false));
+      if (tmp.w.exactlyZero()) {
+        return dCachedEdge::zero();
+      }
+      return multiply2(u, tmp, var, hermitian);
+    }
+
+    const auto xWeight = static_cast<ComplexValue>(x.w);
+    if (const auto* r =
+            densityOperationApplication.lookup(x.p, u.p, hermitian);
+        r != nullptr) {
+      return {r->p, r->w * xWeight};
+    }
+
+    const auto v = static_cast<Qubit>(var - 1);
+    std::array<dCachedEdge, NEDGE> edge{};
+    for (auto i = 0U; i < NEDGE; ++i) {
+      if (hermitian && i == 2) {
+        // the lower off-diagonal block is the adjoint of the upper one
+        edge[2] =
+            edge[1].w.approximatelyZero() ? dCachedEdge::zero() : edge[1];
+        continue;
+      }
+      if (x.isTerminal() || x.p->v != var) {
+        // x acts as the identity on this level
+        edge[i] = (i == 0 || i == 3)
+                      ? applyOperationToDensity2(dEdge{x.p, Complex::one()},
+                                                 u, uDagger, v, hermitian)
+                      : dCachedEdge::zero();
+        continue;
+      }
+      auto e = x.p->e[i];
+      dEdge::applyDmChangesToEdge(e);
+      edge[i] = applyOperationToDensity2(e, u, uDagger, v, hermitian && i != 1);
+      dEdge::revertDmChangesToEdge(e);
+    }
+
+    auto e = makeDDNode(var, edge, hermitian);
+    densityOperationApplication.insert(x.p, u.p, e);
+
+    e.w = e.w * xWeight;
+    return e;
+  }
+
+public:
   template <class LeftOperandNode, class RightOperandNode>
   Edge<RightOperandNode>
   multiply(const Edge<LeftOperandNode>& x, const Edge<RightOperandNode>& y,
@@ -1850,13 +2338,158 @@ public:
     return expValue.r;
   }
 
+  /**
+   * @brief Computes the expectation value of a Pauli string without
+   * constructing its matrix DD.
+   * @see expectationValue(const WeightedPauliSum&, const vEdge&)
+   */
+  fp expectationValue(const PauliString& observable, const vEdge& state) {
+    return expectationValue(WeightedPauliSum{{1., observable}}, state);
+  }
+
+  /**
+   * @brief Computes the expectation value of a weighted sum of Pauli strings
+   * without constructing its matrix DD.
+   * @details Each term <ψ|P|ψ> is evaluated in a joint traversal of the state
+   * with itself, where X and Y swap the successors of the right-hand side
+   * (the latter with a phase) and Z negates the contribution of the |1>
+   * successor. The intermediate results are cached for pairs of nodes and the
+   * operators acting on the levels below. Terms that agree on the operators of
+   * the lowest qubits share these results.
+   * @param observable the weighted Pauli strings
+   * @param state the state vector decision diagram
+   * @return the expectation value
+   * @throws std::invalid_argument if a Pauli string acts non-trivially on more
+   * qubits than the state
+   */
+  fp expectationValue(const WeightedPauliSum& observable, const vEdge& state) {
+    const auto nq = state.isTerminal()
+                        ? std::size_t{0}
+                        : static_cast<std::size_t>(state.p->v) + 1U;
+    PauliSuffixes suffixes{};
+    std::vector<std::size_t> roots{};
+    roots.reserve(observable.size());
+    for (const auto& [coefficient, pauli] : observable) {
+      for (std::size_t q = nq; q < pauli.size(); ++q) {
+        if (pauli[q] != Pauli::I) {
+          throw std::invalid_argument(
+              "Observable must not act on more qubits than the state to "
+              "compute the expectation value.");
+        }
+      }
+      std::size_t suffix = 0U;
+      for (std::size_t q = 0U; q < nq; ++q) {
+        suffix =
+            suffixes.insert(suffix, q < pauli.size() ? pauli[q] : Pauli::I);
+      }
+      roots.emplace_back(suffix);
+    }
+
+    if (state.w.approximatelyZero()) {
+      return 0.;
+    }
+    const auto norm = ComplexNumbers::mag2(state.w);
+    std::vector<PauliExpectationTable> tables(suffixes.operators.size());
+    ComplexValue expValue = 0;
+    for (std::size_t t = 0U; t < observable.size(); ++t) {
+      expValue += observable[t].first * norm *
+                  pauliExpectation(state.p, state.p, roots[t], suffixes,
+                                   tables);
+    }
+    assert(RealNumber::approximatelyZero(expValue.i));
+    return expValue.r;
+  }
+
+private:
+  /**
+   * @brief The suffixes of a set of Pauli strings, i.e., the operators on the
+   * qubits 0 to q for every q.
+   * @details Suffix 0 is the empty suffix. Every other suffix consists of the
+   * operator on its highest qubit and the index of the suffix below.
+   */
+  struct PauliSuffixes {
+    std::vector<std::pair<Pauli, std::size_t>> operators{{Pauli::I, 0U}};
+    /// whether the suffix only consists of identities
+    std::vector<bool> identity{true};
+    std::unordered_map<std::size_t, std::size_t> index{};
+
+    std::size_t insert(const std::size_t lower, const Pauli pauli) {
+      const auto key = (lower << 2U) | static_cast<std::size_t>(pauli);
+      const auto [it, inserted] = index.try_emplace(key, operators.size());
+      if (inserted) {
+        operators.emplace_back(pauli, lower);
+        identity.emplace_back(identity[lower] && pauli == Pauli::I);
+      }
+      return it->second;
+    }
+  };
+
+  struct NodePairHash {
+    std::size_t operator()(
+        const std::pair<const vNode*, const vNode*>& p) const noexcept {
+      return qc::combineHash(std::hash<const vNode*>{}(p.first),
+                             std::hash<const vNode*>{}(p.second));
+    }
+  };
+  using PauliExpectationTable =
+      std::unordered_map<std::pair<const vNode*, const vNode*>, ComplexValue,
+                         NodePairHash>;
+
+  /// <x|P|y> for the nodes x and y and the Pauli operators of the given suffix
+  ComplexValue pauliExpectation(const vNode* x, const vNode* y,
+                                const std::size_t suffix,
+                                const PauliSuffixes& suffixes,
+                                std::vector<PauliExpectationTable>& tables) {
+    if (x == y && suffixes.identity[suffix]) {
+      // the nodes represent normalized vectors
+      return 1;
+    }
+    if (vNode::isTerminal(x)) {
+      return 1;
+    }
+    auto& table = tables[suffix];
+    if (const auto it = table.find({x, y}); it != table.end()) {
+      return it->second;
+    }
+
+    const auto [pauli, lower] = suffixes.operators[suffix];
+    // the successor of y paired with the i-th successor of x and its phase
+    const auto swap = pauli == Pauli::X || pauli == Pauli::Y;
+    ComplexValue result = 0;
+    for (std::size_t i = 0U; i < RADIX; ++i) {
+      const auto& left = x->e[i];
+      const auto& right = y->e[swap ? 1U - i : i];
+      if (left.w.approximatelyZero() || right.w.approximatelyZero()) {
+        continue;
+      }
+      auto weight = static_cast<ComplexValue>(left.w);
+      weight.i = -weight.i;
+      weight = weight * static_cast<ComplexValue>(right.w);
+      if (pauli == Pauli::Y) {
+        // Y|0> = i|1> and Y|1> = -i|0>
+        weight = weight * (i == 0U ? ComplexValue{0., -1.}
+                                   : ComplexValue{0., 1.});
+      } else if (pauli == Pauli::Z && i == 1U) {
+        weight = weight * -1.;
+      }
+      result += weight *
+                pauliExpectation(left.p, right.p, lower, suffixes, tables);
+    }
+    table.emplace(std::pair{x, y}, result);
+    return result;
+  }
+
+public:
   ///
   /// Kronecker/tensor product
   ///
 
-  ComputeTable<vNode*, vNode*, vCachedEdge, Config::CT_VEC_KRON_NBUCKET>
+  /// the lower operand is keyed together with the offset of the upper one
+  ComputeTable<vNode*, OffsetOperand<vNode>, vCachedEdge,
+               Config::CT_VEC_KRON_NBUCKET>
       vectorKronecker{};
-  ComputeTable<mNode*, mNode*, mCachedEdge, Config::CT_MAT_KRON_NBUCKET>
+  ComputeTable<mNode*, OffsetOperand<mNode>, mCachedEdge,
+               Config::CT_MAT_KRON_NBUCKET>
       matrixKronecker{};
 
   template <class Node> [[nodiscard]] auto& getKroneckerComputeTable() {
@@ -1867,6 +2500,18 @@ public:
     }
   }
 
+  /**
+   * @brief Computes the Kronecker product x ⊗ y.
+   * @details The levels of x are shifted up by the number of qubits of y (if
+   * `incIdx` is set). A Kronecker product with the identity on the right is
+   * computed by level shifting (see insertQubits).
+   * @param x The upper operand.
+   * @param y The lower operand.
+   * @param yNumQubits The number of qubits y acts on. For matrices, this may
+   * exceed the height of the DD of y due to skipped identities.
+   * @param incIdx Whether to shift the levels of x.
+   * @return The product.
+   */
   template <class Node>
   Edge<Node> kronecker(const Edge<Node>& x, const Edge<Node>& y,
                        const std::size_t yNumQubits, const bool incIdx = true) {
@@ -1875,15 +2520,60 @@ public:
           "Kronecker is currently not supported for density matrices");
     }
 
-    const auto e = kronecker2(x, y, yNumQubits, incIdx);
+    if constexpr (std::is_same_v<Node, mNode>) {
+      if (incIdx && y.isIdentity() && !x.isIdentity()) {
+        std::unordered_map<const mNode*, mCachedEdge> shifted{};
+        auto e = insertQubits2(x, 0, static_cast<Qubit>(yNumQubits), shifted);
+        e.w = e.w * static_cast<ComplexValue>(y.w);
+        return cn.lookup(e);
+      }
+    }
+
+    const auto offset = incIdx ? yNumQubits : 0U;
+    const auto e = kronecker2(x, y, static_cast<Qubit>(offset));
     return cn.lookup(e);
   }
 
+  /**
+   * @brief Inserts idle qubits into the register a DD is defined on.
+   * @details The qubits at or above `position` are moved up by `count` levels.
+   * Matrices act as the identity on the new qubits and vectors are extended by
+   * |0...0⟩ on them. Only the nodes at or above the insertion point are
+   * rebuilt. The sub-diagrams below are reused as they are, so extending a DD
+   * above its top qubit takes O(count) operations for vectors and none for
+   * matrices.
+   * @param e The DD.
+   * @param position The level at which the qubits are inserted.
+   * @param count The number of qubits to insert.
+   * @return The extended DD.
+   * @throws std::invalid_argument if a vector would have skipped levels, i.e.,
+   * if `position` exceeds its number of qubits.
+   */
+  template <class Node>
+  Edge<Node> insertQubits(const Edge<Node>& e, const Qubit position,
+                          const std::size_t count) {
+    static_assert(std::disjunction_v<std::is_same<Node, vNode>,
+                                     std::is_same<Node, mNode>>,
+                  "Qubits can only be inserted into vectors or matrices");
+    if constexpr (std::is_same_v<Node, vNode>) {
+      const auto height = e.isTerminal() ? 0 : e.p->v + 1;
+      if (position > height) {
+        throw std::invalid_argument(
+            "Qubits must not be inserted above the top of a vector.");
+      }
+    }
+    if (count == 0U || e.w.exactlyZero()) {
+      return e;
+    }
+    std::unordered_map<const Node*, CachedEdge<Node>> shifted{};
+    return cn.lookup(
+        insertQubits2(e, position, static_cast<Qubit>(count), shifted));
+  }
+
 private:
   template <class Node>
   CachedEdge<Node> kronecker2(const Edge<Node>& x, const Edge<Node>& y,
-                              const std::size_t yNumQubits,
-                              const bool incIdx = true) {
+                              const Qubit offset) {
     if (x.w.exactlyZero() || y.w.exactlyZero()) {
       return CachedEdge<Node>::zero();
     }
@@ -1916,34 +2606,60 @@ private:
 
     // check if we already computed the product before and return the result
     auto& computeTable = getKroneckerComputeTable<Node>();
-    if (const auto* r = computeTable.lookup(x.p, y.p); r != nullptr) {
+    const OffsetOperand<Node> lower{y.p, offset};
+    if (const auto* r = computeTable.lookup(x.p, lower); r != nullptr) {
       return {r->p, rWeight};
     }
 
     constexpr std::size_t n = std::tuple_size_v<decltype(x.p->e)>;
     std::array<CachedEdge<Node>, n> edge{};
     for (auto i = 0U; i < n; ++i) {
-      edge[i] = kronecker2(x.p->e[i], y, yNumQubits, incIdx);
+      edge[i] = kronecker2(x.p->e[i], y, offset);
     }
 
-    // Increase the qubit index
-    Qubit idx = x.p->v;
-    if (incIdx) {
-      // use the given number of qubits if y is an identity
-      if constexpr (std::is_same_v<Node, mNode> ||
-                    std::is_same_v<Node, dNode>) {
-        if (y.isIdentity()) {
-          idx += static_cast<Qubit>(yNumQubits);
-        } else {
-          idx += static_cast<Qubit>(y.p->v + 1U);
+    auto e = makeDDNode(static_cast<Qubit>(x.p->v + offset), edge, true);
+    computeTable.insert(x.p, lower, {e.p, e.w});
+    return {e.p, rWeight};
+  }
+
+  template <class Node>
+  CachedEdge<Node>
+  insertQubits2(const Edge<Node>& e, const Qubit position, const Qubit count,
+                std::unordered_map<const Node*, CachedEdge<Node>>& shifted) {
+    if (e.w.exactlyZero()) {
+      return CachedEdge<Node>::zero();
+    }
+    const auto weight = static_cast<ComplexValue>(e.w);
+    const auto below = e.isTerminal() || e.p->v < position;
+    if constexpr (std::is_same_v<Node, mNode>) {
+      if (below) {
+        // skipped levels already represent the identity
+        return {e.p, weight};
+      }
+    }
+    if (const auto it = shifted.find(e.p); it != shifted.end()) {
+      return {it->second.p, it->second.w * weight};
+    }
+
+    CachedEdge<Node> r{};
+    if (below) {
+      if constexpr (std::is_same_v<Node, vNode>) {
+        // put the new qubits of the vector into |0>
+        r = {e.p, ComplexValue{1.}};
+        for (auto q = position; q < position + count; ++q) {
+          r = makeDDNode(q, std::array{r, vCachedEdge::zero()});
         }
-      } else {
-        idx += static_cast<Qubit>(y.p->v + 1U);
       }
+    } else {
+      constexpr std::size_t n = std::tuple_size_v<decltype(e.p->e)>;
+      std::array<CachedEdge<Node>, n> edge{};
+      for (auto i = 0U; i < n; ++i) {
+        edge[i] = insertQubits2(e.p->e[i], position, count, shifted);
+      }
+      r = makeDDNode(static_cast<Qubit>(e.p->v + count), edge);
     }
-    auto e = makeDDNode(idx, edge, true);
-    computeTable.insert(x.p, y.p, {e.p, e.w});
-    return {e.p, rWeight};
+    shifted.emplace(e.p, r);
+    return {r.p, r.w * weight};
   }
 
   ///
@@ -1968,6 +2684,91 @@ public:
     return {r.p, cn.lookup(r.w)};
   }
 
+  /**
+   * @brief Computes the reduced density matrix of a subsystem of a state.
+   * @details The partial trace Tr_B(|ψ⟩⟨ψ|) is computed by a joint traversal
+   * of |ψ⟩ and ⟨ψ| without ever constructing the outer product. Pairs of
+   * nodes are memoized and the traversal stops as soon as both sides reach
+   * the same node below the lowest retained qubit, since nodes represent
+   * normalized vectors. The cost is thus governed by the part of the DD above
+   * the lowest retained qubit.
+   * @param state The state |ψ⟩.
+   * @param eliminate Which qubits to trace out (one entry per qubit).
+   * @return The reduced density matrix on the retained qubits, which are
+   * relabeled to 0, ..., k-1 in their original order.
+   * @throws std::invalid_argument if `eliminate` does not have exactly one
+   * entry per qubit of the state.
+   */
+  mEdge reducedDensityMatrix(const vEdge& state,
+                             const std::vector<bool>& eliminate) {
+    if (state.w.exactlyZero()) {
+      return mEdge::zero();
+    }
+    const auto numQubits =
+        state.isTerminal() ? 0U : static_cast<std::size_t>(state.p->v) + 1U;
+    if (eliminate.size() != numQubits) {
+      throw std::invalid_argument(
+          "Every qubit of the state must be either kept or eliminated.");
+    }
+    // the number of retained qubits below each level
+    std::vector<Qubit> kept(eliminate.size() + 1U, 0);
+    for (std::size_t q = 0U; q < eliminate.size(); ++q) {
+      kept[q + 1U] = static_cast<Qubit>(kept[q] + (eliminate[q] ? 0 : 1));
+    }
+    ReducedDensityTable table{};
+    auto r = reducedDensityMatrix(state.p, state.p, kept, table);
+    r.w = r.w * ComplexNumbers::mag2(state.w);
+    return {r.p, cn.lookup(r.w)};
+  }
+
+  /**
+   * @brief Computes the Rényi-2 entropy -log2 Tr(ρ²) of the reduced state of
+   * a subsystem.
+   * @details The purity is evaluated on the DD of the reduced density matrix.
+   * @param state The (normalized) state.
+   * @param eliminate Which qubits to trace out (one entry per qubit).
+   * @return The entropy in bits.
+   * @throws std::invalid_argument if `eliminate` does not have exactly one
+   * entry per qubit of the state.
+   * @see reducedDensityMatrix
+   */
+  fp renyi2Entropy(const vEdge& state, const std::vector<bool>& eliminate) {
+    const auto rho = reducedDensityMatrix(state, eliminate);
+    const auto numKept = static_cast<std::size_t>(
+        std::count(eliminate.begin(), eliminate.end(), false));
+    // the trace of matrices is normalized by the dimension
+    const auto purity = trace(multiply(rho, rho), numKept).r *
+                        std::ldexp(1., static_cast<int>(numKept));
+    return -std::log2(purity);
+  }
+
+  /**
+   * @brief Computes the von Neumann entropy -Tr(ρ log2 ρ) of the reduced state
+   * of a subsystem.
+   * @details The reduced density matrix is computed on the DD and then
+   * diagonalized as a dense 2^k x 2^k matrix, so this is meant for small
+   * subsystems of (possibly) large states.
+   * @param state The (normalized) state.
+   * @param eliminate Which qubits to trace out (one entry per qubit).
+   * @return The entropy in bits.
+   * @throws std::invalid_argument if `eliminate` does not have exactly one
+   * entry per qubit of the state.
+   * @see reducedDensityMatrix
+   */
+  fp vonNeumannEntropy(const vEdge& state,
+                       const std::vector<bool>& eliminate) {
+    const auto rho = reducedDensityMatrix(state, eliminate);
+    const auto numKept = static_cast<std::size_t>(
+        std::count(eliminate.begin(), eliminate.end(), false));
+    fp entropy = 0.;
+    for (const auto lambda : hermitianEigenvalues(rho.getMatrix(numKept))) {
+      if (lambda > RealNumber::eps) {
+        entropy -= lambda * std::log2(lambda);
+      }
+    }
+    return entropy;
+  }
+
   template <class Node>
   ComplexValue trace(const Edge<Node>& a, const std::size_t numQubits) {
     if (a.isIdentity()) {
@@ -2088,6 +2889,134 @@ private:
     return r;
   }
 
+  using ReducedDensityTable =
+      std::unordered_map<std::pair<const vNode*, const vNode*>, mCachedEdge,
+                         NodePairHash>;
+
+  /// Tr_B(|x⟩⟨y|) for the nodes x and y, where `kept[q]` is the number of
+  /// retained qubits below qubit q
+  mCachedEdge reducedDensityMatrix(const vNode* x, const vNode* y,
+                                   const std::vector<Qubit>& kept,
+                                   ReducedDensityTable& table) {
+    if (vNode::isTerminal(x)) {
+      return mCachedEdge::terminal(ComplexValue{1.});
+    }
+    const auto v = static_cast<std::size_t>(x->v);
+    if (x == y && kept[v + 1U] == 0) {
+      // the nodes represent normalized vectors
+      return mCachedEdge::terminal(ComplexValue{1.});
+    }
+    if (const auto it = table.find({x, y}); it != table.end()) {
+      return it->second;
+    }
+
+    const auto weight = [](const vEdge& left, const vEdge& right) {
+      auto w = static_cast<ComplexValue>(right.w);
+      w.i = -w.i;
+      return static_cast<ComplexValue>(left.w) * w;
+    };
+    mCachedEdge r{};
+    if (kept[v + 1U] == kept[v]) {
+      // the qubit is traced out: sum up the diagonal blocks
+      r = mCachedEdge::zero();
+      for (std::size_t i = 0U; i < RADIX; ++i) {
+        const auto& left = x->e[i];
+        const auto& right = y->e[i];
+        if (left.w.approximatelyZero() || right.w.approximatelyZero()) {
+          continue;
+        }
+        auto term = reducedDensityMatrix(left.p, right.p, kept, table);
+        term.w = term.w * weight(left, right);
+        r = add2(r, term, static_cast<Qubit>(kept[v] - 1));
+      }
+    } else {
+      std::array<mCachedEdge, NEDGE> edges{};
+      for (std::size_t i = 0U; i < RADIX; ++i) {
+        for (std::size_t j = 0U; j < RADIX; ++j) {
+          const auto& left = x->e[i];
+          const auto& right = y->e[j];
+          auto& edge = edges[(RADIX * i) + j];
+          if (left.w.approximatelyZero() || right.w.approximatelyZero()) {
+            edge = mCachedEdge::zero();
+            continue;
+          }
+          edge = reducedDensityMatrix(left.p, right.p, kept, table);
+          edge.w = edge.w * weight(left, right);
+        }
+      }
+      r = makeDDNode(kept[v], edges);
+    }
+    table.emplace(std::pair{x, y}, r);
+    return r;
+  }
+
+  /// The eigenvalues of a Hermitian matrix in ascending order (cyclic Jacobi
+  /// method on the equivalent real symmetric matrix of twice the dimension)
+  static std::vector<fp> hermitianEigenvalues(const CMat& matrix) {
+    const auto n = matrix.size();
+    const auto dim = 2U * n;
+    // [ Re(A) -Im(A) ]
+    // [ Im(A)  Re(A) ] has every eigenvalue of A twice
+    std::vector<fp> a(dim * dim);
+    for (std::size_t i = 0U; i < n; ++i) {
+      for (std::size_t j = 0U; j < n; ++j) {
+        const auto& value = matrix[i][j];
+        a[(i * dim) + j] = value.real();
+        a[((i + n) * dim) + j + n] = value.real();
+        a[((i + n) * dim) + j] = value.imag();
+        a[(i * dim) + j + n] = -value.imag();
+      }
+    }
+    constexpr std::size_t maxSweeps = 100U;
+    for (std::size_t sweep = 0U; sweep < maxSweeps; ++sweep) {
+      fp off = 0.;
+      for (std::size_t p = 0U; p < dim; ++p) {
+        for (std::size_t q = p + 1U; q < dim; ++q) {
+          off += a[(p * dim) + q] * a[(p * dim) + q];
+        }
+      }
+      if (off < RealNumber::eps * RealNumber::eps) {
+        break;
+      }
+      for (std::size_t p = 0U; p < dim; ++p) {
+        for (std::size_t q = p + 1U; q < dim; ++q) {
+          const auto apq = a[(p * dim) + q];
+          if (std::abs(apq) < std::numeric_limits<fp>::min()) {
+            continue;
+          }
+          const auto theta =
+              (a[(q * dim) + q] - a[(p * dim) + p]) / (2. * apq);
+          const auto t = std::copysign(1., theta) /
+                         (std::abs(theta) + std::sqrt((theta * theta) + 1.));
+          const auto c = 1. / std::sqrt((t * t) + 1.);
+          const auto s = t * c;
+          for (std::size_t k = 0U; k < dim; ++k) {
+            const auto akp = a[(k * dim) + p];
+            const auto akq = a[(k * dim) + q];
+            a[(k * dim) + p] = (c * akp) - (s * akq);
+            a[(k * dim) + q] = (s * akp) + (c * akq);
+          }
+          for (std::size_t k = 0U; k < dim; ++k) {
+            const auto apk = a[(p * dim) + k];
+            const auto aqk = a[(q * dim) + k];
+            a[(p * dim) + k] = (c * apk) - (s * aqk);
+            a[(q * dim) + k] = (s * apk) + (c * aqk);
+          }
+        }
+      }
+    }
+    std::vector<fp> diagonal(dim);
+    for (std::size_t i = 0U; i < dim; ++i) {
+      diagonal[i] = a[(i * dim) + i];
+    }
+    std::sort(diagonal.begin(), diagonal.end());
+    std::vector<fp> eigenvalues(n);
+    for (std::size_t i = 0U; i < n; ++i) {
+      eigenvalues[i] = diagonal[2U * i];
+    }
+    return eigenvalues;
+  }
+
   bool isCloseToIdentityRecursive(const mEdge& m,
                                   std::unordered_set<decltype(m.p)>& visited,
                                   const dd::fp tol,
@@ -2181,6 +3110,11 @@ public:
   StochasticNoiseOperationTable<mEdge, Config::STOCHASTIC_CACHE_OPS>
       stochasticNoiseOperationCache{nqubits};
   DensityNoiseTable<dEdge, dEdge, Config::CT_DM_NOISE_NBUCKET> densityNoise{};
+  /// results of applying Kraus channels, identified by the pointers of the
+  /// DDs of their Kraus operators and weights
+  DensityNoiseTable<dEdge, dEdge, Config::CT_DM_NOISE_NBUCKET,
+                    std::vector<std::uintptr_t>>
+      densityChannel{};
 
   ///
   /// Ancillary and garbage reduction
@@ -2569,79 +3503,249 @@ public:
       return {original.p, cn.lookup(original.w)};
     }
 
-    // POST ORDER TRAVERSAL USING ONE STACK
-    // https://www.geeksforgeeks.org/iterative-postorder-traversal-using-stack/
-    Edge<Node> root{};
-    std::stack<Edge<Node>*> stack;
-
-    std::unordered_map<decltype(original.p), decltype(original.p)> mappedNode{};
-
-    Edge<Node>* currentEdge = &original;
+    // post-order traversal: a node is rebuilt once all its successors are
     constexpr std::size_t n = std::tuple_size_v<decltype(original.p->e)>;
-    // NOLINTNEXTLINE(cppcoreguidelines-avoid-do-while)
-    do {
-      while (currentEdge != nullptr && !currentEdge->isTerminal()) {
-        for (std::size_t i = n - 1; i > 0; --i) {
-          auto& edge = currentEdge->p->e[i];
-          if (edge.isTerminal()) {
-            continue;
-          }
-          if (edge.w.approximatelyZero()) {
-            continue;
-          }
-          if (mappedNode.find(edge.p) != mappedNode.end()) {
-            continue;
+    std::unordered_map<const Node*, CachedEdge<Node>> mappedNode{};
+    std::vector<std::pair<Node*, bool>> stack{{original.p, false}};
+    while (!stack.empty()) {
+      const auto [node, expanded] = stack.back();
+      if (mappedNode.count(node) != 0U) {
+        stack.pop_back();
+        continue;
+      }
+      if (!expanded) {
+        stack.back().second = true;
+        for (const auto& edge : node->e) {
+          if (!edge.isTerminal() && !edge.w.approximatelyZero() &&
+              mappedNode.count(edge.p) == 0U) {
+            stack.emplace_back(edge.p, false);
           }
-
-          // non-zero edge to be included
-          stack.push(&edge);
         }
-        stack.push(currentEdge);
-        currentEdge = &currentEdge->p->e[0];
+        continue;
       }
-      currentEdge = stack.top();
-      stack.pop();
+      stack.pop_back();
 
-      bool hasChild = false;
-      for (std::size_t i = 1; i < n && !hasChild; ++i) {
-        auto& edge = currentEdge->p->e[i];
-        if (edge.w.approximatelyZero()) {
-          continue;
-        }
-        if (mappedNode.find(edge.p) != mappedNode.end()) {
-          continue;
+      std::array<CachedEdge<Node>, n> edges{};
+      for (std::size_t i = 0; i < n; i++) {
+        const auto& edge = node->e[i];
+        const auto w = static_cast<ComplexValue>(edge.w);
+        if (edge.isTerminal()) {
+          edges[i] = {edge.p, w};
+        } else if (edge.w.approximatelyZero()) {
+          edges[i] = CachedEdge<Node>::zero();
+        } else {
+          // the node may be normalized differently in this package
+          const auto& child = mappedNode.at(edge.p);
+          edges[i] = {child.p, child.w * w};
         }
-        hasChild = edge.p == stack.top()->p;
       }
+      mappedNode.emplace(node, makeDDNode(node->v, edges));
+    }
+
+    const auto& root = mappedNode.at(original.p);
+    return {root.p, cn.lookup(root.w * static_cast<ComplexValue>(original.w))};
+  }
+
+  ///
+  /// Relabeling of qubits
+  ///
+
+  /**
+   * @brief Moves the qubits of a state to other levels.
+   * @details The DD is rebuilt under the new level order in a single top-down
+   * pass instead of being multiplied with a SWAP DD per transposition. For
+   * every new level, the corresponding qubit of the original DD is fixed to
+   * each of its values. This only rebuilds the nodes above that qubit.
+   * @param e the state
+   * @param permutation the new level of the qubit at every level (has to cover
+   * all levels of the state)
+   * @return the relabeled state
+   */
+  vEdge permuteQubits(const vEdge& e, const std::vector<Qubit>& permutation) {
+    if (e.isTerminal()) {
+      return e;
+    }
+    if (permutation.size() != static_cast<std::size_t>(e.p->v) + 1U) {
+      throw std::invalid_argument(
+          "The permutation has to cover all qubits of the state.");
+    }
+    QubitRelabeling<vNode> relabeling(permutation, permutation);
+    return relabel(e, relabeling);
+  }
+
+  /**
+   * @brief Moves the qubits of an operation to other levels.
+   * @details With P denoting the permutation matrix that relabels a state
+   * accordingly, relabeling the rows yields P * e, relabeling the columns
+   * e * P^T and relabeling both P * e * P^T.
+   * @param e the operation
+   * @param permutation the new level of the qubit at every level (has to cover
+   * all levels of the operation)
+   * @param rows whether to relabel the rows
+   * @param columns whether to relabel the columns
+   * @return the relabeled operation
+   * @see permuteQubits(const vEdge&, const std::vector<Qubit>&)
+   */
+  mEdge permuteQubits(const mEdge& e, const std::vector<Qubit>& permutation,
+                      const bool rows = true, const bool columns = true) {
+    if (!e.isTerminal() &&
+        permutation.size() <= static_cast<std::size_t>(e.p->v)) {
+      throw std::invalid_argument(
+          "The permutation has to cover all qubits of the operation.");
+    }
+    std::vector<Qubit> identity(permutation.size());
+    std::iota(identity.begin(), identity.end(), Qubit{0U});
+    QubitRelabeling<mNode> relabeling(rows ? permutation : identity,
+                                      columns ? permutation : identity);
+    return relabel(e, relabeling);
+  }
+
+private:
+  template <class Node> struct QubitRelabeling {
+    QubitRelabeling(const std::vector<Qubit>& rows,
+                    const std::vector<Qubit>& columns)
+        : rowTargets(rows), columnTargets(columns), rowSources(rows.size()),
+          columnSources(columns.size()) {
+      for (std::size_t level = 0U; level < rows.size(); ++level) {
+        rowSources.at(rows[level]) = static_cast<Qubit>(level);
+        columnSources.at(columns[level]) = static_cast<Qubit>(level);
+      }
+    }
+
+    /// the new level of the (row) qubit at every original level
+    std::vector<Qubit> rowTargets;
+    /// the new level of the column qubit at every original level
+    std::vector<Qubit> columnTargets;
+    /// the original level of the (row) qubit at every new level
+    std::vector<Qubit> rowSources;
+    /// the original level of the column qubit at every new level
+    std::vector<Qubit> columnSources;
+
+    /// relabeled nodes per new level
+    std::unordered_map<std::pair<const Node*, Qubit>, CachedEdge<Node>,
+                       qc::PairHash<const Node*, Qubit>>
+        relabeled{};
+    /// restricted nodes per original level and fixed bits
+    std::unordered_map<std::pair<const Node*, std::uint32_t>,
+                       CachedEdge<Node>,
+                       qc::PairHash<const Node*, std::uint32_t>>
+        restricted{};
+  };
+
+  template <class Node>
+  Edge<Node> relabel(const Edge<Node>& e, QubitRelabeling<Node>& relabeling) {
+    if (e.w.exactlyZero()) {
+      return Edge<Node>::zero();
+    }
+    const auto top = static_cast<std::int64_t>(relabeling.rowSources.size());
+    const auto r = relabel(CachedEdge<Node>{e.p, ComplexValue{1.}}, top - 1,
+                           relabeling);
+    return {r.p, cn.lookup(r.w * static_cast<ComplexValue>(e.w))};
+  }
+
+  /// Builds the part of the relabeled DD from `level` downwards. All qubits
+  /// placed above have already been fixed in `e`.
+  template <class Node>
+  CachedEdge<Node> relabel(const CachedEdge<Node>& e, const std::int64_t level,
+                           QubitRelabeling<Node>& relabeling) {
+    if (e.w.approximatelyZero()) {
+      return CachedEdge<Node>::zero();
+    }
+    if (level < 0) {
+      // every qubit has been fixed and, thus, removed
+      assert(e.isTerminal());
+      return e;
+    }
+
+    const auto v = static_cast<Qubit>(level);
+    const auto key = std::pair<const Node*, Qubit>{e.p, v};
+    if (const auto it = relabeling.relabeled.find(key);
+        it != relabeling.relabeled.end()) {
+      return {it->second.p, it->second.w * e.w};
+    }
+
+    constexpr std::size_t n = std::tuple_size_v<decltype(Node::e)>;
+    const CachedEdge<Node> f{e.p, ComplexValue{1.}};
+    std::array<CachedEdge<Node>, n> edges{};
+    for (std::size_t i = 0U; i < n; ++i) {
+      if constexpr (n == NEDGE) {
+        // successor i corresponds to row bit i / 2 and column bit i % 2. A
+        // level is removed once both of its bits are fixed.
+        const auto row = relabeling.rowSources[v];
+        const auto column = relabeling.columnSources[v];
+        auto g = restrictLevel(f, row, 2U, i & 2U,
+                               relabeling.columnTargets[row] > v, relabeling);
+        g = restrictLevel(g, column, 1U, i & 1U,
+                          relabeling.rowTargets[column] >= v, relabeling);
+        edges[i] = relabel(g, level - 1, relabeling);
+      } else {
+        const auto g =
+            restrictLevel(f, relabeling.rowSources[v], 1U, i, true, relabeling);
+        edges[i] = relabel(g, level - 1, relabeling);
+      }
+    }
+    const auto r = makeDDNode(v, edges);
+    relabeling.relabeled.emplace(key, r);
+    return {r.p, r.w * e.w};
+  }
 
-      if (hasChild) {
-        Edge<Node>* temp = stack.top();
-        stack.pop();
-        stack.push(currentEdge);
-        currentEdge = temp;
+  /**
+   * @brief Fixes the bits `mask` of the successor index at `level` to `value`.
+   * @details If the other bits of the level have already been fixed, the level
+   * is removed. Otherwise, the successors are duplicated.
+   */
+  template <class Node>
+  CachedEdge<Node> restrictLevel(const CachedEdge<Node>& e, const Qubit level,
+                                 const std::size_t mask,
+                                 const std::size_t value, const bool removes,
+                                 QubitRelabeling<Node>& relabeling) {
+    if (e.w.approximatelyZero()) {
+      return CachedEdge<Node>::zero();
+    }
+
+    constexpr std::size_t n = std::tuple_size_v<decltype(Node::e)>;
+    std::array<CachedEdge<Node>, n> edges{};
+    if (e.isTerminal() || e.p->v < level) {
+      // only matrix DDs skip levels, which represents the identity
+      for (std::size_t i = 0U; i < n; ++i) {
+        const auto j = (i & ~mask) | value;
+        edges[i] = (j == 0U || j == n - 1U)
+                       ? CachedEdge<Node>{e.p, ComplexValue{1.}}
+                       : CachedEdge<Node>::zero();
+      }
+      const auto r = makeDDNode(level, edges);
+      return {r.p, r.w * e.w};
+    }
+
+    if (e.p->v == level && removes) {
+      const auto& child = e.p->e[value];
+      return {child.p, static_cast<ComplexValue>(child.w) * e.w};
+    }
+
+    const auto key = std::pair<const Node*, std::uint32_t>{
+        e.p, (static_cast<std::uint32_t>(level) << 4U) |
+                 static_cast<std::uint32_t>((mask << 2U) | value)};
+    if (const auto it = relabeling.restricted.find(key);
+        it != relabeling.restricted.end()) {
+      return {it->second.p, it->second.w * e.w};
+    }
+
+    for (std::size_t i = 0U; i < n; ++i) {
+      if (e.p->v == level) {
+        const auto& child = e.p->e[(i & ~mask) | value];
+        edges[i] = {child.p, child.w};
       } else {
-        if (mappedNode.find(currentEdge->p) != mappedNode.end()) {
-          currentEdge = nullptr;
-          continue;
-        }
-        std::array<Edge<Node>, n> edges{};
-        for (std::size_t i = 0; i < n; i++) {
-          if (currentEdge->p->e[i].isTerminal()) {
-            edges[i].p = currentEdge->p->e[i].p;
-          } else {
-            edges[i].p = mappedNode[currentEdge->p->e[i].p];
-          }
-          edges[i].w = cn.lookup(currentEdge->p->e[i].w);
-        }
-        root = makeDDNode(currentEdge->p->v, edges);
-        mappedNode[currentEdge->p] = root.p;
-        currentEdge = nullptr;
+        const auto& child = e.p->e[i];
+        edges[i] = restrictLevel(CachedEdge<Node>{child.p, child.w}, level,
+                                 mask, value, removes, relabeling);
       }
-    } while (!stack.empty());
-    root.w = cn.lookup(original.w * root.w);
-    return root;
+    }
+    const auto r = makeDDNode(e.p->v, edges);
+    relabeling.restricted.emplace(key, r);
+    return {r.p, r.w * e.w};
   }
 
+public:
   ///
   /// Deserialization
   /// Note: do not rely on the binary format being portable across different
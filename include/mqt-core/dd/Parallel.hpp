@@ -0,0 +1,95 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dd {
+
+/// Determine the number of worker threads to use for a parallel computation
+/// \param requested the requested number of threads (0 for all available)
+/// \param tasks the number of independent tasks to be processed
+/// \return the number of worker threads to spawn (at least one)
+[[nodiscard]] inline std::size_t numWorkers(const std::size_t requested,
+                                            const std::size_t tasks) {
+  auto workers = requested;
+  if (workers == 0U) {
+    workers = std::max<std::size_t>(std::thread::hardware_concurrency(), 1U);
+  }
+  return std::max<std::size_t>(std::min(workers, tasks), 1U);
+}
+
+/// Determine how many levels of a DD have to be expanded to obtain enough
+/// independent subtrees to keep all workers busy
+/// \details About four subtrees per worker are targeted such that subtrees of
+/// varying cost can be balanced.
+/// \param workers the number of worker threads
+/// \param fanout the number of successors per node
+/// \return the number of levels to expand
+[[nodiscard]] inline std::size_t splitDepth(const std::size_t workers,
+                                            const std::size_t fanout = 2U) {
+  std::size_t depth = 0U;
+  for (std::size_t subtrees = 1U; subtrees < 4U * workers; subtrees *= fanout) {
+    ++depth;
+  }
+  return depth;
+}
+
+/// Process a set of independent tasks on a pool of worker threads
+/// \details Workers dynamically claim the next unprocessed task, so tasks of
+/// varying cost are balanced automatically. Each invocation receives the index
+/// of the task and the index of the worker processing it, which can be used to
+/// address per-thread resources such as private DD packages. If only a single
+/// worker is required, all tasks are processed on the calling thread. The first
+/// exception thrown by any task is rethrown on the calling thread once all
+/// workers have finished.
+/// \param tasks the number of tasks
+/// \param workers the number of worker threads (see `numWorkers`)
+/// \param task the callable `task(std::size_t task, std::size_t worker)`
+template <class Task>
+void parallelFor(const std::size_t tasks, const std::size_t workers,
+                 Task&& task) {
+  if (workers <= 1U || tasks <= 1U) {
+    for (std::size_t i = 0U; i < tasks; ++i) {
+      task(i, 0U);
+    }
+    return;
+  }
+
+  std::atomic<std::size_t> next{0U};
+  std::exception_ptr error{};
+  std::mutex errorMutex{};
+  const auto work = [&](const std::size_t worker) {
+    try {
+      for (auto i = next.fetch_add(1U); i < tasks; i = next.fetch_add(1U)) {
+        task(i, worker);
+      }
+    } catch (...) {
+      const std::lock_guard<std::mutex> lock(errorMutex);
+      if (!error) {
+        error = std::current_exception();
+      }
+      // prevent other workers from claiming further tasks
+      next = tasks;
+    }
+  };
+
+  std::vector<std::thread> threads{};
+  threads.reserve(workers - 1U);
+  for (std::size_t w = 1U; w < workers; ++w) {
+    threads.emplace_back(work, w);
+  }
+  work(0U);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+} // namespace dd
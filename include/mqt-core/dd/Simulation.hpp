@@ -3,11 +3,18 @@
 #include "dd/DDDefinitions.hpp"
 #include "dd/Operations.hpp"
 #include "dd/Package_fwd.hpp"
+#include "dd/statistics/Tracing.hpp"
+#include "ir/Permutation.hpp"
 #include "ir/QuantumComputation.hpp"
 
 #include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
 #include <map>
+#include <random>
 #include <string>
+#include <vector>
 
 namespace dd {
 using namespace qc;
@@ -21,12 +28,14 @@ VectorDD simulate(const QuantumComputation* qc, const VectorDD& in,
   dd.incRef(e);
 
   for (const auto& op : *qc) {
+    const auto probe = traceBegin(dd);
     auto tmp = dd.multiply(getDD(op.get(), dd, permutation), e);
     dd.incRef(tmp);
     dd.decRef(e);
     e = tmp;
+    traceEnd(dd, probe, op->getName(), e);
 
-    dd.garbageCollect();
+    traceGarbageCollect(dd);
   }
 
   // correct permutation if necessary
@@ -41,14 +50,293 @@ std::map<std::string, std::size_t>
 simulate(const QuantumComputation* qc, const VectorDD& in, Package<Config>& dd,
          std::size_t shots, std::size_t seed = 0U);
 
+/// Parameters of the hybrid DD/dense simulation
+struct HybridSimulationConfig {
+  /// switch to a dense vector once the DD has more nodes than this fraction of
+  /// the 2^n amplitudes
+  fp denseThreshold = 1. / 64.;
+  /// switch back to a DD once the recompressed state has at most this fraction
+  /// of 2^n nodes
+  fp sparseThreshold = 1. / 1024.;
+  /// number of operations between two checks of the representation
+  std::size_t checkInterval = 8U;
+  /// amplitudes with a smaller magnitude are dropped when recompressing
+  fp recompressThreshold = 0.;
+  /// threads used for converting between the representations (0 for all)
+  std::size_t nthreads = 1U;
+  /// after a failed recompression, the next attempt is delayed by twice as
+  /// many checks as the previous one, but by at most this many
+  std::size_t maxRecompressBackoff = 64U;
+};
+
+/**
+ * @brief Simulates a circuit, switching between a DD and a dense state vector.
+ * @details The size of the DD is monitored every `checkInterval` operations.
+ * Once it exceeds `denseThreshold * 2^n` nodes, the state is exported to a flat
+ * array and the operations are applied directly to the amplitudes. The dense
+ * state is periodically recompressed and the simulation returns to the DD as
+ * soon as it is compact again. A DD is only built from the amplitudes if the
+ * number of distinct amplitude pairs (a lower bound on its size) is small
+ * enough, and failed attempts are spaced out exponentially. Measurements are
+ * not supported here.
+ * @param qc the circuit
+ * @param in the initial state
+ * @param dd the package
+ * @param config the parameters of the switching
+ * @return the final state
+ */
+template <class Config>
+VectorDD simulateHybrid(const QuantumComputation* qc, const VectorDD& in,
+                        Package<Config>& dd,
+                        const HybridSimulationConfig& config = {});
+
+/**
+ * @brief Samples the outcomes of a circuit using the hybrid DD/dense
+ * simulation.
+ * @details Produces the same counts as `simulate`. Dynamic circuits are handed
+ * to `simulate`.
+ * @see simulateHybrid
+ */
+template <class Config>
+std::map<std::string, std::size_t>
+simulateHybrid(const QuantumComputation* qc, const VectorDD& in,
+               Package<Config>& dd, std::size_t shots, std::size_t seed = 0U,
+               const HybridSimulationConfig& config = {});
+
+/// Parameters of the approximate simulation
+struct ApproximationConfig {
+  /// approximate the state whenever its DD has more nodes than this
+  std::size_t nodeLimit = 1U << 20U;
+  /// the total loss of fidelity that may be spent on approximations
+  fp fidelityBudget = 0.1;
+  /// the initial contribution threshold of removed edges (halved whenever an
+  /// approximation would exceed the remaining budget)
+  fp threshold = 1e-4;
+  /// number of operations between two checks of the DD size
+  std::size_t checkInterval = 8U;
+};
+
+/**
+ * @brief Simulates a circuit while bounding the size of the state DD at the
+ * cost of accuracy.
+ * @details Whenever the DD exceeds `nodeLimit` nodes (checked every
+ * `checkInterval` operations), edges with a small contribution to the norm
+ * are removed (see Package::approximate). Since the fidelities of consecutive
+ * approximations multiply, each approximation is only applied if the
+ * accumulated fidelity stays above `1 - fidelityBudget`. If no threshold
+ * yields such an approximation, the simulation continues exactly until the
+ * next check.
+ * Measurements are not supported here.
+ * @param qc the circuit
+ * @param in the initial state
+ * @param dd the package
+ * @param fidelity the (lower bound on the) fidelity of the returned state with
+ * respect to the exact final state
+ * @param config the parameters of the approximation
+ * @return the final state
+ */
+template <class Config>
+VectorDD approximateSimulate(const QuantumComputation* qc, const VectorDD& in,
+                             Package<Config>& dd, fp& fidelity,
+                             const ApproximationConfig& config = {});
+
+/**
+ * @brief Simulates the repeated application of a circuit, e.g., a Trotter step
+ * of a time evolution.
+ * @details The unitary U of the step is built once and then applied to the
+ * state with a single multiplication per application. The state is only
+ * required every `stride` steps, where the observer is invoked. Hence, U^stride
+ * is obtained by repeated squaring (U^2, U^4, ...) and applied at once. A
+ * remainder of steps is applied using the same powers of U.
+ * @param step the circuit of a single step (must not contain non-unitary
+ * operations)
+ * @param in the initial state
+ * @param dd the package
+ * @param steps the number of steps
+ * @param observer invoked with the number of steps applied so far and the
+ * current state every `stride` steps and after the last step
+ * @param stride the number of steps between two observations
+ * @return the final state
+ */
+template <class Config>
+VectorDD simulateTimeEvolution(
+    const QuantumComputation* step, const VectorDD& in, Package<Config>& dd,
+    std::size_t steps,
+    const std::function<void(std::size_t, const VectorDD&)>& observer = {},
+    std::size_t stride = 1U);
+
+/**
+ * @brief Simulates a symbolic circuit for several assignments of its
+ * parameters.
+ * @details The operations before the first symbolic operation are identical
+ * for all assignments. They are simulated once and the resulting state is kept
+ * referenced while the remainder of the circuit is simulated for every
+ * assignment, starting from this state. Only the symbolic operations are
+ * instantiated; the circuit itself is not copied. With more than one thread,
+ * the assignments are distributed among threads, each using a private package
+ * to which the shared state is transferred.
+ * @param qc the symbolic circuit (measurements are not supported here)
+ * @param in the initial state
+ * @param dd the package
+ * @param assignments the parameter assignments (each has to assign all
+ * variables of the circuit)
+ * @param nthreads the number of threads to use (0 for all available)
+ * @return the final state for every assignment (each holding a reference)
+ */
+template <class Config>
+std::vector<VectorDD>
+simulateSweep(const QuantumComputation* qc, const VectorDD& in,
+              Package<Config>& dd,
+              const std::vector<VariableAssignment>& assignments,
+              std::size_t nthreads = 1U);
+
+/// Identifies the circuit a checkpoint has been taken for
+struct CircuitFingerprint {
+  std::uint64_t nqubits = 0U;
+  std::uint64_t nops = 0U;
+  /// a hash of the operations and the initial layout
+  std::uint64_t hash = 0U;
+
+  bool operator==(const CircuitFingerprint& other) const {
+    return nqubits == other.nqubits && nops == other.nops &&
+           hash == other.hash;
+  }
+  bool operator!=(const CircuitFingerprint& other) const {
+    return !(*this == other);
+  }
+};
+
+/// Compute the fingerprint of a circuit
+CircuitFingerprint fingerprintCircuit(const QuantumComputation& qc);
+
+/// A snapshot of an interrupted simulation
+struct SimulationCheckpoint {
+  /// the state after the first `position` operations
+  VectorDD state{};
+  /// the index of the next operation to apply
+  std::size_t position = 0U;
+  /// the current mapping of circuit qubits to DD qubits
+  qc::Permutation permutation{};
+  /// the generator used for sampling the final state
+  std::mt19937_64 mt{};
+  /// the circuit the snapshot has been taken for
+  CircuitFingerprint circuit{};
+};
+
+/**
+ * @brief Writes a checkpoint in a compact binary format.
+ * @details The DD is written in post-order with 32-bit node indices into a
+ * single buffer that is flushed at once. The generator is stored as the words
+ * of its textual representation (the only standard access to its state).
+ * Note: do not rely on the format being portable across different
+ * architectures/platforms.
+ */
+void writeCheckpoint(std::ostream& os, const SimulationCheckpoint& checkpoint);
+
+/**
+ * @brief Reads a checkpoint written by writeCheckpoint.
+ * @details The state is rebuilt in the given package. As for
+ * Package::deserialize, the returned state does not hold a reference.
+ */
+template <class Config>
+SimulationCheckpoint readCheckpoint(std::istream& is, Package<Config>& dd);
+
+/// Parameters of a checkpointed simulation
+struct CheckpointConfig {
+  /// the file the snapshots are written to (via a temporary file that replaces
+  /// it once complete); has to be given
+  std::string filename;
+  /// the minimal wall-clock time between two snapshots in seconds
+  fp interval = 600.;
+};
+
+/**
+ * @brief Samples the outcomes of a circuit while periodically writing
+ * snapshots of the simulation to disk.
+ * @details Once at least `interval` seconds have passed since the last
+ * snapshot, the current state, the index of the next operation, the
+ * permutation and the state of the random number generator are written to
+ * `filename`. A final snapshot is written before sampling. If the simulation
+ * is interrupted, resumeSimulation continues from the last snapshot and yields
+ * the same counts as an uninterrupted run. Only circuits without mid-circuit
+ * measurements are supported.
+ * @throws std::invalid_argument if the circuit is dynamic or no filename is
+ * given
+ * @see simulate
+ */
+template <class Config>
+std::map<std::string, std::size_t>
+simulateWithCheckpoints(const QuantumComputation* qc, const VectorDD& in,
+                        Package<Config>& dd, std::size_t shots,
+                        const CheckpointConfig& config, std::size_t seed = 0U);
+
+/**
+ * @brief Continues a simulation from the snapshot in `config.filename`.
+ * @details Further snapshots are written to the same file.
+ * @param qc the circuit the snapshot was taken for
+ * @param dd the package
+ * @param shots the number of shots
+ * @param config the checkpoint parameters
+ * @return the sampled counts
+ * @throws std::invalid_argument if the circuit is dynamic, no filename is
+ * given, or the snapshot cannot be read or has been taken for another circuit
+ * (see CircuitFingerprint)
+ */
+template <class Config>
+std::map<std::string, std::size_t>
+resumeSimulation(const QuantumComputation* qc, Package<Config>& dd,
+                 std::size_t shots, const CheckpointConfig& config);
+
+/// Statistics of the exploration of measurement outcomes
+struct ProbabilityExtractionStats {
+  /// branches whose outcomes were determined at a measurement
+  std::size_t explored = 0U;
+  /// branches whose outcomes were reused from an equivalent explored branch
+  std::size_t reused = 0U;
+};
+
+/**
+ * @brief Extracts the distribution of measurement outcomes of a (dynamic)
+ * circuit without sampling.
+ * @details Every measurement splits the simulation into its possible outcomes.
+ * Branches that reach the same state at the same position with the same
+ * classical bits relevant for the remaining circuit are only explored once.
+ * Branches whose accumulated probability falls below `pruneThreshold` are
+ * discarded. Since this makes the outcomes of a branch depend on how likely
+ * it is, a memoized branch is explored again if it is later reached with a
+ * higher probability. With more than one thread, independent branches are
+ * processed in parallel, each thread using a private package.
+ * @param qc the circuit (measurements and resets have to act on single qubits)
+ * @param in the initial state
+ * @param probVector the outcome probabilities indexed by the classical register
+ * @param dd the package
+ * @param pruneThreshold minimal probability of a branch to be explored
+ * @param nthreads the number of threads to use (0 for all available)
+ * @param stats if given, filled with the number of explored and reused
+ * branches
+ * @return the total probability of all discarded branches
+ */
 template <class Config>
-void extractProbabilityVector(const QuantumComputation* qc, const VectorDD& in,
-                              dd::SparsePVec& probVector, Package<Config>& dd);
+fp extractProbabilityVector(const QuantumComputation* qc, const VectorDD& in,
+                            dd::SparsePVec& probVector, Package<Config>& dd,
+                            fp pruneThreshold = 0., std::size_t nthreads = 1U,
+                            ProbabilityExtractionStats* stats = nullptr);
 
+/**
+ * @brief Adds the outcome distribution of the circuit from `currentIt` on,
+ * starting in `currentState` with the given measurement results, scaled by
+ * `commonFactor` to `probVector`.
+ * @details The reference of `currentState` is consumed.
+ * @deprecated Use extractProbabilityVector, which this forwards to (without
+ * pruning and on a single thread).
+ */
 template <class Config>
-void extractProbabilityVectorRecursive(
-    const QuantumComputation* qc, const VectorDD& currentState,
-    decltype(qc->begin()) currentIt, Permutation& permutation,
-    std::map<std::size_t, char> measurements, dd::fp commonFactor,
-    dd::SparsePVec& probVector, Package<Config>& dd);
+[[deprecated("Use extractProbabilityVector instead")]] void
+extractProbabilityVectorRecursive(const QuantumComputation* qc,
+                                  const VectorDD& currentState,
+                                  decltype(qc->begin()) currentIt,
+                                  Permutation& permutation,
+                                  std::map<std::size_t, char> measurements,
+                                  fp commonFactor, SparsePVec& probVector,
+                                  Package<Config>& dd);
 } // namespace dd
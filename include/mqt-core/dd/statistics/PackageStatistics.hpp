@@ -143,6 +143,8 @@ getStatistics(Package<Config>* package,
       package->matrixMatrixMultiplication.getStats().json();
   computeTables["density_density_mult"] =
       package->densityDensityMultiplication.getStats().json();
+  computeTables["density_operation_application"] =
+      package->densityOperationApplication.getStats().json();
   computeTables["vector_kronecker"] =
       package->vectorKronecker.getStats().json();
   computeTables["matrix_kronecker"] =
@@ -153,6 +155,12 @@ getStatistics(Package<Config>* package,
       package->stochasticNoiseOperationCache.getStats().json();
   computeTables["density_noise_operations"] =
       package->densityNoise.getStats().json();
+  computeTables["density_channel_operations"] =
+      package->densityChannel.getStats().json();
+
+  if (package->computeTableAdaptation.config.enabled) {
+    j["compute_table_adaptation"] = package->computeTableAdaptation.json();
+  }
 
   j["active_memory_mib"] = computeActiveMemoryMiB(package);
   j["peak_memory_mib"] = computePeakMemoryMiB(package);
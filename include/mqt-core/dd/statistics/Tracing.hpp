@@ -0,0 +1,188 @@
+#pragma once
+
+#include "dd/Package_fwd.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <nlohmann/json_fwd.hpp>
+#include <string>
+#include <vector>
+
+namespace dd {
+
+/// Whether the DD instrumentation has been compiled in (see the
+/// `MQT_CORE_DD_TRACING` CMake option). If not, all hooks are no-ops.
+#ifdef MQT_CORE_DD_TRACING
+inline constexpr bool TRACING_ENABLED = true;
+#else
+inline constexpr bool TRACING_ENABLED = false;
+#endif
+
+/// A single event recorded by the DD instrumentation
+struct TraceEvent {
+  /// The name of the event, e.g., the name of the applied operation
+  std::string name;
+  /// The category of the event (`operation` or `gc`)
+  std::string category;
+  /// The start of the event in nanoseconds relative to the trace origin
+  std::uint64_t start = 0U;
+  /// The wall time of the event in nanoseconds
+  std::uint64_t duration = 0U;
+  /// The size of the resulting DD (zero for garbage collections)
+  std::size_t nodes = 0U;
+  /// The number of compute table lookups performed during the event
+  std::size_t lookups = 0U;
+  /// The number of successful compute table lookups during the event
+  std::size_t hits = 0U;
+};
+
+/**
+ * @brief A fixed-capacity ring buffer of trace events.
+ * @details Once the buffer is full, the oldest events are overwritten, so
+ * that recording never allocates after construction. The buffer can be
+ * exported to the Chrome trace-event format, which can be inspected in
+ * `chrome://tracing` or https://ui.perfetto.dev.
+ */
+class TraceBuffer {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit TraceBuffer(std::size_t capacity = 1U << 16U);
+
+  /// Record an event, overwriting the oldest one if the buffer is full
+  void record(TraceEvent event);
+
+  /// Nanoseconds elapsed between the trace origin and the given time point
+  [[nodiscard]] std::uint64_t since(Clock::time_point time) const noexcept;
+
+  /// The recorded events, from oldest to newest
+  [[nodiscard]] std::vector<TraceEvent> events() const;
+
+  [[nodiscard]] std::size_t size() const noexcept { return count; }
+  [[nodiscard]] std::size_t capacity() const noexcept { return buffer.size(); }
+  /// The number of events that have been overwritten
+  [[nodiscard]] std::size_t dropped() const noexcept { return numDropped; }
+
+  /// Discard all events and restart the trace origin
+  void clear() noexcept;
+
+  /// Export the events as a Chrome trace-event JSON object
+  [[nodiscard]] nlohmann::json chromeTrace() const;
+
+  /// Write the Chrome trace-event JSON to a stream
+  void writeChromeTrace(std::ostream& os) const;
+
+private:
+  std::vector<TraceEvent> buffer;
+  std::size_t next = 0U;
+  std::size_t count = 0U;
+  std::size_t numDropped = 0U;
+  Clock::time_point origin = Clock::now();
+};
+
+/**
+ * @brief Makes a trace buffer the target of the instrumentation.
+ * @details For the lifetime of the session, all instrumented routines
+ * executed on the current thread record into the given buffer. Sessions may
+ * be nested; the previous target is restored on destruction.
+ */
+class TraceSession {
+public:
+  explicit TraceSession(TraceBuffer& buffer) noexcept;
+  ~TraceSession();
+  TraceSession(const TraceSession&) = delete;
+  TraceSession& operator=(const TraceSession&) = delete;
+  TraceSession(TraceSession&&) = delete;
+  TraceSession& operator=(TraceSession&&) = delete;
+
+  /// The buffer of the innermost session of the current thread (if any)
+  [[nodiscard]] static TraceBuffer* active() noexcept;
+
+private:
+  TraceBuffer* previous;
+};
+
+/// A snapshot of the package state taken before an instrumented step
+struct TraceProbe {
+  TraceBuffer::Clock::time_point start{};
+  std::size_t lookups = 0U;
+  std::size_t hits = 0U;
+};
+
+namespace detail {
+template <class Config>
+void computeTableCounters(const Package<Config>& dd, TraceProbe& probe) {
+  const auto add = [&probe](const auto& table) {
+    probe.lookups += table.getStats().lookups;
+    probe.hits += table.getStats().hits;
+  };
+  add(dd.vectorAdd);
+  add(dd.matrixAdd);
+  add(dd.matrixVectorMultiplication);
+  add(dd.matrixMatrixMultiplication);
+}
+} // namespace detail
+
+/// Start an instrumented step (a no-op if tracing is disabled or inactive)
+template <class Config>
+[[nodiscard]] TraceProbe
+traceBegin([[maybe_unused]] const Package<Config>& dd) {
+  TraceProbe probe{};
+  if constexpr (TRACING_ENABLED) {
+    if (TraceSession::active() != nullptr) {
+      detail::computeTableCounters(dd, probe);
+      probe.start = TraceBuffer::Clock::now();
+    }
+  }
+  return probe;
+}
+
+/**
+ * @brief Finish an instrumented step and record it in the active buffer.
+ * @param dd The package the step was performed in
+ * @param probe The probe returned by @ref traceBegin
+ * @param name The name of the step
+ * @param result The DD resulting from the step
+ */
+template <class Config, class Edge>
+void traceEnd([[maybe_unused]] const Package<Config>& dd,
+              [[maybe_unused]] const TraceProbe& probe,
+              [[maybe_unused]] const std::string& name,
+              [[maybe_unused]] const Edge& result) {
+  if constexpr (TRACING_ENABLED) {
+    auto* buffer = TraceSession::active();
+    if (buffer == nullptr) {
+      return;
+    }
+    const auto end = TraceBuffer::Clock::now();
+    TraceProbe after{};
+    detail::computeTableCounters(dd, after);
+    const auto start = buffer->since(probe.start);
+    buffer->record({name, "operation", start, buffer->since(end) - start,
+                    result.size(), after.lookups - probe.lookups,
+                    after.hits - probe.hits});
+  }
+}
+
+/// Run the garbage collection of the package and record it if it happened
+template <class Config> bool traceGarbageCollect(Package<Config>& dd) {
+  if constexpr (TRACING_ENABLED) {
+    auto* buffer = TraceSession::active();
+    if (buffer != nullptr) {
+      const auto begin = TraceBuffer::Clock::now();
+      const auto collected = dd.garbageCollect();
+      if (collected) {
+        const auto end = TraceBuffer::Clock::now();
+        const auto start = buffer->since(begin);
+        buffer->record(
+            {"garbage collection", "gc", start, buffer->since(end) - start});
+      }
+      return collected;
+    }
+  }
+  return dd.garbageCollect();
+}
+
+} // namespace dd
@@ -0,0 +1,176 @@
+#include "dd/ComputeTableAdaptation.hpp"
+
+#include "dd/statistics/TableStatistics.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <nlohmann/json.hpp>
+#include <utility>
+#include <vector>
+
+namespace dd {
+
+namespace {
+double ratio(const std::size_t numerator, const std::size_t denominator) {
+  if (denominator == 0U) {
+    return 0.;
+  }
+  return static_cast<double>(numerator) / static_cast<double>(denominator);
+}
+} // namespace
+
+nlohmann::basic_json<> ComputeTableResize::json() const {
+  nlohmann::json j{};
+  j["round"] = round;
+  j["table"] = table;
+  j["reason"] = reason;
+  j["from_buckets"] = fromBuckets;
+  j["to_buckets"] = toBuckets;
+  j["lookups"] = lookups;
+  j["hit_ratio"] = hitRatio;
+  j["col_ratio"] = colRatio;
+  return j;
+}
+
+bool ComputeTableAdaptation::tick() noexcept {
+  if (!config.enabled || config.interval == 0U) {
+    return false;
+  }
+  ++calls;
+  if (calls < config.interval) {
+    return false;
+  }
+  calls = 0U;
+  return true;
+}
+
+std::vector<std::size_t>
+ComputeTableAdaptation::adapt(const std::vector<ComputeTableUsage>& tables) {
+  ++rounds;
+  states.resize(tables.size());
+
+  struct Candidate {
+    std::size_t index;
+    std::size_t lookups;
+    std::size_t collisions;
+    double hitRatio;
+  };
+  std::vector<Candidate> growCandidates{};
+  std::vector<std::size_t> sizes(tables.size());
+  double memory = 0.;
+
+  for (std::size_t i = 0U; i < tables.size(); ++i) {
+    const auto& stats = *tables[i].stats;
+    auto& state = states[i];
+    state.name = tables[i].name;
+    sizes[i] = stats.numBuckets;
+
+    // the counters are cumulative, so the usage in this round is the
+    // difference to the previous snapshot
+    const auto lookups = stats.lookups - std::min(state.lookups, stats.lookups);
+    const auto hits = stats.hits - std::min(state.hits, stats.hits);
+    const auto collisions =
+        stats.collisions - std::min(state.collisions, stats.collisions);
+    state.lookups = stats.lookups;
+    state.hits = stats.hits;
+    state.collisions = stats.collisions;
+
+    // tables disabled in the package configuration are left alone
+    if (stats.numBuckets <= 1U) {
+      continue;
+    }
+
+    const auto buckets = stats.numBuckets;
+    const auto cold = static_cast<double>(lookups) <
+                      config.shrinkLookupsPerBucket *
+                          static_cast<double>(buckets);
+    if (cold && buckets / 2U >= config.minBuckets) {
+      sizes[i] = buckets / 2U;
+      ++state.shrinks;
+      decisions.push_back({rounds, state.name, "cold", buckets, sizes[i],
+                           lookups, ratio(hits, lookups),
+                           ratio(collisions, lookups)});
+    } else if (lookups >= config.minLookups &&
+               ratio(collisions, lookups) > config.growCollisionRatio &&
+               buckets * 2U <= config.maxBuckets) {
+      growCandidates.push_back({i, lookups, collisions, ratio(hits, lookups)});
+    }
+    memory +=
+        static_cast<double>(sizes[i]) * tables[i].stats->getEntrySizeMiB();
+  }
+
+  // grow the tables suffering from the most collisions first
+  std::stable_sort(growCandidates.begin(), growCandidates.end(),
+                   [](const Candidate& lhs, const Candidate& rhs) {
+                     return lhs.collisions > rhs.collisions;
+                   });
+  for (const auto& candidate : growCandidates) {
+    const auto i = candidate.index;
+    auto& state = states[i];
+    const auto buckets = sizes[i];
+    const auto additional =
+        static_cast<double>(buckets) * tables[i].stats->getEntrySizeMiB();
+    ComputeTableResize decision{rounds,
+                                state.name,
+                                "collisions",
+                                buckets,
+                                buckets * 2U,
+                                candidate.lookups,
+                                candidate.hitRatio,
+                                ratio(candidate.collisions, candidate.lookups)};
+    if (memory + additional <= config.memoryBudgetMiB) {
+      sizes[i] = buckets * 2U;
+      memory += additional;
+      ++state.grows;
+    } else {
+      decision.reason = "budget";
+      decision.toBuckets = buckets;
+    }
+    decisions.emplace_back(std::move(decision));
+  }
+
+  for (std::size_t i = 0U; i < tables.size(); ++i) {
+    states[i].numBuckets = sizes[i];
+    states[i].memoryMiB =
+        static_cast<double>(sizes[i]) * tables[i].stats->getEntrySizeMiB();
+  }
+  return sizes;
+}
+
+nlohmann::basic_json<> ComputeTableAdaptation::json() const {
+  nlohmann::json j{};
+  j["rounds"] = rounds;
+  j["memory_budget_MiB"] = config.memoryBudgetMiB;
+
+  double memory = 0.;
+  std::size_t grows = 0U;
+  std::size_t shrinks = 0U;
+  auto& tables = j["tables"];
+  tables = nlohmann::json::object();
+  for (const auto& state : states) {
+    if (state.numBuckets <= 1U) {
+      continue;
+    }
+    memory += state.memoryMiB;
+    grows += state.grows;
+    shrinks += state.shrinks;
+    tables[state.name] = {{"num_buckets", state.numBuckets},
+                          {"grows", state.grows},
+                          {"shrinks", state.shrinks}};
+  }
+  j["memory_MiB"] = memory;
+  j["grows"] = grows;
+  j["shrinks"] = shrinks;
+  j["denied_grows"] = static_cast<std::size_t>(
+      std::count_if(decisions.begin(), decisions.end(),
+                    [](const auto& d) { return d.reason == "budget"; }));
+
+  auto& log = j["decisions"];
+  log = nlohmann::json::array();
+  for (const auto& decision : decisions) {
+    log.emplace_back(decision.json());
+  }
+  return j;
+}
+
+} // namespace dd
@@ -6,6 +6,7 @@
 #include "dd/DDDefinitions.hpp"
 #include "dd/MemoryManager.hpp"
 #include "dd/Node.hpp"
+#include "dd/Parallel.hpp"
 #include "dd/RealNumber.hpp"
 
 #include <algorithm>
@@ -17,10 +18,12 @@
 #include <functional>
 #include <iomanip>
 #include <iostream>
+#include <limits>
 #include <optional>
 #include <string>
 #include <unordered_set>
 #include <utility>
+#include <vector>
 
 namespace dd {
 
@@ -183,22 +186,231 @@ std::complex<fp> Edge<Node>::getValueByIndex(const std::size_t i) const {
   return getValueByPath(bitwidth, decisions);
 }
 
+namespace {
+/// A requested amplitude given by its index and its position in the result
+using AmplitudeQuery = std::pair<std::size_t, std::size_t>;
+
+/// A subtree of a batch amplitude query that can be processed independently
+struct AmplitudeQueryTask {
+  const Edge<vNode>* edge;
+  std::complex<fp> amp;
+  std::size_t level;
+  AmplitudeQuery* begin;
+  AmplitudeQuery* end;
+};
+
+/**
+ * @brief Descend a vector DD once for a sorted range of amplitude queries
+ * @param e the current edge
+ * @param amp the accumulated amplitude including the weight of `e`
+ * @param level the number of index bits below the current position
+ * @param begin the first query in the range (all queries in the range agree on
+ * the index bits above `level`)
+ * @param end the end of the range of queries
+ * @param values the result vector
+ * @param tasks if not null, subtrees reached after `splitLevels` levels are
+ * deferred to this list instead of being processed
+ * @param splitLevels the number of levels to descend before deferring
+ */
+void collectValuesByIndices(const Edge<vNode>& e, const std::complex<fp>& amp,
+                            std::size_t level, AmplitudeQuery* begin,
+                            AmplitudeQuery* end, CVec& values,
+                            std::vector<AmplitudeQueryTask>* tasks,
+                            const std::size_t splitLevels) {
+  if (tasks != nullptr && splitLevels == 0U) {
+    tasks->push_back({&e, amp, level, begin, end});
+    return;
+  }
+
+  while (level > 0U) {
+    const auto bit = 1ULL << (level - 1U);
+    auto* mid = std::partition_point(begin, end, [bit](const auto& query) {
+      return (query.first & bit) == 0U;
+    });
+
+    // node is not at the expected level (skipped node)
+    if (e.isTerminal() || e.p->v != level - 1U) {
+      end = mid;
+      if (begin == end) {
+        return;
+      }
+      --level;
+      continue;
+    }
+
+    // node is at the expected level
+    const auto& e0 = e.p->e[0];
+    if (begin != mid && !e0.w.exactlyZero()) {
+      collectValuesByIndices(e0, amp * static_cast<std::complex<fp>>(e0.w),
+                             level - 1U, begin, mid, values, tasks,
+                             splitLevels - 1U);
+    }
+    const auto& e1 = e.p->e[1];
+    if (mid != end && !e1.w.exactlyZero()) {
+      collectValuesByIndices(e1, amp * static_cast<std::complex<fp>>(e1.w),
+                             level - 1U, mid, end, values, tasks,
+                             splitLevels - 1U);
+    }
+    return;
+  }
+
+  for (auto* query = begin; query != end; ++query) {
+    values[query->second] = amp;
+  }
+}
+
+/// A subvector that can be written independently
+struct VectorBlockTask {
+  const Edge<vNode>* edge;
+  std::complex<fp> amp;
+  std::size_t i;
+  std::size_t level;
+};
+
+/**
+ * @brief Write the subvector represented by an edge into a dense buffer
+ * @param e the current edge
+ * @param amp the accumulated amplitude including the weight of `e`
+ * @param i the index of the first entry of the subvector
+ * @param level the subvector has 2^level entries
+ * @param vec the buffer
+ * @param threshold amplitudes below this threshold are written as zero
+ * @param tasks if not null, subvectors reached after `splitLevels` levels are
+ * deferred to this list instead of being written
+ * @param splitLevels the number of levels to descend before deferring
+ */
+void writeVectorBlock(const Edge<vNode>& e, const std::complex<fp>& amp,
+                      const std::size_t i, const std::size_t level,
+                      std::complex<fp>* vec, const fp threshold,
+                      std::vector<VectorBlockTask>* tasks,
+                      const std::size_t splitLevels) {
+  const std::size_t size = 1ULL << level;
+  if (std::abs(amp) < threshold) {
+    std::fill_n(vec + i, size, std::complex<fp>{0.});
+    return;
+  }
+  if (level == 0U) {
+    vec[i] = amp;
+    return;
+  }
+  if (tasks != nullptr && splitLevels == 0U) {
+    tasks->push_back({&e, amp, i, level});
+    return;
+  }
+
+  const auto half = size / 2U;
+  // node is not at the expected level (skipped node)
+  if (e.isTerminal() || e.p->v < level - 1U) {
+    std::fill_n(vec + i + half, half, std::complex<fp>{0.});
+    writeVectorBlock(e, amp, i, level - 1U, vec, threshold, tasks,
+                     splitLevels - 1U);
+    return;
+  }
+
+  for (std::size_t k = 0U; k < RADIX; ++k) {
+    const auto& child = e.p->e[k];
+    if (child.w.exactlyZero()) {
+      std::fill_n(vec + i + (k * half), half, std::complex<fp>{0.});
+      continue;
+    }
+    writeVectorBlock(child, amp * static_cast<std::complex<fp>>(child.w),
+                     i + (k * half), level - 1U, vec, threshold, tasks,
+                     splitLevels - 1U);
+  }
+}
+} // namespace
+
+template <class Node>
+template <typename T, isVector<T>>
+CVec Edge<Node>::getValuesByIndices(const std::vector<std::size_t>& indices,
+                                    const std::size_t nthreads) const {
+  auto values = CVec(indices.size(), 0.);
+  if (w.exactlyZero()) {
+    return values;
+  }
+
+  std::vector<AmplitudeQuery> queries{};
+  queries.reserve(indices.size());
+  for (std::size_t k = 0U; k < indices.size(); ++k) {
+    queries.emplace_back(indices[k], k);
+  }
+  std::sort(queries.begin(), queries.end());
+
+  // indices beyond the size of the vector only refer to zero amplitudes
+  const std::size_t level = isTerminal() ? 0U : p->v + 1U;
+  auto* begin = queries.data();
+  auto* end = std::partition_point(
+      begin, begin + queries.size(), [level](const auto& query) {
+        // all indices fit into a vector of 64 or more qubits
+        return level >= std::numeric_limits<std::size_t>::digits ||
+               (query.first >> level) == 0U;
+      });
+
+  const auto amp = static_cast<std::complex<fp>>(w);
+  const auto workers = numWorkers(nthreads, queries.size());
+  if (workers <= 1U) {
+    collectValuesByIndices(*this, amp, level, begin, end, values, nullptr, 0U);
+    return values;
+  }
+
+  // split the DD into enough subtrees to keep all workers busy
+  std::vector<AmplitudeQueryTask> tasks{};
+  collectValuesByIndices(*this, amp, level, begin, end, values, &tasks,
+                         splitDepth(workers));
+  parallelFor(tasks.size(), workers,
+              [&tasks, &values](const std::size_t i, std::size_t /*worker*/) {
+                const auto& task = tasks[i];
+                collectValuesByIndices(*task.edge, task.amp, task.level,
+                                       task.begin, task.end, values, nullptr,
+                                       0U);
+              });
+  return values;
+}
+
 template <class Node>
 template <typename T, isVector<T>>
-CVec Edge<Node>::getVector(const fp threshold) const {
+CVec Edge<Node>::getVector(const fp threshold,
+                           const std::size_t nthreads) const {
   if (isTerminal()) {
     return {static_cast<std::complex<fp>>(w)};
   }
 
   const std::size_t dim = 2ULL << p->v;
-  auto vec = CVec(dim, 0.);
-  traverseVector(
-      1., 0,
-      [&vec](const std::size_t i, const std::complex<fp>& c) { vec.at(i) = c; },
-      threshold);
+  auto vec = CVec(dim);
+  writeVector(vec.data(), threshold, nthreads);
   return vec;
 }
 
+template <class Node>
+template <typename T, isVector<T>>
+void Edge<Node>::writeVector(std::complex<fp>* vec, const fp threshold,
+                             const std::size_t nthreads) const {
+  const std::size_t level = isTerminal() ? 0U : p->v + 1U;
+  const auto amp = static_cast<std::complex<fp>>(w);
+  if (w.exactlyZero()) {
+    std::fill_n(vec, 1ULL << level, std::complex<fp>{0.});
+    return;
+  }
+
+  const auto workers = numWorkers(nthreads, 1ULL << level);
+  if (workers <= 1U) {
+    writeVectorBlock(*this, amp, 0U, level, vec, threshold, nullptr, 0U);
+    return;
+  }
+
+  // split the DD into enough subvectors to keep all workers busy
+  std::vector<VectorBlockTask> tasks{};
+  writeVectorBlock(*this, amp, 0U, level, vec, threshold, &tasks,
+                   splitDepth(workers));
+  parallelFor(tasks.size(), workers,
+              [&tasks, vec, threshold](const std::size_t i,
+                                       std::size_t /*worker*/) {
+                const auto& task = tasks[i];
+                writeVectorBlock(*task.edge, task.amp, task.i, task.level, vec,
+                                 threshold, nullptr, 0U);
+              });
+}
+
 template <class Node>
 template <typename T, isVector<T>>
 SparseCVec Edge<Node>::getSparseVector(const fp threshold) const {
@@ -369,10 +581,219 @@ std::complex<fp> Edge<Node>::getValueByIndex(const std::size_t numQubits,
   return getValueByPath(numQubits, decisions);
 }
 
+namespace {
+/// A block of a matrix that can be processed independently
+template <class Node> struct MatrixBlockTask {
+  const Edge<Node>* edge;
+  std::complex<fp> amp;
+  std::size_t i;
+  std::size_t j;
+  std::size_t level;
+};
+
+/// Split level passed to `writeMatrixBlock` to write a block on the spot
+constexpr auto NO_SPLIT = std::numeric_limits<std::size_t>::max();
+
+/// Fill the square block of size 2^level starting at (i, j) with zeros
+template <class Rows>
+void fillZeroBlock(const Rows& rows, const std::size_t i, const std::size_t j,
+                   const std::size_t level) {
+  const std::size_t size = 1ULL << level;
+  for (std::size_t r = i; r < i + size; ++r) {
+    std::fill_n(rows(r) + j, size, std::complex<fp>{0.});
+  }
+}
+
+/**
+ * @brief Write the block of a matrix represented by an edge into dense rows
+ * @param e the current edge
+ * @param amp the accumulated amplitude including the weight of `e`
+ * @param i the row index of the block
+ * @param j the column index of the block
+ * @param level the block has 2^level rows and columns
+ * @param rows a callable returning a pointer to the given row
+ * @param threshold entries below this threshold are written as zero
+ * @param tasks blocks reached after `splitLevels` levels are deferred to this
+ * list instead of being written
+ * @param splitLevels the number of levels to descend before deferring or
+ * `NO_SPLIT` to write the whole block
+ */
+template <class Node, class Rows>
+void writeMatrixBlock(const Edge<Node>& e, const std::complex<fp>& amp,
+                      const std::size_t i, const std::size_t j,
+                      const std::size_t level, const Rows& rows,
+                      const fp threshold,
+                      std::vector<MatrixBlockTask<Node>>& tasks,
+                      const std::size_t splitLevels) {
+  if (std::abs(amp) < threshold) {
+    fillZeroBlock(rows, i, j, level);
+    return;
+  }
+  if (level == 0U) {
+    rows(i)[j] = amp;
+    return;
+  }
+  if (splitLevels == 0U) {
+    tasks.push_back(MatrixBlockTask<Node>{&e, amp, i, j, level});
+    return;
+  }
+
+  const auto nextSplit = splitLevels == NO_SPLIT ? NO_SPLIT : splitLevels - 1U;
+  const auto nextLevel = level - 1U;
+  const std::size_t x = i | (1ULL << nextLevel);
+  const std::size_t y = j | (1ULL << nextLevel);
+  // node is not at the expected level (identity)
+  if (e.isTerminal() || e.p->v < nextLevel) {
+    fillZeroBlock(rows, i, y, nextLevel);
+    fillZeroBlock(rows, x, j, nextLevel);
+    writeMatrixBlock(e, amp, i, j, nextLevel, rows, threshold, tasks,
+                     nextSplit);
+    writeMatrixBlock(e, amp, x, y, nextLevel, rows, threshold, tasks,
+                     nextSplit);
+    return;
+  }
+
+  const auto coords = {std::pair{i, j}, {i, y}, {x, j}, {x, y}};
+  std::size_t k = 0U;
+  for (const auto& [a, b] : coords) {
+    auto& child = e.p->e[k++];
+    if (child.w.exactlyZero()) {
+      fillZeroBlock(rows, a, b, nextLevel);
+      continue;
+    }
+    if constexpr (std::is_same_v<Node, dNode>) {
+      Edge<dNode>::applyDmChangesToEdge(child);
+    }
+    writeMatrixBlock(child, amp * static_cast<std::complex<fp>>(child.w), a,
+                     b, nextLevel, rows, threshold, tasks, nextSplit);
+    if constexpr (std::is_same_v<Node, dNode>) {
+      Edge<dNode>::revertDmChangesToEdge(child);
+    }
+  }
+}
+
+/**
+ * @brief Write a matrix DD into dense rows
+ * @details Density matrix DDs temporarily modify their nodes during the
+ * traversal and are, hence, always written on the calling thread.
+ */
+template <class Node, class Rows>
+void writeMatrixRows(const Edge<Node>& e, const std::size_t numQubits,
+                     const Rows& rows, const fp threshold,
+                     const std::size_t nthreads) {
+  const auto amp = static_cast<std::complex<fp>>(e.w);
+  if (e.w.exactlyZero()) {
+    fillZeroBlock(rows, 0U, 0U, numQubits);
+    return;
+  }
+
+  auto workers = numWorkers(nthreads, 1ULL << numQubits);
+  if constexpr (std::is_same_v<Node, dNode>) {
+    workers = 1U;
+  }
+  std::vector<MatrixBlockTask<Node>> tasks{};
+  if (workers <= 1U) {
+    writeMatrixBlock<Node>(e, amp, 0U, 0U, numQubits, rows, threshold, tasks,
+                           NO_SPLIT);
+    return;
+  }
+
+  // split the DD into enough blocks to keep all workers busy
+  const auto depth = std::min(splitDepth(workers), numQubits);
+  tasks.reserve(1ULL << (2U * depth));
+  writeMatrixBlock(e, amp, 0U, 0U, numQubits, rows, threshold, tasks, depth);
+  parallelFor(tasks.size(), workers,
+              [&tasks, &rows, threshold](const std::size_t t,
+                                         std::size_t /*worker*/) {
+                const auto& task = tasks[t];
+                std::vector<MatrixBlockTask<Node>> unused{};
+                writeMatrixBlock<Node>(*task.edge, task.amp, task.i, task.j,
+                                       task.level, rows, threshold, unused,
+                                       NO_SPLIT);
+              });
+}
+
+/// A non-zero entry of a sparse matrix
+struct MatrixEntry {
+  std::size_t row;
+  std::size_t col;
+  std::complex<fp> value;
+};
+
+/**
+ * @brief Collect the non-zero entries of a band of rows of a matrix DD
+ * @details On the levels at or above `bandLevel`, only the edges leading to
+ * the rows of the band are followed.
+ * @param e the current edge
+ * @param amp the accumulated amplitude including the weight of `e`
+ * @param i the row index of the block
+ * @param j the column index of the block
+ * @param level the block has 2^level rows and columns
+ * @param firstRow the first row of the band
+ * @param bandLevel the band contains 2^bandLevel rows
+ * @param entries the list of collected entries
+ * @param threshold entries below this threshold are ignored
+ */
+template <class Node>
+void collectMatrixEntries(const Edge<Node>& e, const std::complex<fp>& amp,
+                          const std::size_t i, const std::size_t j,
+                          const std::size_t level, const std::size_t firstRow,
+                          const std::size_t bandLevel,
+                          std::vector<MatrixEntry>& entries,
+                          const fp threshold) {
+  if (std::abs(amp) < threshold) {
+    return;
+  }
+  if (level == 0U) {
+    entries.push_back({i, j, amp});
+    return;
+  }
+
+  const auto nextLevel = level - 1U;
+  const std::size_t x = i | (1ULL << nextLevel);
+  const std::size_t y = j | (1ULL << nextLevel);
+  // whether the upper and lower half of the rows are part of the band
+  const auto inBand = [&](const std::size_t row) {
+    return nextLevel < bandLevel || ((row ^ firstRow) >> nextLevel) == 0U;
+  };
+
+  // node is not at the expected level (identity)
+  if (e.isTerminal() || e.p->v < nextLevel) {
+    if (inBand(i)) {
+      collectMatrixEntries(e, amp, i, j, nextLevel, firstRow, bandLevel,
+                           entries, threshold);
+    }
+    if (inBand(x)) {
+      collectMatrixEntries(e, amp, x, y, nextLevel, firstRow, bandLevel,
+                           entries, threshold);
+    }
+    return;
+  }
+
+  const auto coords = {std::pair{i, j}, {i, y}, {x, j}, {x, y}};
+  std::size_t k = 0U;
+  for (const auto& [a, b] : coords) {
+    auto& child = e.p->e[k++];
+    if (child.w.exactlyZero() || !inBand(a)) {
+      continue;
+    }
+    if constexpr (std::is_same_v<Node, dNode>) {
+      Edge<dNode>::applyDmChangesToEdge(child);
+    }
+    collectMatrixEntries(child, amp * static_cast<std::complex<fp>>(child.w),
+                         a, b, nextLevel, firstRow, bandLevel, entries,
+                         threshold);
+    if constexpr (std::is_same_v<Node, dNode>) {
+      Edge<dNode>::revertDmChangesToEdge(child);
+    }
+  }
+}
+} // namespace
+
 template <class Node>
 template <typename T, isMatrixVariant<T>>
-CMat Edge<Node>::getMatrix(const std::size_t numQubits,
-                           const fp threshold) const {
+CMat Edge<Node>::getMatrix(const std::size_t numQubits, const fp threshold,
+                           const std::size_t nthreads) const {
   if (numQubits == 0U) {
     return CMat{1, {static_cast<std::complex<fp>>(w)}};
   }
@@ -382,18 +803,35 @@ CMat Edge<Node>::getMatrix(const std::size_t numQubits,
     Edge<dNode>::applyDmChangesToEdge(r);
   }
   const std::size_t dim = 1ULL << numQubits;
-  auto mat = CMat(dim, CVec(dim, 0.));
-  r.traverseMatrix(
-      1, 0ULL, 0ULL,
-      [&mat](const std::size_t i, const std::size_t j,
-             const std::complex<fp>& c) { mat.at(i).at(j) = c; },
-      numQubits, threshold);
+  auto mat = CMat(dim, CVec(dim));
+  writeMatrixRows(
+      r, numQubits, [&mat](const std::size_t i) { return mat[i].data(); },
+      threshold, nthreads);
   if constexpr (std::is_same_v<Node, dNode>) {
     Edge<dNode>::revertDmChangesToEdge(r);
   }
   return mat;
 }
 
+template <class Node>
+template <typename T, isMatrixVariant<T>>
+void Edge<Node>::writeMatrix(const std::size_t numQubits,
+                             std::complex<fp>* mat, const fp threshold,
+                             const std::size_t nthreads) const {
+  auto r = *this;
+  if constexpr (std::is_same_v<Node, dNode>) {
+    Edge<dNode>::applyDmChangesToEdge(r);
+  }
+  const std::size_t dim = 1ULL << numQubits;
+  writeMatrixRows(
+      r, numQubits,
+      [mat, dim](const std::size_t i) { return mat + (i * dim); }, threshold,
+      nthreads);
+  if constexpr (std::is_same_v<Node, dNode>) {
+    Edge<dNode>::revertDmChangesToEdge(r);
+  }
+}
+
 template <class Node>
 template <typename T, isMatrixVariant<T>>
 SparseCMat Edge<Node>::getSparseMatrix(const std::size_t numQubits,
@@ -421,6 +859,69 @@ SparseCMat Edge<Node>::getSparseMatrix(const std::size_t numQubits,
   return mat;
 }
 
+template <class Node>
+template <typename T, isMatrixVariant<T>>
+CSRMat Edge<Node>::getSparseMatrixCSR(const std::size_t numQubits,
+                                      const fp threshold,
+                                      const std::size_t nthreads) const {
+  const std::size_t dim = 1ULL << numQubits;
+  auto mat = CSRMat{dim, std::vector<std::size_t>(dim + 1U, 0U), {}, {}};
+  if (w.exactlyZero()) {
+    return mat;
+  }
+
+  auto r = *this;
+  if constexpr (std::is_same_v<Node, dNode>) {
+    Edge<dNode>::applyDmChangesToEdge(r);
+  }
+
+  // split the rows into bands that are collected independently
+  auto workers = numWorkers(nthreads, dim);
+  if constexpr (std::is_same_v<Node, dNode>) {
+    workers = 1U;
+  }
+  const auto bandLevel =
+      workers <= 1U ? numQubits
+                    : numQubits - std::min(numQubits, splitDepth(workers));
+  const std::size_t bands = 1ULL << (numQubits - bandLevel);
+  std::vector<std::vector<MatrixEntry>> entries(bands);
+  const auto amp = static_cast<std::complex<fp>>(r.w);
+  parallelFor(bands, workers,
+              [&](const std::size_t band, std::size_t /*worker*/) {
+                auto& bandEntries = entries[band];
+                collectMatrixEntries(r, amp, 0U, 0U, numQubits,
+                                     band << bandLevel, bandLevel, bandEntries,
+                                     threshold);
+                std::sort(bandEntries.begin(), bandEntries.end(),
+                          [](const auto& lhs, const auto& rhs) {
+                            return lhs.row < rhs.row ||
+                                   (lhs.row == rhs.row && lhs.col < rhs.col);
+                          });
+              });
+
+  if constexpr (std::is_same_v<Node, dNode>) {
+    Edge<dNode>::revertDmChangesToEdge(r);
+  }
+
+  std::size_t nnz = 0U;
+  for (const auto& bandEntries : entries) {
+    nnz += bandEntries.size();
+  }
+  mat.colIdx.reserve(nnz);
+  mat.values.reserve(nnz);
+  for (const auto& bandEntries : entries) {
+    for (const auto& entry : bandEntries) {
+      ++mat.rowPtr[entry.row + 1U];
+      mat.colIdx.emplace_back(entry.col);
+      mat.values.emplace_back(entry.value);
+    }
+  }
+  for (std::size_t i = 0U; i < dim; ++i) {
+    mat.rowPtr[i + 1U] += mat.rowPtr[i];
+  }
+  return mat;
+}
+
 template <class Node>
 template <typename T, isMatrixVariant<T>>
 void Edge<Node>::printMatrix(const std::size_t numQubits) const {
@@ -475,8 +976,9 @@ void Edge<Node>::traverseMatrix(const std::complex<fp>& amp,
   const std::size_t x = i | (1ULL << nextLevel);
   const std::size_t y = j | (1ULL << nextLevel);
   if (isTerminal() || p->v < nextLevel) {
-    traverseMatrix(c, i, j, f, nextLevel, threshold);
-    traverseMatrix(c, x, y, f, nextLevel, threshold);
+    // the weight is applied again once the edge reaches its node's level
+    traverseMatrix(amp, i, j, f, nextLevel, threshold);
+    traverseMatrix(amp, x, y, f, nextLevel, threshold);
     return;
   }
 
@@ -590,7 +1092,14 @@ template Edge<vNode> Edge<vNode>::normalize<vNode, true>(
     ComplexNumbers& cn);
 template std::complex<fp>
 Edge<vNode>::getValueByIndex<vNode, true>(const std::size_t i) const;
-template CVec Edge<vNode>::getVector<vNode, true>(const fp threshold) const;
+template CVec Edge<vNode>::getValuesByIndices<vNode, true>(
+    const std::vector<std::size_t>& indices, const std::size_t nthreads) const;
+template CVec
+Edge<vNode>::getVector<vNode, true>(const fp threshold,
+                                   const std::size_t nthreads) const;
+template void
+Edge<vNode>::writeVector<vNode, true>(std::complex<fp>* vec, const fp threshold,
+                                      const std::size_t nthreads) const;
 template SparseCVec
 Edge<vNode>::getSparseVector<vNode, true>(const fp threshold) const;
 template void Edge<vNode>::printVector<vNode, true>() const;
@@ -608,7 +1117,15 @@ Edge<mNode>::getValueByIndex<mNode, true>(const std::size_t numQubits,
                                           const std::size_t i,
                                           const std::size_t j) const;
 template CMat Edge<mNode>::getMatrix<mNode, true>(const std::size_t numQubits,
-                                                  const fp threshold) const;
+                                                  const fp threshold,
+                                                  const std::size_t nthreads)
+    const;
+template void Edge<mNode>::writeMatrix<mNode, true>(
+    const std::size_t numQubits, std::complex<fp>* mat, const fp threshold,
+    const std::size_t nthreads) const;
+template CSRMat Edge<mNode>::getSparseMatrixCSR<mNode, true>(
+    const std::size_t numQubits, const fp threshold,
+    const std::size_t nthreads) const;
 template SparseCMat
 Edge<mNode>::getSparseMatrix<mNode, true>(const std::size_t numQubits,
                                           const fp threshold) const;
@@ -622,7 +1139,15 @@ template Edge<dNode> Edge<dNode>::normalize<dNode, true>(
     dNode* p, const std::array<Edge<dNode>, NEDGE>& e, MemoryManager<dNode>& mm,
     ComplexNumbers& cn);
 template CMat Edge<dNode>::getMatrix<dNode, true>(const std::size_t numQubits,
-                                                  const fp threshold) const;
+                                                  const fp threshold,
+                                                  const std::size_t nthreads)
+    const;
+template void Edge<dNode>::writeMatrix<dNode, true>(
+    const std::size_t numQubits, std::complex<fp>* mat, const fp threshold,
+    const std::size_t nthreads) const;
+template CSRMat Edge<dNode>::getSparseMatrixCSR<dNode, true>(
+    const std::size_t numQubits, const fp threshold,
+    const std::size_t nthreads) const;
 template SparseCMat
 Edge<dNode>::getSparseMatrix<dNode, true>(const std::size_t numQubits,
                                           const fp threshold) const;
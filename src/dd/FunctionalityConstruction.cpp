@@ -1,11 +1,23 @@
 #include "dd/FunctionalityConstruction.hpp"
 
 #include "dd/Package.hpp"
+#include "dd/Parallel.hpp"
+#include "dd/statistics/Tracing.hpp"
+#include "ir/Permutation.hpp"
 #include "ir/QuantumComputation.hpp"
+#include "ir/operations/ClassicControlledOperation.hpp"
+#include "ir/operations/CompoundOperation.hpp"
+#include "ir/operations/OpType.hpp"
+#include "ir/operations/Operation.hpp"
 
+#include <algorithm>
 #include <cmath>
 #include <cstddef>
+#include <memory>
 #include <stack>
+#include <stdexcept>
+#include <utility>
+#include <vector>
 
 namespace dd {
 template <class Config>
@@ -19,13 +31,15 @@ MatrixDD buildFunctionality(const QuantumComputation* qc, Package<Config>& dd) {
   auto e = dd.createInitialMatrix(qc->ancillary);
 
   for (const auto& op : *qc) {
+    const auto probe = traceBegin(dd);
     auto tmp = dd.multiply(getDD(op.get(), dd, permutation), e);
 
     dd.incRef(tmp);
     dd.decRef(e);
     e = tmp;
+    traceEnd(dd, probe, op->getName(), e);
 
-    dd.garbageCollect();
+    traceGarbageCollect(dd);
   }
   // correct permutation if necessary
   changePermutation(e, permutation, qc->outputPermutation, dd);
@@ -115,6 +129,251 @@ bool buildFunctionalityRecursive(const QuantumComputation* qc,
   return success;
 }
 
+namespace {
+/// Applies the relabeling `getDD` performs for SWAP operations
+void updatePermutation(const Operation* op, Permutation& permutation) {
+  if (permutation.empty()) {
+    return;
+  }
+  if (op->getType() == qc::SWAP && !op->isControlled()) {
+    const auto& targets = op->getTargets();
+    std::swap(permutation.at(targets[0U]), permutation.at(targets[1U]));
+    return;
+  }
+  if (const auto* compoundOp = dynamic_cast<const CompoundOperation*>(op)) {
+    for (const auto& operation : *compoundOp) {
+      updatePermutation(operation.get(), permutation);
+    }
+    return;
+  }
+  if (const auto* classicOp =
+          dynamic_cast<const ClassicControlledOperation*>(op)) {
+    updatePermutation(classicOp->getOperation(), permutation);
+  }
+}
+
+/// Multiplies the operations in [begin, end) in a balanced binary tree (the
+/// result holds a reference)
+template <class Config>
+MatrixDD buildRange(const QuantumComputation* qc, const std::size_t begin,
+                    const std::size_t end, Permutation& permutation,
+                    Package<Config>& dd) {
+  // partial products and the number of operations they cover; neighbours of
+  // equal size are merged immediately
+  std::vector<std::pair<MatrixDD, std::size_t>> partial{};
+  const auto merge = [&partial, &dd]() {
+    const auto [later, count] = partial.back();
+    partial.pop_back();
+    auto& [earlier, total] = partial.back();
+    auto product = dd.multiply(later, earlier);
+    dd.incRef(product);
+    dd.decRef(later);
+    dd.decRef(earlier);
+    earlier = product;
+    total += count;
+    dd.garbageCollect();
+  };
+
+  for (auto i = begin; i < end; ++i) {
+    auto e = getDD(qc->at(i).get(), dd, permutation);
+    dd.incRef(e);
+    partial.emplace_back(e, 1U);
+    while (partial.size() > 1U &&
+           partial.back().second == partial[partial.size() - 2U].second) {
+      merge();
+    }
+  }
+  while (partial.size() > 1U) {
+    merge();
+  }
+  return partial.front().first;
+}
+} // namespace
+
+template <class Config>
+MatrixDD buildFunctionalityParallel(const QuantumComputation* qc,
+                                    Package<Config>& dd,
+                                    const std::size_t nthreads) {
+  if (qc->getNqubits() == 0U) {
+    return MatrixDD::one();
+  }
+  const auto workers = numWorkers(nthreads, qc->size());
+  if (workers == 1U) {
+    return buildFunctionalityRecursive(qc, dd);
+  }
+
+  // a power of two of leaves such that every level pairs up all products
+  std::size_t leaves = 1U;
+  while (leaves < workers && 2U * leaves <= qc->size()) {
+    leaves *= 2U;
+  }
+  std::vector<std::size_t> bounds(leaves + 1U);
+  for (std::size_t leaf = 0U; leaf <= leaves; ++leaf) {
+    bounds[leaf] = leaf * qc->size() / leaves;
+  }
+
+  // the operations of a leaf are applied according to the permutation
+  // resulting from all SWAPs before it
+  auto permutation = qc->initialLayout;
+  std::vector<Permutation> permutations(leaves);
+  for (std::size_t leaf = 0U; leaf < leaves; ++leaf) {
+    permutations[leaf] = permutation;
+    for (auto i = bounds[leaf]; i < bounds[leaf + 1U]; ++i) {
+      updatePermutation(qc->at(i).get(), permutation);
+    }
+  }
+
+  std::vector<std::unique_ptr<Package<Config>>> packages(leaves);
+  std::vector<MatrixDD> products(leaves);
+  parallelFor(leaves, workers, [&](const std::size_t leaf, std::size_t) {
+    packages[leaf] = std::make_unique<Package<Config>>(dd.qubits());
+    products[leaf] = buildRange(qc, bounds[leaf], bounds[leaf + 1U],
+                                permutations[leaf], *packages[leaf]);
+  });
+
+  // at every level, the product of the subtrees starting at `left` and
+  // `right` is formed in the package of `left`. The package of `right` is not
+  // used by any other task of the level and released afterwards.
+  for (std::size_t stride = 1U; stride < leaves; stride *= 2U) {
+    const auto pairs = leaves / (2U * stride);
+    parallelFor(
+        pairs, numWorkers(nthreads, pairs),
+        [&](const std::size_t pair, std::size_t) {
+          const auto left = 2U * stride * pair;
+          const auto right = left + stride;
+          auto& package = *packages[left];
+          auto later = package.transfer(products[right]);
+          package.incRef(later);
+          packages[right].reset();
+
+          auto product = package.multiply(later, products[left]);
+          package.incRef(product);
+          package.decRef(later);
+          package.decRef(products[left]);
+          products[left] = product;
+          package.garbageCollect();
+        });
+  }
+
+  auto e = dd.transfer(products.front());
+  dd.incRef(e);
+  packages.front().reset();
+
+  // correct permutation if necessary
+  changePermutation(e, permutation, qc->outputPermutation, dd);
+  e = dd.reduceAncillae(e, qc->ancillary);
+  e = dd.reduceGarbage(e, qc->garbage);
+
+  return e;
+}
+
+template <class Config>
+EquivalenceCheckingResult
+checkEquivalence(const QuantumComputation* qc1, const QuantumComputation* qc2,
+                 Package<Config>& dd, const EquivalenceCheckingConfig& config) {
+  if (qc1->getNqubits() != qc2->getNqubits()) {
+    throw std::invalid_argument(
+        "Only circuits on the same number of qubits can be checked.");
+  }
+  EquivalenceCheckingResult result{};
+  if (qc1->getNqubits() == 0U) {
+    result.equivalent = true;
+    return result;
+  }
+
+  auto left = qc1->initialLayout;
+  auto right = qc2->initialLayout;
+  auto e = dd.createInitialMatrix(qc1->ancillary);
+  result.peakNodes = e.size();
+
+  // G·E for the next operation of the first circuit and E·G'† for the next
+  // one of the second circuit
+  std::size_t i = 0U;
+  std::size_t j = 0U;
+  const auto leftProduct = [&](Permutation& permutation) {
+    return dd.multiply(getDD(qc1->at(i).get(), dd, permutation), e);
+  };
+  const auto rightProduct = [&](Permutation& permutation) {
+    return dd.multiply(e, getInverseDD(qc2->at(j).get(), dd, permutation));
+  };
+  const auto update = [&](const MatrixDD& tmp, const std::size_t size) {
+    dd.incRef(tmp);
+    dd.decRef(e);
+    e = tmp;
+    result.peakNodes = std::max(result.peakNodes, size);
+    dd.garbageCollect();
+  };
+
+  const auto m = qc1->size();
+  const auto n = qc2->size();
+  while (i < m || j < n) {
+    if (i == m || j == n ||
+        config.strategy != EquivalenceCheckingStrategy::Lookahead) {
+      bool applyLeft = false;
+      switch (config.strategy) {
+      case EquivalenceCheckingStrategy::Naive:
+        applyLeft = i < m;
+        break;
+      case EquivalenceCheckingStrategy::OneToOne:
+        applyLeft = j == n || (i < m && i <= j);
+        break;
+      default:
+        // keep the fractions i/m and j/n of applied operations balanced
+        applyLeft = j == n || (i < m && i * n <= j * m);
+        break;
+      }
+      if (applyLeft) {
+        const auto tmp = leftProduct(left);
+        ++i;
+        update(tmp, tmp.size());
+      } else {
+        const auto tmp = rightProduct(right);
+        ++j;
+        update(tmp, tmp.size());
+      }
+      continue;
+    }
+
+    // compute both candidates and keep the smaller one
+    auto leftPermutation = left;
+    auto rightPermutation = right;
+    const auto fromLeft = leftProduct(leftPermutation);
+    const auto fromRight = rightProduct(rightPermutation);
+    const auto leftSize = fromLeft.size();
+    const auto rightSize = fromRight.size();
+    result.peakNodes =
+        std::max(result.peakNodes, std::max(leftSize, rightSize));
+    if (leftSize <= rightSize) {
+      left = leftPermutation;
+      ++i;
+      update(fromLeft, leftSize);
+    } else {
+      right = rightPermutation;
+      ++j;
+      update(fromRight, rightSize);
+    }
+  }
+
+  // correct permutations and reduce ancillary and garbage qubits on both
+  // sides of the miter
+  changePermutation(e, left, qc1->outputPermutation, dd);
+  changePermutation(e, right, qc2->outputPermutation, dd, false);
+  e = dd.reduceAncillae(e, qc1->ancillary);
+  e = dd.reduceAncillae(e, qc2->ancillary, false);
+  e = dd.reduceGarbage(e, qc1->garbage);
+  e = dd.reduceGarbage(e, qc2->garbage, false);
+
+  auto garbage = qc1->garbage;
+  garbage.resize(std::max(garbage.size(), qc2->garbage.size()));
+  for (std::size_t q = 0U; q < qc2->garbage.size(); ++q) {
+    garbage[q] = garbage[q] || qc2->garbage[q];
+  }
+  result.equivalent = dd.isCloseToIdentity(e, config.tolerance, garbage);
+  dd.decRef(e);
+  dd.garbageCollect();
+  return result;
+}
+
 template MatrixDD buildFunctionality(const qc::QuantumComputation* qc,
                                      Package<DDPackageConfig>& dd);
 template MatrixDD
@@ -132,4 +391,12 @@ template bool buildFunctionalityRecursive(const qc::QuantumComputation* qc,
                                           std::stack<MatrixDD>& s,
                                           qc::Permutation& permutation,
                                           Package<DDPackageConfig>& dd);
+template MatrixDD buildFunctionalityParallel(const qc::QuantumComputation* qc,
+                                             Package<DDPackageConfig>& dd,
+                                             std::size_t nthreads);
+template EquivalenceCheckingResult
+checkEquivalence(const qc::QuantumComputation* qc1,
+                 const qc::QuantumComputation* qc2,
+                 Package<DDPackageConfig>& dd,
+                 const EquivalenceCheckingConfig& config);
 } // namespace dd
@@ -0,0 +1,228 @@
+#include "dd/NodeProbabilityCache.hpp"
+
+#include "dd/ComplexNumbers.hpp"
+#include "dd/DDDefinitions.hpp"
+#include "dd/Edge.hpp"
+#include "dd/Node.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace dd {
+
+namespace {
+/// The squared magnitude of an edge weight (zero for negligible weights)
+fp edgeProbability(const vEdge& e) {
+  if (e.w.approximatelyZero()) {
+    return 0.;
+  }
+  return ComplexNumbers::mag2(e.w);
+}
+} // namespace
+
+std::size_t NodeProbabilityCache::hash(const vNode* node) const noexcept {
+  // Fibonacci hashing of the node address
+  constexpr std::uintptr_t multiplier = 0x9e3779b97f4a7c15ULL;
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  const auto key = reinterpret_cast<std::uintptr_t>(node);
+  return (key * multiplier) >> shift;
+}
+
+const NodeProbabilityCache::Entry*
+NodeProbabilityCache::find(const vNode* node) const noexcept {
+  if (table.empty()) {
+    return nullptr;
+  }
+  const auto mask = table.size() - 1U;
+  for (auto i = hash(node);; i = (i + 1U) & mask) {
+    const auto& entry = table[i];
+    if (entry.epoch != epoch) {
+      return nullptr;
+    }
+    if (entry.node == node) {
+      return &entry;
+    }
+  }
+}
+
+NodeProbabilityCache::Entry&
+NodeProbabilityCache::at(const vNode* node) noexcept {
+  const auto mask = table.size() - 1U;
+  auto i = hash(node);
+  while (table[i].epoch != epoch || table[i].node != node) {
+    i = (i + 1U) & mask;
+  }
+  return table[i];
+}
+
+bool NodeProbabilityCache::insert(const vNode* node) {
+  // keep the load factor below one half
+  if (2U * (entries + 1U) > table.size()) {
+    grow();
+  }
+  const auto mask = table.size() - 1U;
+  for (auto i = hash(node);; i = (i + 1U) & mask) {
+    auto& entry = table[i];
+    if (entry.epoch != epoch) {
+      entry = {node, epoch, 0., 0.};
+      ++entries;
+      return true;
+    }
+    if (entry.node == node) {
+      return false;
+    }
+  }
+}
+
+void NodeProbabilityCache::grow() {
+  auto old = std::move(table);
+  const auto capacity = old.empty() ? INITIAL_CAPACITY : 2U * old.size();
+  table = std::vector<Entry>(capacity);
+  shift = 64U;
+  for (auto c = capacity; c > 1U; c >>= 1U) {
+    --shift;
+  }
+  const auto mask = capacity - 1U;
+  for (const auto& entry : old) {
+    if (entry.epoch != epoch) {
+      continue;
+    }
+    auto i = hash(entry.node);
+    while (table[i].epoch == epoch) {
+      i = (i + 1U) & mask;
+    }
+    table[i] = entry;
+  }
+}
+
+void NodeProbabilityCache::reset(const vEdge& root) {
+  // start a new epoch, which implicitly clears all entries
+  ++epoch;
+  if (epoch == 0U) {
+    for (auto& entry : table) {
+      entry.epoch = 0U;
+    }
+    epoch = 1U;
+  }
+  entries = 0U;
+  for (auto& level : levels) {
+    level.clear();
+  }
+  rootNode = root.p;
+  valid = true;
+  unexpanded = 0U;
+  subtreesComputed = false;
+  if (root.isTerminal()) {
+    return;
+  }
+
+  if (levels.size() <= root.p->v) {
+    levels.resize(static_cast<std::size_t>(root.p->v) + 1U);
+  }
+  insert(root.p);
+  at(root.p).reach = 1.;
+  levels[root.p->v].emplace_back(root.p);
+  unexpanded = static_cast<std::size_t>(root.p->v) + 1U;
+}
+
+void NodeProbabilityCache::expand(const Qubit lowest) {
+  // the nodes of a level and their reach probabilities are complete once all
+  // levels above have been expanded
+  while (unexpanded > static_cast<std::size_t>(lowest) + 1U) {
+    --unexpanded;
+    for (const auto* node : levels[unexpanded]) {
+      const auto reach = at(node).reach;
+      for (const auto& child : node->e) {
+        if (child.isTerminal()) {
+          continue;
+        }
+        if (const auto p = edgeProbability(child); p != 0.) {
+          if (insert(child.p)) {
+            levels[child.p->v].emplace_back(child.p);
+          }
+          at(child.p).reach += reach * p;
+        }
+      }
+    }
+  }
+}
+
+void NodeProbabilityCache::compute(const vEdge& root, const Qubit lowest,
+                                   const bool subtrees) {
+  if (!isCached(root)) {
+    reset(root);
+  }
+  if (root.isTerminal()) {
+    return;
+  }
+  expand(subtrees ? 0U : lowest);
+  if (!subtrees || subtreesComputed) {
+    return;
+  }
+
+  // the squared norms of the sub-vectors are accumulated bottom-up
+  for (const auto& level : levels) {
+    for (const auto* node : level) {
+      fp sum = 0.;
+      for (const auto& child : node->e) {
+        if (const auto p = edgeProbability(child); p != 0.) {
+          sum += p * subtreeProbability(child.p);
+        }
+      }
+      at(node).subtree = sum;
+    }
+  }
+  subtreesComputed = true;
+}
+
+const std::vector<const vNode*>&
+NodeProbabilityCache::nodesAt(const Qubit level) const {
+  static const std::vector<const vNode*> empty{};
+  if (!valid || level >= levels.size()) {
+    return empty;
+  }
+  return levels[level];
+}
+
+fp NodeProbabilityCache::reachProbability(const vNode* node) const noexcept {
+  if (!valid) {
+    return 0.;
+  }
+  const auto* entry = find(node);
+  return entry == nullptr ? 0. : entry->reach;
+}
+
+fp NodeProbabilityCache::subtreeProbability(const vNode* node) const noexcept {
+  if (vNode::isTerminal(node)) {
+    return 1.;
+  }
+  if (!valid) {
+    return 0.;
+  }
+  const auto* entry = find(node);
+  return entry == nullptr ? 0. : entry->subtree;
+}
+
+std::pair<fp, fp> NodeProbabilityCache::measurementProbabilities(
+    const Qubit index, const bool assumeProbabilityNormalization) const {
+  fp pzero{0};
+  fp pone{0};
+  for (const auto* node : nodesAt(index)) {
+    const auto reach = reachProbability(node);
+    const auto& s0 = node->e[0];
+    if (const auto p = edgeProbability(s0); p != 0.) {
+      pzero += reach * p *
+               (assumeProbabilityNormalization ? 1. : subtreeProbability(s0.p));
+    }
+    const auto& s1 = node->e[1];
+    if (const auto p = edgeProbability(s1); p != 0.) {
+      pone += reach * p *
+              (assumeProbabilityNormalization ? 1. : subtreeProbability(s1.p));
+    }
+  }
+  return {pzero, pone};
+}
+
+} // namespace dd
@@ -6,19 +6,28 @@
 #include "dd/DDpackageConfig.hpp"
 #include "dd/GateMatrixDefinitions.hpp"
 #include "dd/Node.hpp"
+#include "dd/Operations.hpp"
 #include "dd/Package.hpp"
+#include "dd/Parallel.hpp"
+#include "ir/QuantumComputation.hpp"
 #include "ir/operations/OpType.hpp"
 #include "ir/operations/Operation.hpp"
 
 #include <algorithm>
 #include <array>
+#include <chrono>
 #include <cmath>
+#include <complex>
 #include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <map>
 #include <memory>
 #include <random>
 #include <set>
 #include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace {
@@ -231,6 +240,28 @@ qc::OpType StochasticNoiseFunctionality::returnNoiseOperation(
   }
 }
 
+std::vector<std::vector<std::size_t>>
+groupIntoDisjointLayers(const qc::QuantumComputation& qc) {
+  std::vector<std::vector<std::size_t>> layers{};
+  // per qubit: the first layer after the last one using it
+  std::vector<std::size_t> front(qc.getNqubits(), 0U);
+  for (std::size_t i = 0U; i < qc.size(); ++i) {
+    const auto usedQubits = qc.at(i)->getUsedQubits();
+    std::size_t layer = 0U;
+    for (const auto qubit : usedQubits) {
+      layer = std::max(layer, front.at(qubit));
+    }
+    for (const auto qubit : usedQubits) {
+      front[qubit] = layer + 1U;
+    }
+    if (layer == layers.size()) {
+      layers.emplace_back();
+    }
+    layers[layer].emplace_back(i);
+  }
+  return layers;
+}
+
 DeterministicNoiseFunctionality::DeterministicNoiseFunctionality(
     const std::unique_ptr<Package<DensityMatrixSimulatorDDPackageConfig>>& dd,
     const std::size_t nq, double noiseProbabilitySingleQubit,
@@ -305,37 +336,150 @@ dCachedEdge DeterministicNoiseFunctionality::applyNoiseEffects(
   if (std::any_of(
           usedQubits.begin(), usedQubits.end(),
           [&nextLevel](const qc::Qubit qubit) { return nextLevel == qubit; })) {
-    for (auto const& type : noiseEffects) {
-      switch (type) {
-      case AmplitudeDamping:
-        applyAmplitudeDampingToEdges(newEdges, (usedQubits.size() == 1)
-                                                   ? ampDampingProbSingleQubit
-                                                   : ampDampingProbMultiQubit);
-        break;
-      case PhaseFlip:
-        applyPhaseFlipToEdges(newEdges, (usedQubits.size() == 1)
-                                            ? noiseProbSingleQubit
-                                            : noiseProbMultiQubit);
-        break;
-      case Depolarization:
-        applyDepolarisationToEdges(newEdges, (usedQubits.size() == 1)
-                                                 ? noiseProbSingleQubit
-                                                 : noiseProbMultiQubit);
-        break;
-      case Identity:
-        continue;
+    applyNoiseChannels(newEdges, usedQubits.size() != 1);
+  }
+
+  auto e = package->makeDDNode(nextLevel, newEdges, firstPathEdge);
+  if (e.w.exactlyZero()) {
+    return e;
+  }
+  e.w = e.w * originalWeight;
+  return e;
+}
+
+void DeterministicNoiseFunctionality::applyNoiseEffects(
+    dEdge& originalEdge, const std::vector<std::set<qc::Qubit>>& layer) {
+  LayerNoise noise{std::vector<std::uint8_t>(nQubits, 0U),
+                   {},
+                   static_cast<Qubit>(nQubits)};
+  for (const auto& usedQubits : layer) {
+    for (const auto qubit : usedQubits) {
+      auto& kind = noise.kinds.at(qubit);
+      if (kind != 0U) {
+        throw std::invalid_argument(
+            "The operations of a layer have to act on disjoint qubits.");
+      }
+      kind = (usedQubits.size() == 1) ? 1U : 2U;
+      noise.lowest = std::min(noise.lowest, static_cast<Qubit>(qubit));
+    }
+  }
+  if (noise.lowest == nQubits) {
+    return;
+  }
+
+  // results only depend on the noise below the node and whether it is on the
+  // first path
+  for (std::size_t firstPath = 0U; firstPath < 2U; ++firstPath) {
+    auto& signatures = noise.signatures.at(firstPath);
+    signatures.resize(nQubits + 1U);
+    signatures[0] = {static_cast<Qubit>(firstPath)};
+    for (std::size_t level = 1U; level <= nQubits; ++level) {
+      signatures[level] = signatures[level - 1U];
+      if (const auto kind = noise.kinds[level - 1U]; kind != 0U) {
+        signatures[level].emplace_back(
+            static_cast<Qubit>((2U * (level - 1U)) + kind - 1U));
       }
     }
   }
 
+  dEdge::applyDmChangesToEdge(originalEdge);
+  const auto nodeAfterNoise = applyLayerNoiseEffects(
+      originalEdge, noise, false, static_cast<Qubit>(nQubits));
+  dEdge::revertDmChangesToEdge(originalEdge);
+  auto r = dEdge{nodeAfterNoise.p, package->cn.lookup(nodeAfterNoise.w)};
+  package->incRef(r);
+  dEdge::alignDensityEdge(originalEdge);
+  package->decRef(originalEdge);
+  originalEdge = r;
+  dEdge::setDensityMatrixTrue(originalEdge);
+}
+
+dCachedEdge DeterministicNoiseFunctionality::applyLayerNoiseEffects(
+    dEdge& originalEdge, const LayerNoise& noise, const bool firstPathEdge,
+    const Qubit level) {
+  const auto originalWeight = static_cast<ComplexValue>(originalEdge.w);
+  if (originalEdge.isZeroTerminal() || level <= noise.lowest) {
+    return {originalEdge.p, originalWeight};
+  }
+
+  // the node as seen by this traversal, i.e., including the temporary density
+  // matrix flags that have been applied to it
+  auto operand = dEdge{originalEdge.p, Complex::one()};
+  if (!operand.isTerminal()) {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    operand.p = reinterpret_cast<dNode*>(
+        reinterpret_cast<std::uintptr_t>(operand.p) |
+        dNode::getDensityMatrixTempFlags(operand.p->flags));
+  }
+  const auto& signature = noise.signatures.at(firstPathEdge ? 1U : 0U)[level];
+  if (const auto cached = package->densityNoise.lookup(operand, signature);
+      cached.p != nullptr) {
+    return {cached.p, static_cast<ComplexValue>(cached.w) * originalWeight};
+  }
+
+  auto originalCopy = dEdge{originalEdge.p, Complex::one()};
+  ArrayOfEdges newEdges{};
+  const auto nextLevel = static_cast<dd::Qubit>(level - 1U);
+  if (originalEdge.isIdentity()) {
+    newEdges[0] = applyLayerNoiseEffects(originalCopy, noise, firstPathEdge,
+                                         nextLevel);
+    newEdges[3] = applyLayerNoiseEffects(originalCopy, noise, firstPathEdge,
+                                         nextLevel);
+  } else {
+    for (std::size_t i = 0; i < newEdges.size(); i++) {
+      auto& successor = originalCopy.p->e[i];
+      if (firstPathEdge || i == 1) {
+        dEdge::applyDmChangesToEdge(successor);
+        newEdges[i] =
+            applyLayerNoiseEffects(successor, noise, true, nextLevel);
+        dEdge::revertDmChangesToEdge(successor);
+      } else if (i == 2) {
+        // e[1] == e[2] (due to density matrix representation)
+        newEdges[2] = newEdges[1];
+      } else {
+        dEdge::applyDmChangesToEdge(successor);
+        newEdges[i] =
+            applyLayerNoiseEffects(successor, noise, false, nextLevel);
+        dEdge::revertDmChangesToEdge(successor);
+      }
+    }
+  }
+  if (const auto kind = noise.kinds[nextLevel]; kind != 0U) {
+    applyNoiseChannels(newEdges, kind == 2U);
+  }
+
   auto e = package->makeDDNode(nextLevel, newEdges, firstPathEdge);
   if (e.w.exactlyZero()) {
     return e;
   }
+  package->densityNoise.insert(operand, {e.p, package->cn.lookup(e.w)},
+                               signature);
   e.w = e.w * originalWeight;
   return e;
 }
 
+void DeterministicNoiseFunctionality::applyNoiseChannels(
+    ArrayOfEdges& e, const bool multiQubit) {
+  for (auto const& type : noiseEffects) {
+    switch (type) {
+    case AmplitudeDamping:
+      applyAmplitudeDampingToEdges(e, multiQubit ? ampDampingProbMultiQubit
+                                                 : ampDampingProbSingleQubit);
+      break;
+    case PhaseFlip:
+      applyPhaseFlipToEdges(e, multiQubit ? noiseProbMultiQubit
+                                          : noiseProbSingleQubit);
+      break;
+    case Depolarization:
+      applyDepolarisationToEdges(e, multiQubit ? noiseProbMultiQubit
+                                               : noiseProbSingleQubit);
+      break;
+    case Identity:
+      continue;
+    }
+  }
+}
+
 void DeterministicNoiseFunctionality::applyPhaseFlipToEdges(
     ArrayOfEdges& e, const double probability) {
   const auto complexProb = 1. - 2. * probability;
@@ -462,4 +606,402 @@ void sanityCheckOfNoiseProbabilities(const double noiseProbability,
         std::to_string(amplitudeDampingProb * multiQubitGateFactor));
   }
 }
+
+TrajectoryResult
+simulateTrajectories(const qc::QuantumComputation& qc,
+                     const TrajectoryConfig& config,
+                     const std::vector<WeightedPauliSum>& observables) {
+  if (config.trajectories == 0U) {
+    throw std::invalid_argument(
+        "Trajectory simulation requires at least one trajectory.");
+  }
+
+  // barriers neither act on the state nor introduce noise
+  std::vector<const qc::Operation*> gates{};
+  std::vector<std::set<qc::Qubit>> targets{};
+  for (const auto& op : qc) {
+    if (op->getType() == qc::Barrier) {
+      continue;
+    }
+    if (!op->isUnitary()) {
+      throw std::invalid_argument(
+          "Trajectory simulation only supports unitary operations.");
+    }
+    gates.emplace_back(op.get());
+    targets.emplace_back(op->getUsedQubits());
+  }
+
+  const auto nq = qc.getNqubits();
+  const auto trajectories = config.trajectories;
+  std::uint64_t seed = config.seed;
+  if (seed == 0U) {
+    std::random_device rd;
+    seed = (static_cast<std::uint64_t>(rd()) << 32U) | rd();
+  }
+
+  const auto workers = numWorkers(config.nthreads, trajectories);
+  std::vector<std::unique_ptr<Package<StochasticNoiseSimulatorDDPackageConfig>>>
+      packages{};
+  std::vector<std::unique_ptr<StochasticNoiseFunctionality>> noise{};
+  std::vector<std::vector<mEdge>> operations(workers);
+  std::vector<std::map<std::string, std::size_t>> counts(workers);
+  for (std::size_t w = 0U; w < workers; ++w) {
+    packages.emplace_back(
+        std::make_unique<Package<StochasticNoiseSimulatorDDPackageConfig>>(
+            nq));
+    noise.emplace_back(std::make_unique<StochasticNoiseFunctionality>(
+        packages.back(), nq, config.gateNoiseProbability,
+        config.amplitudeDampingProbability, config.multiQubitGateFactor,
+        config.noiseEffects));
+  }
+
+  TrajectoryResult result{};
+  result.runtimes.resize(trajectories);
+  std::vector<std::vector<fp>> values(observables.size(),
+                                      std::vector<fp>(trajectories));
+  parallelFor(trajectories, workers, [&](const std::size_t i,
+                                         const std::size_t w) {
+    auto& dd = *packages[w];
+    auto& ops = operations[w];
+    if (ops.empty()) {
+      for (const auto* op : gates) {
+        ops.emplace_back(getDD(op, dd));
+        dd.incRef(ops.back());
+      }
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    std::seed_seq seeds{seed & 0xFFFFFFFFU, seed >> 32U, std::uint64_t{i}};
+    std::mt19937_64 mt(seeds);
+    auto state = dd.makeZeroState(nq);
+    dd.incRef(state);
+    for (std::size_t j = 0U; j < ops.size(); ++j) {
+      noise[w]->applyNoiseOperation(targets[j], ops[j], state, mt);
+    }
+    for (std::size_t k = 0U; k < config.shotsPerTrajectory; ++k) {
+      ++counts[w][dd.measureAll(state, false, mt)];
+    }
+    for (std::size_t k = 0U; k < observables.size(); ++k) {
+      values[k][i] = dd.expectationValue(observables[k], state);
+    }
+    dd.decRef(state);
+    dd.garbageCollect();
+    result.runtimes[i] = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+  });
+
+  for (std::size_t w = 0U; w < workers; ++w) {
+    for (auto& op : operations[w]) {
+      packages[w]->decRef(op);
+    }
+    for (const auto& [outcome, count] : counts[w]) {
+      result.counts[outcome] += count;
+    }
+  }
+
+  const auto n = static_cast<fp>(trajectories);
+  for (const auto& samples : values) {
+    auto& estimate = result.observables.emplace_back();
+    for (const auto value : samples) {
+      estimate.mean += value;
+    }
+    estimate.mean /= n;
+    if (trajectories < 2U) {
+      estimate.halfWidth = std::numeric_limits<fp>::infinity();
+      continue;
+    }
+    fp variance = 0.;
+    for (const auto value : samples) {
+      variance += (value - estimate.mean) * (value - estimate.mean);
+    }
+    variance /= n - 1.;
+    estimate.halfWidth = config.zScore * std::sqrt(variance / n);
+  }
+  return result;
+}
+
+bool KrausChannel::isTracePreserving(const fp tolerance) const {
+  const auto dim = std::size_t{1} << getNqubits();
+  // entry (i, j) of the k-th Kraus operator
+  const auto entry = [this, dim](const std::size_t k, const std::size_t i,
+                                 const std::size_t j) {
+    if (dim == 2U) {
+      return singleQubitOperators[k][(2U * i) + j];
+    }
+    return twoQubitOperators[k][i][j];
+  };
+  const auto terms = (dim == 2U) ? singleQubitOperators.size()
+                                 : twoQubitOperators.size();
+  for (std::size_t i = 0U; i < dim; ++i) {
+    for (std::size_t j = 0U; j < dim; ++j) {
+      std::complex<fp> sum = 0.;
+      for (std::size_t k = 0U; k < terms; ++k) {
+        for (std::size_t l = 0U; l < dim; ++l) {
+          sum += std::conj(entry(k, l, i)) * entry(k, l, j);
+        }
+      }
+      if (std::abs(sum - ((i == j) ? 1. : 0.)) > tolerance) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+KrausChannel KrausChannel::amplitudeDamping(const fp probability) {
+  return {{GateMatrix{1, 0, 0, std::sqrt(1 - probability)},
+           GateMatrix{0, std::sqrt(probability), 0, 0}},
+          {}};
+}
+
+KrausChannel KrausChannel::phaseFlip(const fp probability) {
+  const auto keep = std::sqrt(1 - probability);
+  const auto flip = std::sqrt(probability);
+  return {{GateMatrix{keep, 0, 0, keep}, GateMatrix{flip, 0, 0, -flip}}, {}};
+}
+
+KrausChannel KrausChannel::bitFlip(const fp probability) {
+  const auto keep = std::sqrt(1 - probability);
+  const auto flip = std::sqrt(probability);
+  return {{GateMatrix{keep, 0, 0, keep}, GateMatrix{0, flip, flip, 0}}, {}};
+}
+
+namespace {
+const std::array<GateMatrix, 4U> PAULIS{
+    GateMatrix{1, 0, 0, 1}, GateMatrix{0, 1, 1, 0},
+    GateMatrix{0, std::complex<fp>{0, -1}, std::complex<fp>{0, 1}, 0},
+    GateMatrix{1, 0, 0, -1}};
+} // namespace
+
+KrausChannel KrausChannel::depolarization(const fp probability) {
+  // (1-p) rho + p I/2 = (1-3p/4) rho + p/4 (X rho X + Y rho Y + Z rho Z)
+  KrausChannel channel{};
+  for (std::size_t k = 0U; k < PAULIS.size(); ++k) {
+    const auto factor =
+        std::sqrt((k == 0U) ? 1. - (0.75 * probability) : 0.25 * probability);
+    auto& op = channel.singleQubitOperators.emplace_back(PAULIS[k]);
+    for (auto& element : op) {
+      element *= factor;
+    }
+  }
+  return channel;
+}
+
+KrausChannel KrausChannel::twoQubitDepolarization(const fp probability) {
+  // (1-p) rho + p I/4 = (1-15p/16) rho + p/16 sum_{P != II} P rho P
+  KrausChannel channel{};
+  for (std::size_t k = 0U; k < PAULIS.size() * PAULIS.size(); ++k) {
+    const auto factor = std::sqrt((k == 0U) ? 1. - (15. * probability / 16.)
+                                            : probability / 16.);
+    const auto& high = PAULIS[k / PAULIS.size()];
+    const auto& low = PAULIS[k % PAULIS.size()];
+    auto& op = channel.twoQubitOperators.emplace_back();
+    for (std::size_t i = 0U; i < NEDGE; ++i) {
+      for (std::size_t j = 0U; j < NEDGE; ++j) {
+        op[i][j] = factor * high[(2U * (i / 2U)) + (j / 2U)] *
+                   low[(2U * (i % 2U)) + (j % 2U)];
+      }
+    }
+  }
+  return channel;
+}
+
+void KrausNoiseFunctionality::checkChannel(const KrausChannel& channel) {
+  if (channel.singleQubitOperators.empty() &&
+      channel.twoQubitOperators.empty()) {
+    throw std::invalid_argument("Kraus channel without Kraus operators.");
+  }
+  // getNqubits and isTracePreserving only consider one of the sets
+  if (!channel.singleQubitOperators.empty() &&
+      !channel.twoQubitOperators.empty()) {
+    throw std::invalid_argument(
+        "Kraus channel mixes single- and two-qubit Kraus operators.");
+  }
+  if (!channel.isTracePreserving()) {
+    throw std::invalid_argument("Kraus channel is not trace preserving.");
+  }
+}
+
+KrausNoiseFunctionality::KrausNoiseFunctionality(
+    const std::unique_ptr<Package<DensityMatrixSimulatorDDPackageConfig>>& dd,
+    const std::size_t nq, KrausNoiseModel noiseModel)
+    : package(dd.get()), nQubits(nq), model(std::move(noiseModel)) {
+  for (const auto& [qubit, channels] : model.qubitChannels) {
+    if (qubit >= nQubits) {
+      throw std::invalid_argument("Noise model refers to qubit " +
+                                  std::to_string(qubit) +
+                                  ", which does not exist.");
+    }
+    for (const auto& channel : channels) {
+      checkChannel(channel);
+      if (channel.getNqubits() != 1U) {
+        throw std::invalid_argument(
+            "Channels of a qubit have to act on a single qubit.");
+      }
+    }
+  }
+  for (const auto& [type, channels] : model.gateChannels) {
+    for (const auto& channel : channels) {
+      checkChannel(channel);
+    }
+  }
+}
+
+KrausNoiseFunctionality::~KrausNoiseFunctionality() {
+  for (auto& [channel, kraus] : modelOperators) {
+    releaseKrausOperators(kraus);
+  }
+}
+
+void KrausNoiseFunctionality::applyNoiseEffects(
+    dEdge& originalEdge, const std::unique_ptr<qc::Operation>& qcOperation) {
+  const auto usedQubits = qcOperation->getUsedQubits();
+  if (const auto it = model.gateChannels.find(qcOperation->getType());
+      it != model.gateChannels.end()) {
+    for (const auto& channel : it->second) {
+      if (channel.getNqubits() == 1U) {
+        for (const auto qubit : usedQubits) {
+          applyModelChannel(originalEdge, channel, {qubit});
+        }
+        continue;
+      }
+      if (usedQubits.size() != 2U) {
+        throw std::invalid_argument(
+            "Two-qubit channels require operations using two qubits.");
+      }
+      applyModelChannel(originalEdge, channel,
+                        {usedQubits.begin(), usedQubits.end()});
+    }
+  }
+  for (const auto qubit : usedQubits) {
+    if (const auto it = model.qubitChannels.find(qubit);
+        it != model.qubitChannels.end()) {
+      for (const auto& channel : it->second) {
+        applyModelChannel(originalEdge, channel, {qubit});
+      }
+    }
+  }
+}
+
+void KrausNoiseFunctionality::applyChannel(
+    dEdge& originalEdge, const KrausChannel& channel,
+    const std::vector<qc::Qubit>& targets) {
+  checkChannel(channel);
+  if (targets.size() != channel.getNqubits()) {
+    throw std::invalid_argument(
+        "Number of targets does not match the channel.");
+  }
+  auto kraus = makeKrausOperators(channel, targets);
+  applyKrausOperators(originalEdge, kraus);
+  releaseKrausOperators(kraus);
+}
+
+KrausNoiseFunctionality::KrausOperators
+KrausNoiseFunctionality::makeKrausOperators(
+    const KrausChannel& channel, const std::vector<qc::Qubit>& targets) {
+  KrausOperators kraus{};
+  const auto add = [this, &kraus](const mEdge& op) {
+    const auto adjoint = package->conjugateTranspose(op);
+    package->incRef(op);
+    package->incRef(adjoint);
+    kraus.operators.emplace_back(op);
+    kraus.adjoints.emplace_back(adjoint);
+    // DDs and weights are unique, hence their addresses identify the channel
+    kraus.key.emplace_back(reinterpret_cast<std::uintptr_t>(op.p));
+    kraus.key.emplace_back(reinterpret_cast<std::uintptr_t>(op.w.r));
+    kraus.key.emplace_back(reinterpret_cast<std::uintptr_t>(op.w.i));
+  };
+  for (const auto& op : channel.singleQubitOperators) {
+    add(package->makeGateDD(op, targets.front()));
+  }
+  for (const auto& op : channel.twoQubitOperators) {
+    add(package->makeTwoQubitGateDD(op, targets.front(), targets.back()));
+  }
+  return kraus;
+}
+
+void KrausNoiseFunctionality::releaseKrausOperators(KrausOperators& kraus) {
+  for (auto& op : kraus.operators) {
+    package->decRef(op);
+  }
+  for (auto& adjoint : kraus.adjoints) {
+    package->decRef(adjoint);
+  }
+  kraus = {};
+}
+
+void KrausNoiseFunctionality::applyModelChannel(
+    dEdge& originalEdge, const KrausChannel& channel,
+    const std::vector<qc::Qubit>& targets) {
+  auto it = modelOperators.find({&channel, targets});
+  if (it == modelOperators.end()) {
+    it = modelOperators
+             .emplace(std::pair{&channel, targets},
+                      makeKrausOperators(channel, targets))
+             .first;
+  }
+  applyKrausOperators(originalEdge, it->second);
+}
+
+dEdge KrausNoiseFunctionality::addDensityMatrices(const dEdge& x,
+                                                  const dEdge& y) {
+  if (x.w.exactlyZero()) {
+    return y;
+  }
+  if (y.w.exactlyZero()) {
+    return x;
+  }
+  // the successors are added like in the recursion of Package::add2, but the
+  // sum is created as the root of a density matrix (i.e., on the first path)
+  const auto var = std::max(x.isTerminal() ? Qubit{0} : x.p->v,
+                            y.isTerminal() ? Qubit{0} : y.p->v);
+  const auto successor = [var](const dEdge& e,
+                               const std::size_t i) -> dCachedEdge {
+    if (e.isTerminal() || e.p->v < var) {
+      // skipped levels resemble the identity
+      return (i == 0U || i == 3U) ? dCachedEdge{e.p, e.w}
+                                  : dCachedEdge::zero();
+    }
+    const auto& s = e.p->e[i];
+    if (s.w.exactlyZero()) {
+      return dCachedEdge::zero();
+    }
+    return {s.p,
+            static_cast<ComplexValue>(e.w) * static_cast<ComplexValue>(s.w)};
+  };
+  ArrayOfEdges edges{};
+  for (std::size_t i = 0U; i < edges.size(); ++i) {
+    edges[i] = package->add2(successor(x, i), successor(y, i),
+                             static_cast<Qubit>(var - 1U));
+  }
+  return package->cn.lookup(package->makeDDNode(var, edges, true));
+}
+
+void KrausNoiseFunctionality::applyKrausOperators(
+    dEdge& originalEdge, const KrausOperators& kraus) {
+  const auto operand = dEdge{originalEdge.p, Complex::one()};
+  auto result = package->densityChannel.lookup(operand, kraus.key);
+  if (result.p == nullptr) {
+    // sum_k K_k rho K_k^dagger
+    result = dEdge::zero();
+    for (std::size_t k = 0U; k < kraus.operators.size(); ++k) {
+      const auto tmp = package->multiply(
+          operand, densityFromMatrixEdge(kraus.adjoints[k]), false);
+      const auto term = package->multiply(
+          densityFromMatrixEdge(kraus.operators[k]), tmp, true);
+      result = addDensityMatrices(result, term);
+    }
+    package->densityChannel.insert(operand, result, kraus.key);
+  }
+
+  auto r = dEdge{result.p,
+                 package->cn.lookup(static_cast<ComplexValue>(result.w) *
+                                    static_cast<ComplexValue>(originalEdge.w))};
+  package->incRef(r);
+  dEdge::alignDensityEdge(originalEdge);
+  package->decRef(originalEdge);
+  originalEdge = r;
+  dEdge::setDensityMatrixTrue(originalEdge);
+}
 } // namespace dd
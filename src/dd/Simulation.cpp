@@ -2,50 +2,222 @@
 
 #include "Definitions.hpp"
 #include "dd/DDDefinitions.hpp"
+#include "dd/FunctionalityConstruction.hpp"
 #include "dd/GateMatrixDefinitions.hpp"
 #include "dd/Package.hpp"
+#include "dd/Parallel.hpp"
 #include "dd/RealNumber.hpp"
+#include "ir/Permutation.hpp"
 #include "ir/QuantumComputation.hpp"
 #include "ir/operations/ClassicControlledOperation.hpp"
+#include "ir/operations/CompoundOperation.hpp"
+#include "ir/operations/Control.hpp"
 #include "ir/operations/NonUnitaryOperation.hpp"
 #include "ir/operations/OpType.hpp"
+#include "ir/operations/StandardOperation.hpp"
+#include "ir/operations/SymbolicOperation.hpp"
 
+#include <algorithm>
 #include <array>
+#include <chrono>
+#include <cmath>
+#include <complex>
 #include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <istream>
+#include <iterator>
+#include <limits>
 #include <map>
+#include <memory>
+#include <ostream>
 #include <random>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 namespace dd {
-template <class Config>
-std::map<std::string, std::size_t>
-simulate(const QuantumComputation* qc, const VectorDD& in, Package<Config>& dd,
-         std::size_t shots, std::size_t seed) {
-  bool isDynamicCircuit = false;
-  bool hasMeasurements = false;
-  bool measurementsLast = true;
+namespace {
+/**
+ * @brief A node in the tree of measurement outcomes of a dynamic circuit.
+ * @details The state of a branch is reference counted and the branch is
+ * responsible for releasing it. `measurements` holds the classical register in
+ * the output format of `simulate`, i.e., bit `i` is stored at position
+ * `ncbits - 1 - i`.
+ */
+template <class Iterator> struct ShotBranch {
+  VectorDD state;
+  Iterator it;
+  std::size_t target;
+  Permutation permutation;
+  std::string measurements;
+  std::size_t shots;
+};
 
-  std::mt19937_64 mt{};
-  if (seed != 0U) {
-    mt.seed(seed);
-  } else {
-    // create and properly seed rng
-    std::array<std::mt19937_64::result_type, std::mt19937_64::state_size>
-        randomData{};
-    std::random_device rd;
-    std::generate(std::begin(randomData), std::end(randomData),
-                  [&rd]() { return rd(); });
-    std::seed_seq seeds(std::begin(randomData), std::end(randomData));
-    mt.seed(seeds);
+/**
+ * @brief Splits the shots of a branch according to the outcome probabilities
+ * of measuring the given qubit.
+ * @details The current branch continues with outcome `0` (if any shots are
+ * assigned to it), while the `1` outcome is pushed to the list of pending
+ * branches and resumes at the next target of the current operation. In case
+ * only one of the outcomes receives shots, no copy of the state is created.
+ * @return the outcome the current branch continues with
+ */
+template <class Config, class Iterator>
+char splitShotBranch(ShotBranch<Iterator>& branch, const Qubit qubit,
+                     std::vector<ShotBranch<Iterator>>& branches,
+                     std::mt19937_64& mt, Package<Config>& dd) {
+  auto [pzero, pone] =
+      dd.determineMeasurementProbabilities(branch.state, qubit, true);
+  const auto norm = pzero + pone;
+  pzero /= norm;
+  pone /= norm;
+
+  std::binomial_distribution<std::size_t> dist(branch.shots,
+                                               std::clamp(pone, 0., 1.));
+  const auto onesShots = dist(mt);
+  const auto zerosShots = branch.shots - onesShots;
+
+  if (zerosShots == 0U) {
+    dd.performCollapsingMeasurement(branch.state, qubit, pone, false);
+    return '1';
+  }
+
+  if (onesShots != 0U) {
+    auto ones = branch;
+    ones.shots = onesShots;
+    // the deferred branch continues with the next target of the operation
+    ++ones.target;
+    dd.incRef(ones.state);
+    dd.performCollapsingMeasurement(ones.state, qubit, pone, false);
+    branches.emplace_back(std::move(ones));
+  }
+
+  branch.shots = zerosShots;
+  dd.performCollapsingMeasurement(branch.state, qubit, pzero, true);
+  return '0';
+}
+
+/**
+ * @brief Simulates a branch of a dynamic circuit until its end.
+ * @details Whenever a measurement or reset is encountered, the shots of the
+ * branch are split and the `1` outcome is deferred to `branches`. Finished
+ * branches contribute their shots to `counts`.
+ */
+template <class Config, class Iterator>
+void simulateShotBranch(const QuantumComputation* qc,
+                        ShotBranch<Iterator>& branch,
+                        std::vector<ShotBranch<Iterator>>& branches,
+                        std::map<std::string, std::size_t>& counts,
+                        std::mt19937_64& mt, Package<Config>& dd) {
+  const auto nbits = qc->getNcbits();
+  for (; branch.it != qc->end(); ++branch.it, branch.target = 0U) {
+    const auto& op = *branch.it;
+    if (const auto* nonunitary = dynamic_cast<NonUnitaryOperation*>(op.get());
+        nonunitary != nullptr) {
+      if (nonunitary->getType() == Measure) {
+        const auto& qubits = nonunitary->getTargets();
+        const auto& bits = nonunitary->getClassics();
+        for (; branch.target < qubits.size(); ++branch.target) {
+          const auto qubit = static_cast<Qubit>(
+              branch.permutation.at(qubits.at(branch.target)));
+          const auto pending = branches.size();
+          const auto pos = nbits - bits.at(branch.target) - 1U;
+          branch.measurements.at(pos) =
+              splitShotBranch(branch, qubit, branches, mt, dd);
+          if (branches.size() != pending) {
+            branches.back().measurements.at(pos) = '1';
+          }
+        }
+        continue;
+      }
+
+      if (nonunitary->getType() == Reset) {
+        const auto& qubits = nonunitary->getTargets();
+        for (; branch.target < qubits.size(); ++branch.target) {
+          const auto qubit = static_cast<Qubit>(
+              branch.permutation.at(qubits.at(branch.target)));
+          const auto pending = branches.size();
+          const auto bit = splitShotBranch(branch, qubit, branches, mt, dd);
+          // apply an X operation to all branches where the result is one
+          const auto x = qc::StandardOperation(qubit, qc::X);
+          const auto flip = [&x, &dd](VectorDD& state) {
+            auto tmp = dd.multiply(getDD(&x, dd), state);
+            dd.incRef(tmp);
+            dd.decRef(state);
+            state = tmp;
+            dd.garbageCollect();
+          };
+          if (branches.size() != pending) {
+            flip(branches.back().state);
+          }
+          if (bit == '1') {
+            flip(branch.state);
+          }
+        }
+        continue;
+      }
+    }
+
+    if (const auto* classicControlled =
+            dynamic_cast<ClassicControlledOperation*>(op.get());
+        classicControlled != nullptr) {
+      const auto& controlRegister = classicControlled->getControlRegister();
+      const auto& expectedValue = classicControlled->getExpectedValue();
+      auto actualValue = 0ULL;
+      // determine the actual value from measurements
+      for (std::size_t j = 0; j < controlRegister.second; ++j) {
+        if (branch.measurements.at(nbits - controlRegister.first - j - 1U) ==
+            '1') {
+          actualValue |= 1ULL << j;
+        }
+      }
+
+      // do not apply an operation if the value is not the expected one
+      if (actualValue != expectedValue) {
+        continue;
+      }
+    }
+
+    auto tmp =
+        dd.multiply(getDD(op.get(), dd, branch.permutation), branch.state);
+    dd.incRef(tmp);
+    dd.decRef(branch.state);
+    branch.state = tmp;
+
+    dd.garbageCollect();
   }
 
-  std::map<qc::Qubit, std::size_t> measurementMap{};
+  // reduce reference count of the final state of this branch
+  dd.decRef(branch.state);
+  counts[branch.measurements] += branch.shots;
+}
+
+/// Classification of a circuit with respect to its measurements
+struct MeasurementAnalysis {
+  /// whether the circuit can only be simulated shot by shot
+  bool isDynamicCircuit = false;
+  bool hasMeasurements = false;
+  /// the classical bit each measured qubit is stored to
+  std::map<qc::Qubit, std::size_t> measurementMap;
+};
+
+MeasurementAnalysis analyzeMeasurements(const QuantumComputation* qc) {
+  MeasurementAnalysis analysis{};
+  bool measurementsLast = true;
 
   // rudimentary check whether circuit is dynamic
   for (const auto& op : *qc) {
     // if it contains any dynamic circuit primitives, it certainly is dynamic
     if (op->isClassicControlledOperation() || op->getType() == qc::Reset) {
-      isDynamicCircuit = true;
+      analysis.isDynamicCircuit = true;
       break;
     }
 
@@ -53,29 +225,102 @@ simulate(const QuantumComputation* qc, const VectorDD& in, Package<Config>& dd,
     // (qubit -> bit)
     if (const auto* measure = dynamic_cast<qc::NonUnitaryOperation*>(op.get());
         measure != nullptr && measure->getType() == qc::Measure) {
-      hasMeasurements = true;
+      analysis.hasMeasurements = true;
 
       const auto& quantum = measure->getTargets();
       const auto& classic = measure->getClassics();
 
       for (std::size_t i = 0; i < quantum.size(); ++i) {
-        measurementMap[quantum.at(i)] = classic.at(i);
+        analysis.measurementMap[quantum.at(i)] = classic.at(i);
       }
     }
 
     // if an operation happens after a measurement, the resulting circuit can
     // only be simulated in single shots
-    if (hasMeasurements &&
+    if (analysis.hasMeasurements &&
         (op->isUnitary() || op->isClassicControlledOperation())) {
       measurementsLast = false;
     }
   }
 
   if (!measurementsLast) {
-    isDynamicCircuit = true;
+    analysis.isDynamicCircuit = true;
   }
+  return analysis;
+}
 
-  if (!isDynamicCircuit) {
+std::mt19937_64 makeGenerator(const std::size_t seed) {
+  std::mt19937_64 mt{};
+  if (seed != 0U) {
+    mt.seed(seed);
+  } else {
+    // create and properly seed rng
+    std::array<std::mt19937_64::result_type, std::mt19937_64::state_size>
+        randomData{};
+    std::random_device rd;
+    std::generate(std::begin(randomData), std::end(randomData),
+                  [&rd]() { return rd(); });
+    std::seed_seq seeds(std::begin(randomData), std::end(randomData));
+    mt.seed(seeds);
+  }
+  return mt;
+}
+
+/**
+ * @brief Samples the final state of a circuit without mid-circuit
+ * measurements.
+ * @details The state has to be reference counted and is released afterwards.
+ * The sampled bitstrings are mapped to the classical register of the circuit.
+ */
+template <class Config>
+std::map<std::string, std::size_t>
+sampleFinalState(const QuantumComputation* qc, VectorDD& e,
+                 const MeasurementAnalysis& analysis, const std::size_t shots,
+                 std::mt19937_64& mt, Package<Config>& dd) {
+  // measure all qubits
+  std::map<std::string, std::size_t> counts{};
+  for (std::size_t i = 0U; i < shots; ++i) {
+    // measure all returns a string of the form "q(n-1) ... q(0)"
+    auto measurement = dd.measureAll(e, false, mt);
+    counts.operator[](measurement) += 1U;
+  }
+  // reduce reference count of measured state
+  dd.decRef(e);
+
+  std::map<std::string, std::size_t> actualCounts{};
+  for (const auto& [bitstring, count] : counts) {
+    std::string measurement(qc->getNcbits(), '0');
+    if (analysis.hasMeasurements) {
+      // if the circuit contains measurements, we only want to return the
+      // measured bits
+      for (const auto& [qubit, bit] : analysis.measurementMap) {
+        // measurement map specifies that the circuit `qubit` is measured into
+        // a certain `bit`
+        measurement[qc->getNcbits() - 1U - bit] =
+            bitstring[bitstring.size() - 1U - qc->outputPermutation.at(qubit)];
+      }
+    } else {
+      // otherwise, we consider the output permutation for determining where
+      // to measure the qubits to
+      for (const auto& [qubit, bit] : qc->outputPermutation) {
+        measurement[qc->getNcbits() - 1U - bit] =
+            bitstring[bitstring.size() - 1U - qubit];
+      }
+    }
+    actualCounts[measurement] += count;
+  }
+  return actualCounts;
+}
+} // namespace
+
+template <class Config>
+std::map<std::string, std::size_t>
+simulate(const QuantumComputation* qc, const VectorDD& in, Package<Config>& dd,
+         std::size_t shots, std::size_t seed) {
+  auto mt = makeGenerator(seed);
+  const auto analysis = analyzeMeasurements(qc);
+
+  if (!analysis.isDynamicCircuit) {
     // if all gates are unitary (besides measurements at the end), we just
     // simulate once and measure all qubits repeatedly
     auto permutation = qc->initialLayout;
@@ -100,162 +345,158 @@ simulate(const QuantumComputation* qc, const VectorDD& in, Package<Config>& dd,
     changePermutation(e, permutation, qc->outputPermutation, dd);
     e = dd.reduceGarbage(e, qc->garbage);
 
-    // measure all qubits
-    std::map<std::string, std::size_t> counts{};
-    for (std::size_t i = 0U; i < shots; ++i) {
-      // measure all returns a string of the form "q(n-1) ... q(0)"
-      auto measurement = dd.measureAll(e, false, mt);
-      counts.operator[](measurement) += 1U;
-    }
-    // reduce reference count of measured state
-    dd.decRef(e);
-
-    std::map<std::string, std::size_t> actualCounts{};
-    for (const auto& [bitstring, count] : counts) {
-      std::string measurement(qc->getNcbits(), '0');
-      if (hasMeasurements) {
-        // if the circuit contains measurements, we only want to return the
-        // measured bits
-        for (const auto& [qubit, bit] : measurementMap) {
-          // measurement map specifies that the circuit `qubit` is measured into
-          // a certain `bit`
-          measurement[qc->getNcbits() - 1U - bit] =
-              bitstring[bitstring.size() - 1U -
-                        qc->outputPermutation.at(qubit)];
-        }
-      } else {
-        // otherwise, we consider the output permutation for determining where
-        // to measure the qubits to
-        for (const auto& [qubit, bit] : qc->outputPermutation) {
-          measurement[qc->getNcbits() - 1U - bit] =
-              bitstring[bitstring.size() - 1U - qubit];
-        }
-      }
-      actualCounts[measurement] += count;
-    }
-    return actualCounts;
+    return sampleFinalState(qc, e, analysis, shots, mt, dd);
   }
 
+  // dynamic circuits are simulated as a tree of measurement outcomes: every
+  // distinct prefix of outcomes is only simulated once and the shots are
+  // distributed among the branches according to the outcome probabilities
   std::map<std::string, std::size_t> counts{};
+  if (shots == 0U) {
+    return counts;
+  }
+  dd.incRef(in);
+  std::vector<ShotBranch<decltype(qc->begin())>> branches{};
+  branches.push_back({in, qc->begin(), 0U, qc->initialLayout,
+                      std::string(qc->getNcbits(), '0'), shots});
+  while (!branches.empty()) {
+    auto branch = std::move(branches.back());
+    branches.pop_back();
+    simulateShotBranch(qc, branch, branches, counts, mt, dd);
+  }
+  return counts;
+}
 
-  for (std::size_t i = 0U; i < shots; i++) {
-    std::map<std::size_t, char> measurements{};
-
-    auto permutation = qc->initialLayout;
-    auto e = in;
-    dd.incRef(e);
-
-    for (const auto& op : *qc) {
-      if (const auto* nonunitary = dynamic_cast<NonUnitaryOperation*>(op.get());
-          nonunitary != nullptr) {
-        if (nonunitary->getType() == Measure) {
-          const auto& qubits = nonunitary->getTargets();
-          const auto& bits = nonunitary->getClassics();
-          for (std::size_t j = 0U; j < qubits.size(); ++j) {
-            measurements[bits.at(j)] = dd.measureOneCollapsing(
-                e, static_cast<Qubit>(permutation.at(qubits.at(j))), true, mt);
-          }
-          continue;
-        }
+namespace {
+/// Information on the classical bits of a circuit required for merging
+/// independent branches of the probability extraction
+struct ClassicalBitUsage {
+  /// bits written by measurements at or after each position
+  std::vector<std::size_t> written;
+  /// bits read by classic-controlled operations at or after each position
+  /// before being overwritten
+  std::vector<std::size_t> live;
+  /// position after the last measurement
+  std::size_t end = 0U;
+};
 
-        if (nonunitary->getType() == Reset) {
-          const auto& qubits = nonunitary->getTargets();
-          for (const auto& qubit : qubits) {
-            auto bit = dd.measureOneCollapsing(
-                e, static_cast<Qubit>(permutation.at(qubit)), true, mt);
-            // apply an X operation whenever the measured result is one
-            if (bit == '1') {
-              const auto x =
-                  qc::StandardOperation(permutation.at(qubit), qc::X);
-              auto tmp = dd.multiply(getDD(&x, dd), e);
-              dd.incRef(tmp);
-              dd.decRef(e);
-              e = tmp;
-              dd.garbageCollect();
-            }
-          }
-          continue;
-        }
+ClassicalBitUsage analyzeClassicalBits(const QuantumComputation* qc) {
+  constexpr auto maxBits = std::numeric_limits<std::size_t>::digits;
+  if (qc->getNcbits() > maxBits) {
+    throw qc::QFRException("Probability extraction supports at most " +
+                           std::to_string(maxBits) + " classical bits.");
+  }
+  const auto nops = qc->size();
+  ClassicalBitUsage usage{std::vector<std::size_t>(nops + 1U, 0U),
+                          std::vector<std::size_t>(nops + 1U, 0U)};
+  for (auto i = nops; i > 0U; --i) {
+    const auto& op = qc->at(i - 1U);
+    auto written = usage.written[i];
+    auto live = usage.live[i];
+    if (const auto* measurement =
+            dynamic_cast<qc::NonUnitaryOperation*>(op.get());
+        measurement != nullptr && measurement->getType() == Measure) {
+      for (const auto bit : measurement->getClassics()) {
+        written |= 1ULL << bit;
+        live &= ~(1ULL << bit);
       }
-
-      if (const auto* classicControlled =
-              dynamic_cast<ClassicControlledOperation*>(op.get());
-          classicControlled != nullptr) {
-        const auto& controlRegister = classicControlled->getControlRegister();
-        const auto& expectedValue = classicControlled->getExpectedValue();
-        auto actualValue = 0ULL;
-        // determine the actual value from measurements
-        for (std::size_t j = 0; j < controlRegister.second; ++j) {
-          if (measurements[controlRegister.first + j] == '1') {
-            actualValue |= 1ULL << j;
-          }
-        }
-
-        // do not apply an operation if the value is not the expected one
-        if (actualValue != expectedValue) {
-          continue;
-        }
+      if (usage.end == 0U) {
+        usage.end = i;
       }
+    } else if (const auto* classicControlled =
+                   dynamic_cast<ClassicControlledOperation*>(op.get());
+               classicControlled != nullptr) {
+      const auto& [first, length] = classicControlled->getControlRegister();
+      for (std::size_t j = 0U; j < length; ++j) {
+        live |= 1ULL << (first + j);
+      }
+    }
+    usage.written[i - 1U] = written;
+    usage.live[i - 1U] = live;
+  }
+  return usage;
+}
 
-      auto tmp = dd.multiply(getDD(op.get(), dd, permutation), e);
-      dd.incRef(tmp);
-      dd.decRef(e);
-      e = tmp;
+/// A pending branch of the probability extraction
+struct ProbabilityBranch {
+  VectorDD state;
+  std::size_t position;
+  Permutation permutation;
+  std::size_t bits;
+  fp probability;
+};
 
-      dd.garbageCollect();
-    }
+/// Outcome distribution of a branch conditioned on reaching the branch
+struct BranchResult {
+  /// probabilities of the values of the bits written within the branch
+  SparsePVec probabilities;
+  /// probability of all sub-branches that have been pruned
+  fp discarded = 0.;
+};
 
-    // reduce reference count of measured state
-    dd.decRef(e);
+/// Branches that reach the same state at the same position with the same
+/// relevant classical bits (and permutation) have the same conditional outcome
+/// distribution
+struct BranchKey {
+  const vNode* node;
+  std::size_t position;
+  std::size_t bits;
+  Permutation permutation;
 
-    std::string shot(qc->getNcbits(), '0');
-    for (const auto& [bit, value] : measurements) {
-      shot[qc->getNcbits() - bit - 1U] = value;
-    }
-    counts[shot]++;
+  bool operator==(const BranchKey& other) const {
+    return node == other.node && position == other.position &&
+           bits == other.bits && permutation == other.permutation;
   }
+};
 
-  return counts;
-}
+struct BranchKeyHash {
+  std::size_t operator()(const BranchKey& key) const noexcept {
+    auto hash = std::hash<const vNode*>{}(key.node);
+    qc::hashCombine(hash, key.position);
+    qc::hashCombine(hash, key.bits);
+    return hash;
+  }
+};
 
-template <class Config>
-void extractProbabilityVector(const QuantumComputation* qc, const VectorDD& in,
-                              SparsePVec& probVector, Package<Config>& dd) {
-  auto permutation = qc->initialLayout;
-  dd.incRef(in);
-  extractProbabilityVectorRecursive(qc, in, qc->begin(), permutation,
-                                    std::map<std::size_t, char>{}, 1.,
-                                    probVector, dd);
-}
+/// A memoized branch
+struct BranchEntry {
+  /// the state of the branch (the entry holds a reference to it)
+  VectorDD state;
+  /// the accumulated probability the result was computed at; since pruning
+  /// depends on it, the result is only valid for branches at most as likely
+  fp probability;
+  std::shared_ptr<const BranchResult> result;
+};
+
+using BranchTable = std::unordered_map<BranchKey, BranchEntry, BranchKeyHash>;
 
+/**
+ * @brief Applies the operations of a branch until the next measurement.
+ * @details Resets are only supported on qubits in a basis state.
+ * @return the position of the next measurement or `usage.end`
+ */
 template <class Config>
-void extractProbabilityVectorRecursive(const QuantumComputation* qc,
-                                       const VectorDD& currentState,
-                                       decltype(qc->begin()) currentIt,
-                                       Permutation& permutation,
-                                       std::map<std::size_t, char> measurements,
-                                       fp commonFactor, SparsePVec& probVector,
-                                       Package<Config>& dd) {
-  auto state = currentState;
-  for (auto it = currentIt; it != qc->end(); ++it) {
-    const auto& op = (*it);
+std::size_t advanceBranch(const QuantumComputation* qc,
+                          const ClassicalBitUsage& usage, VectorDD& state,
+                          std::size_t position, Permutation& permutation,
+                          const std::size_t bits, Package<Config>& dd) {
+  for (; position < usage.end; ++position) {
+    const auto& op = qc->at(position);
 
     // check whether a classic controlled operations can be applied
     if (const auto* classicControlled =
             dynamic_cast<ClassicControlledOperation*>(op.get());
         classicControlled != nullptr) {
-      const auto& controlRegister = classicControlled->getControlRegister();
-      const auto& expectedValue = classicControlled->getExpectedValue();
-      qc::Bit actualValue = 0U;
+      const auto& [first, length] = classicControlled->getControlRegister();
+      auto actualValue = 0ULL;
       // determine the actual value from measurements
-      for (std::size_t j = 0; j < controlRegister.second; ++j) {
-        if (measurements[controlRegister.first + j] == '1') {
+      for (std::size_t j = 0U; j < length; ++j) {
+        if (((bits >> (first + j)) & 1U) != 0U) {
           actualValue |= 1ULL << j;
         }
       }
-
       // do not apply an operation if the value is not the expected one
-      if (actualValue != expectedValue) {
+      if (actualValue != classicControlled->getExpectedValue()) {
         continue;
       }
     }
@@ -273,9 +514,9 @@ void extractProbabilityVectorRecursive(const QuantumComputation* qc,
             "Resets on multiple qubits are currently not supported. Please "
             "split them into multiple single resets.");
       }
-      const auto target = targets[0];
-      auto [pzero, pone] = dd.determineMeasurementProbabilities(
-          state, static_cast<Qubit>(permutation.at(target)), true);
+      const auto target = static_cast<Qubit>(permutation.at(targets[0]));
+      auto [pzero, pone] =
+          dd.determineMeasurementProbabilities(state, target, true);
 
       // normalize probabilities
       const auto norm = pzero + pone;
@@ -283,8 +524,7 @@ void extractProbabilityVectorRecursive(const QuantumComputation* qc,
       pone /= norm;
 
       if (RealNumber::approximatelyEquals(pone, 1.)) {
-        const qc::MatrixDD xGate =
-            dd.makeGateDD(X_MAT, static_cast<Qubit>(permutation.at(target)));
+        const qc::MatrixDD xGate = dd.makeGateDD(X_MAT, target);
         const qc::VectorDD resetState = dd.multiply(xGate, state);
         dd.incRef(resetState);
         dd.decRef(state);
@@ -304,133 +544,1245 @@ void extractProbabilityVectorRecursive(const QuantumComputation* qc,
     if (const auto* measurement =
             dynamic_cast<qc::NonUnitaryOperation*>(op.get());
         measurement != nullptr && measurement->getType() == Measure) {
-      const auto& targets = measurement->getTargets();
-      const auto& classics = measurement->getClassics();
-      if (targets.size() != 1U || classics.size() != 1U) {
+      if (measurement->getTargets().size() != 1U ||
+          measurement->getClassics().size() != 1U) {
         throw qc::QFRException(
             "Measurements on multiple qubits are not supported right now. "
             "Split your measurements into individual operations.");
       }
+      return position;
+    }
+
+    // any standard operation or classic-controlled operation is applied here
+    auto tmp = dd.multiply(getDD(op.get(), dd, permutation), state);
+    dd.incRef(tmp);
+    dd.decRef(state);
+    state = tmp;
+
+    dd.garbageCollect();
+  }
+  return position;
+}
 
-      const auto target = targets[0];
-      const auto bit = classics[0];
+/// Mask of the classical bit written by the measurement at the given position
+std::size_t measuredBitMask(const QuantumComputation* qc,
+                            const std::size_t position) {
+  const auto* measurement =
+      dynamic_cast<const qc::NonUnitaryOperation*>(qc->at(position).get());
+  return std::size_t{1} << measurement->getClassics()[0];
+}
 
-      // determine probabilities for this measurement
-      auto [pzero, pone] = dd.determineMeasurementProbabilities(
-          state, static_cast<Qubit>(permutation.at(target)), true);
+/**
+ * @brief Splits a branch at the measurement at its current position.
+ * @details Calls `visit(outcome, probability, collapsedState)` for every
+ * outcome with non-zero probability whose accumulated probability is at least
+ * `threshold`. The collapsed state carries its own reference. The probability
+ * of pruned outcomes (relative to the branch) is returned.
+ */
+template <class Config, class Visitor>
+fp splitBranch(const QuantumComputation* qc, const ProbabilityBranch& branch,
+               const fp threshold, Package<Config>& dd, Visitor&& visit) {
+  const auto& measurement = qc->at(branch.position);
+  const auto target =
+      static_cast<Qubit>(branch.permutation.at(measurement->getTargets()[0]));
 
-      // normalize probabilities
-      const auto norm = pzero + pone;
-      pzero /= norm;
-      pone /= norm;
+  // determine probabilities for this measurement
+  auto [pzero, pone] =
+      dd.determineMeasurementProbabilities(branch.state, target, true);
 
-      // base case -> determine the basis state from the measurement and safe
-      // the probability
-      if (measurements.size() == qc->getNcbits() - 1) {
-        std::size_t idx0 = 0U;
-        std::size_t idx1 = 0U;
-        for (std::size_t i = 0U; i < qc->getNcbits(); ++i) {
-          // if this is the qubit being measured and the result is one
-          if (i == static_cast<std::size_t>(bit)) {
-            idx1 |= (1ULL << i);
-          } else {
-            // sanity check
-            auto findIt = measurements.find(i);
-            if (findIt == measurements.end()) {
-              throw qc::QFRException("No information on classical bit " +
-                                     std::to_string(i));
-            }
-            // if i-th bit is set increase the index appropriately
-            if (findIt->second == '1') {
-              idx0 |= (1ULL << i);
-              idx1 |= (1ULL << i);
-            }
-          }
-        }
-        const auto prob0 = commonFactor * pzero;
-        if (!RealNumber::approximatelyZero(prob0)) {
-          probVector[idx0] = prob0;
+  // normalize probabilities
+  const auto norm = pzero + pone;
+  pzero /= norm;
+  pone /= norm;
+
+  fp discarded = 0.;
+  for (const auto outcome : {0U, 1U}) {
+    const auto probability = outcome == 0U ? pzero : pone;
+    if (RealNumber::approximatelyZero(probability)) {
+      continue;
+    }
+    if (branch.probability * probability < threshold) {
+      discarded += probability;
+      continue;
+    }
+    auto collapsed = branch.state;
+    dd.incRef(collapsed);
+    dd.performCollapsingMeasurement(collapsed, target, probability,
+                                    outcome == 0U);
+    visit(outcome, probability, collapsed);
+  }
+  return discarded;
+}
+
+/**
+ * @brief Determines the outcome distribution of a branch.
+ * @details The branch's state reference is consumed. The returned distribution
+ * is conditioned on reaching the branch and only covers the bits written at or
+ * after the branch's position. Results at measurements are memoized in
+ * `table` and counted in `stats`.
+ */
+template <class Config>
+std::shared_ptr<const BranchResult>
+exploreBranch(const QuantumComputation* qc, const ClassicalBitUsage& usage,
+              ProbabilityBranch branch, const fp threshold, BranchTable& table,
+              ProbabilityExtractionStats& stats, Package<Config>& dd) {
+  branch.position = advanceBranch(qc, usage, branch.state, branch.position,
+                                  branch.permutation, branch.bits, dd);
+  if (branch.position == usage.end) {
+    dd.decRef(branch.state);
+    return std::make_shared<const BranchResult>(BranchResult{{{0U, 1.}}, 0.});
+  }
+
+  BranchKey key{branch.state.p, branch.position,
+                branch.bits & usage.live[branch.position], branch.permutation};
+  if (const auto it = table.find(key);
+      it != table.end() && branch.probability <= it->second.probability) {
+    dd.decRef(branch.state);
+    ++stats.reused;
+    return it->second.result;
+  }
+  ++stats.explored;
+
+  const auto mask = measuredBitMask(qc, branch.position);
+  // the bit is part of the sub-branch's result if it is measured again
+  const auto overwritten = (usage.written[branch.position + 1U] & mask) != 0U;
+
+  auto result = std::make_shared<BranchResult>();
+  const auto pruned = splitBranch(
+      qc, branch, threshold, dd,
+      [&](const auto outcome, const fp probability, const VectorDD& state) {
+        const auto value = outcome == 0U ? std::size_t{0} : mask;
+        const auto sub = exploreBranch(
+            qc, usage,
+            ProbabilityBranch{state, branch.position + 1U, branch.permutation,
+                              (branch.bits & ~mask) | value,
+                              branch.probability * probability},
+            threshold, table, stats, dd);
+        for (const auto& [index, p] : sub->probabilities) {
+          result->probabilities[overwritten ? index : (index | value)] +=
+              probability * p;
         }
-        const auto prob1 = commonFactor * pone;
-        if (!RealNumber::approximatelyZero(prob1)) {
-          probVector[idx1] = prob1;
+        result->discarded += probability * sub->discarded;
+      });
+  result->discarded += pruned;
+
+  // the table takes over the reference of the branch's state and replaces an
+  // entry computed at a lower probability (with more pruning)
+  BranchEntry entry{branch.state, branch.probability, result};
+  if (auto [it, inserted] = table.try_emplace(std::move(key), entry);
+      !inserted) {
+    dd.decRef(it->second.state);
+    it->second = std::move(entry);
+  }
+  return result;
+}
+
+template <class Config>
+void releaseBranchTable(BranchTable& table, Package<Config>& dd) {
+  for (auto& [key, entry] : table) {
+    dd.decRef(entry.state);
+  }
+  table.clear();
+  dd.garbageCollect();
+}
+} // namespace
+
+template <class Config>
+fp extractProbabilityVector(const QuantumComputation* qc, const VectorDD& in,
+                            SparsePVec& probVector, Package<Config>& dd,
+                            const fp pruneThreshold, const std::size_t nthreads,
+                            ProbabilityExtractionStats* stats) {
+  const auto usage = analyzeClassicalBits(qc);
+  const auto maxWorkers =
+      numWorkers(nthreads, std::numeric_limits<std::size_t>::max());
+
+  fp discarded = 0.;
+  const auto addLeaf = [&probVector](const std::size_t index, const fp p) {
+    if (!RealNumber::approximatelyZero(p)) {
+      probVector[index] += p;
+    }
+  };
+
+  // expand the tree of measurement outcomes breadth-first until there are
+  // enough independent branches to keep all workers busy
+  dd.incRef(in);
+  std::vector<ProbabilityBranch> branches{
+      {in, 0U, qc->initialLayout, 0U, 1.}};
+  const auto targetBranches = maxWorkers == 1U ? 1U : 4U * maxWorkers;
+  while (!branches.empty() && branches.size() < targetBranches) {
+    std::vector<ProbabilityBranch> next{};
+    for (auto& branch : branches) {
+      branch.position = advanceBranch(qc, usage, branch.state, branch.position,
+                                      branch.permutation, branch.bits, dd);
+      if (branch.position == usage.end) {
+        addLeaf(branch.bits, branch.probability);
+        dd.decRef(branch.state);
+        continue;
+      }
+      const auto mask = measuredBitMask(qc, branch.position);
+      discarded +=
+          branch.probability *
+          splitBranch(qc, branch, pruneThreshold, dd,
+                      [&](const auto outcome, const fp probability,
+                          const VectorDD& state) {
+                        next.push_back({state, branch.position + 1U,
+                                        branch.permutation,
+                                        outcome == 0U ? (branch.bits & ~mask)
+                                                      : (branch.bits | mask),
+                                        branch.probability * probability});
+                      });
+      dd.decRef(branch.state);
+    }
+    branches = std::move(next);
+  }
+
+  // process the remaining branches independently; in parallel, every worker
+  // uses its own package (and memo table) to which the branches are
+  // transferred
+  const auto workers = numWorkers(maxWorkers, branches.size());
+  std::vector<std::shared_ptr<const BranchResult>> results(branches.size());
+  ProbabilityExtractionStats counts{};
+  if (workers == 1U) {
+    BranchTable table{};
+    for (std::size_t i = 0U; i < branches.size(); ++i) {
+      results[i] = exploreBranch(qc, usage, branches[i], pruneThreshold, table,
+                                 counts, dd);
+    }
+    releaseBranchTable(table, dd);
+  } else {
+    std::vector<std::unique_ptr<Package<Config>>> packages(workers);
+    std::vector<BranchTable> tables(workers);
+    std::vector<ProbabilityExtractionStats> workerCounts(workers);
+    parallelFor(branches.size(), workers,
+                [&](const std::size_t i, const std::size_t worker) {
+                  auto& package = packages[worker];
+                  if (!package) {
+                    package = std::make_unique<Package<Config>>(dd.qubits());
+                  }
+                  auto branch = branches[i];
+                  branch.state = package->transfer(branch.state);
+                  package->incRef(branch.state);
+                  results[i] = exploreBranch(
+                      qc, usage, std::move(branch), pruneThreshold,
+                      tables[worker], workerCounts[worker], *package);
+                });
+    for (const auto& workerCount : workerCounts) {
+      counts.explored += workerCount.explored;
+      counts.reused += workerCount.reused;
+    }
+    // the packages are discarded as a whole
+    tables.clear();
+    for (const auto& branch : branches) {
+      dd.decRef(branch.state);
+    }
+    dd.garbageCollect();
+  }
+
+  for (std::size_t i = 0U; i < branches.size(); ++i) {
+    const auto& branch = branches[i];
+    const auto prefix = branch.bits & ~usage.written[branch.position];
+    for (const auto& [index, p] : results[i]->probabilities) {
+      addLeaf(prefix | index, branch.probability * p);
+    }
+    discarded += branch.probability * results[i]->discarded;
+  }
+  if (stats != nullptr) {
+    *stats = counts;
+  }
+  return discarded;
+}
+
+template <class Config>
+void extractProbabilityVectorRecursive(const QuantumComputation* qc,
+                                       const VectorDD& currentState,
+                                       decltype(qc->begin()) currentIt,
+                                       Permutation& permutation,
+                                       std::map<std::size_t, char> measurements,
+                                       const fp commonFactor,
+                                       SparsePVec& probVector,
+                                       Package<Config>& dd) {
+  const auto usage = analyzeClassicalBits(qc);
+  // operations after the last measurement do not affect the outcomes
+  const auto position = std::min(
+      static_cast<std::size_t>(std::distance(qc->begin(), currentIt)),
+      usage.end);
+  std::size_t bits = 0U;
+  for (const auto& [bit, value] : measurements) {
+    if (value == '1') {
+      bits |= std::size_t{1} << bit;
+    }
+  }
+
+  BranchTable table{};
+  ProbabilityExtractionStats stats{};
+  const auto result = exploreBranch(
+      qc, usage,
+      ProbabilityBranch{currentState, position, permutation, bits,
+                        commonFactor},
+      0., table, stats, dd);
+  releaseBranchTable(table, dd);
+
+  const auto prefix = bits & ~usage.written[position];
+  for (const auto& [index, p] : result->probabilities) {
+    if (!RealNumber::approximatelyZero(commonFactor * p)) {
+      probVector[prefix | index] += commonFactor * p;
+    }
+  }
+}
+
+namespace {
+/// Product `a * x + b * y` spelled out in real arithmetic, which (unlike the
+/// `std::complex` operators) allows the compiler to vectorize the loops below
+inline std::complex<fp> mulAdd(const std::complex<fp>& a,
+                               const std::complex<fp>& x,
+                               const std::complex<fp>& b,
+                               const std::complex<fp>& y) {
+  return {(a.real() * x.real()) - (a.imag() * x.imag()) +
+              (b.real() * y.real()) - (b.imag() * y.imag()),
+          (a.real() * x.imag()) + (a.imag() * x.real()) +
+              (b.real() * y.imag()) + (b.imag() * y.real())};
+}
+
+/**
+ * @brief Determines the bits fixed when applying a gate.
+ * @return the positions of the targets and controls in ascending order and the
+ * value of these bits for the first affected index (all targets being zero)
+ */
+std::pair<std::vector<std::size_t>, std::size_t>
+fixedBits(const std::vector<qc::Qubit>& targets, const Controls& controls) {
+  std::vector<std::size_t> positions(targets.begin(), targets.end());
+  std::size_t value = 0U;
+  for (const auto& control : controls) {
+    positions.emplace_back(control.qubit);
+    if (control.type == Control::Type::Pos) {
+      value |= std::size_t{1} << control.qubit;
+    }
+  }
+  std::sort(positions.begin(), positions.end());
+  return {positions, value};
+}
+
+/**
+ * @brief Calls `f(first, count)` for all runs of consecutive indices whose bits
+ * at the (ascending, non-empty) positions `fixed` equal those of `value`.
+ * @details The other bits enumerate all combinations by depositing the bits of
+ * a counter into the free positions (as done by state-vector simulators), so
+ * the loops applying a gate need no data-dependent branches.
+ */
+template <class Function>
+void forEachRun(const std::size_t size, const std::vector<std::size_t>& fixed,
+                const std::size_t value, Function&& f) {
+  // the bits below the lowest fixed position are free
+  const auto run = std::size_t{1} << fixed.front();
+  const auto count = size >> fixed.size();
+  for (std::size_t k = 0U; k < count; k += run) {
+    auto index = k;
+    for (const auto position : fixed) {
+      const auto low = index & ((std::size_t{1} << position) - 1U);
+      index = ((index >> position) << (position + 1U)) | low;
+    }
+    f(index | value, run);
+  }
+}
+
+void applyDenseGate(CVec& state, const GateMatrix& gm, const qc::Qubit target,
+                    const Controls& controls) {
+  const auto [fixed, value] = fixedBits({target}, controls);
+  const auto stride = std::size_t{1} << target;
+  auto* amplitudes = state.data();
+  forEachRun(state.size(), fixed, value,
+             [&gm, stride, amplitudes](const std::size_t first,
+                                       const std::size_t count) {
+               for (auto i = first; i < first + count; ++i) {
+                 const auto zero = amplitudes[i];
+                 const auto one = amplitudes[i + stride];
+                 amplitudes[i] = mulAdd(gm[0U], zero, gm[1U], one);
+                 amplitudes[i + stride] = mulAdd(gm[2U], zero, gm[3U], one);
+               }
+             });
+}
+
+void applyDenseGate(CVec& state, const TwoQubitGateMatrix& gm,
+                    const qc::Qubit target0, const qc::Qubit target1,
+                    const Controls& controls) {
+  const auto [fixed, value] = fixedBits({target0, target1}, controls);
+  const auto stride0 = std::size_t{1} << target0;
+  const auto stride1 = std::size_t{1} << target1;
+  auto* amplitudes = state.data();
+  forEachRun(
+      state.size(), fixed, value,
+      [&gm, stride0, stride1, amplitudes](const std::size_t first,
+                                          const std::size_t count) {
+        for (auto i = first; i < first + count; ++i) {
+          // the row index of the matrix is `2 * q0 + q1`
+          const std::array<std::size_t, NEDGE> indices{
+              i, i + stride1, i + stride0, i + stride0 + stride1};
+          std::array<std::complex<fp>, NEDGE> in{};
+          for (std::size_t k = 0U; k < NEDGE; ++k) {
+            in[k] = amplitudes[indices[k]];
+          }
+          for (std::size_t row = 0U; row < NEDGE; ++row) {
+            amplitudes[indices[row]] =
+                mulAdd(gm[row][0U], in[0U], gm[row][1U], in[1U]) +
+                mulAdd(gm[row][2U], in[2U], gm[row][3U], in[3U]);
+          }
         }
+      });
+}
 
-        // probabilities have been written -> this path is done
-        dd.decRef(state);
-        return;
+/// Dense counterpart of `dd.multiply(getDD(op, dd, permutation), state)`
+void applyDenseOperation(const Operation* op, CVec& state,
+                         Permutation& permutation) {
+  const auto type = op->getType();
+
+  // SWAPs only update the permutation (see getDD)
+  if (!permutation.empty() && type == qc::SWAP && !op->isControlled()) {
+    const auto& targets = op->getTargets();
+    std::swap(permutation.at(targets[0U]), permutation.at(targets[1U]));
+    return;
+  }
+
+  if (type == qc::Barrier) {
+    return;
+  }
+
+  if (type == qc::GPhase) {
+    const auto phase = op->getParameter()[0U];
+    const std::complex<fp> factor{std::cos(phase), std::sin(phase)};
+    for (auto& amplitude : state) {
+      amplitude *= factor;
+    }
+    return;
+  }
+
+  if (const auto* standardOp = dynamic_cast<const StandardOperation*>(op)) {
+    auto targets = op->getTargets();
+    auto controls = op->getControls();
+    if (!permutation.empty()) {
+      targets = permutation.apply(targets);
+      controls = permutation.apply(controls);
+    }
+
+    if (qc::isTwoQubitGate(type)) {
+      applyDenseGate(state,
+                     getStandardOperationTwoQubitMatrix(standardOp, false),
+                     targets[0U], targets[1U], controls);
+      return;
+    }
+    applyDenseGate(state, getStandardOperationMatrix(standardOp, false),
+                   targets[0U], controls);
+    return;
+  }
+
+  if (const auto* compoundOp = dynamic_cast<const CompoundOperation*>(op)) {
+    for (const auto& operation : *compoundOp) {
+      applyDenseOperation(operation.get(), state, permutation);
+    }
+    return;
+  }
+
+  throw qc::QFRException("Dense simulation of operation " + op->getName() +
+                         " not available!");
+}
+
+/**
+ * @brief Counts the distinct nodes on the lowest level of the DD of a state.
+ * @details These correspond to the distinct non-zero amplitude pairs
+ * `(a_2i, a_2i+1)` up to normalization, which bounds the size of the DD from
+ * below without touching the unique table. Counting stops as soon as `limit`
+ * is exceeded, so incompressible states are rejected after a few pairs.
+ */
+std::size_t countLowestLevelNodes(const CVec& state, const std::size_t limit,
+                                  const fp threshold) {
+  // the grid on which normalized amplitudes are considered equal
+  constexpr fp resolution = 1e-8;
+  const auto quantize = [](const fp x) {
+    return std::hash<long long>{}(std::llround(x / resolution));
+  };
+
+  std::unordered_set<std::size_t> pairs{};
+  for (std::size_t i = 0U; i + 1U < state.size(); i += 2U) {
+    auto a = state[i];
+    auto b = state[i + 1U];
+    if (std::abs(a) <= threshold && std::abs(b) <= threshold) {
+      continue;
+    }
+    const auto pivot = std::abs(a) >= std::abs(b) ? a : b;
+    a /= pivot;
+    b /= pivot;
+    auto key = quantize(a.real());
+    key = qc::combineHash(key, quantize(a.imag()));
+    key = qc::combineHash(key, quantize(b.real()));
+    key = qc::combineHash(key, quantize(b.imag()));
+    pairs.emplace(key);
+    if (pairs.size() > limit) {
+      break;
+    }
+  }
+  return pairs.size();
+}
+
+/**
+ * @brief Applies the unitary operations of a circuit, switching between a DD
+ * and a dense state vector.
+ * @details The returned state is reference counted and still has to be
+ * adjusted to the output permutation.
+ */
+template <class Config>
+VectorDD applyHybrid(const QuantumComputation* qc, const VectorDD& in,
+                     Package<Config>& dd, Permutation& permutation,
+                     const HybridSimulationConfig& config) {
+  auto e = in;
+  dd.incRef(e);
+
+  const auto nqubits = e.isTerminal() ? 0U : e.p->v + 1U;
+  const auto dim = static_cast<fp>(1ULL << nqubits);
+  const auto interval = std::max<std::size_t>(config.checkInterval, 1U);
+
+  const auto maxBackoff =
+      std::max<std::size_t>(config.maxRecompressBackoff, 1U);
+  const auto maxNodes = static_cast<std::size_t>(config.sparseThreshold * dim);
+
+  CVec dense{};
+  bool isDense = false;
+  std::size_t sinceCheck = 0U;
+  // number of checks to skip before the next recompression attempt
+  std::size_t backoff = 1U;
+  std::size_t skippedChecks = 0U;
+  for (const auto& op : *qc) {
+    // simply skip any non-unitary
+    if (!op->isUnitary()) {
+      continue;
+    }
+
+    if (isDense) {
+      applyDenseOperation(op.get(), dense, permutation);
+    } else {
+      auto tmp = dd.multiply(getDD(op.get(), dd, permutation), e);
+      dd.incRef(tmp);
+      dd.decRef(e);
+      e = tmp;
+
+      dd.garbageCollect();
+    }
+
+    if (++sinceCheck < interval) {
+      continue;
+    }
+    sinceCheck = 0U;
+
+    if (!isDense) {
+      // the DD is no longer compact: continue on a flat array
+      if (static_cast<fp>(e.size()) > config.denseThreshold * dim) {
+        dense.resize(1ULL << nqubits);
+        e.writeVector(dense.data(), 0., config.nthreads);
+        dd.decRef(e);
+        dd.garbageCollect();
+        isDense = true;
+        backoff = 1U;
+        skippedChecks = 0U;
       }
+      continue;
+    }
 
-      const bool nonZeroP0 = !RealNumber::approximatelyZero(pzero);
-      const bool nonZeroP1 = !RealNumber::approximatelyZero(pone);
+    if (++skippedChecks < backoff) {
+      continue;
+    }
+    skippedChecks = 0U;
 
-      // in case both outcomes are non-zero the reference count of the state has
-      // to be increased once more in order to avoid reference counting errors
-      if (nonZeroP0 && nonZeroP1) {
-        dd.incRef(state);
+    // only build the DD if its lowest level alone is small enough
+    if (countLowestLevelNodes(dense, maxNodes, config.recompressThreshold) <=
+        maxNodes) {
+      const auto compressed = dd.makeStateFromVector(
+          dense, config.recompressThreshold, config.nthreads);
+      if (static_cast<fp>(compressed.size()) <=
+          config.sparseThreshold * dim) {
+        e = compressed;
+        dd.incRef(e);
+        CVec{}.swap(dense);
+        isDense = false;
+        continue;
       }
+      dd.garbageCollect();
+    }
+    backoff = std::min(2U * backoff, maxBackoff);
+  }
+
+  if (isDense) {
+    e = dd.makeStateFromVector(dense, config.recompressThreshold,
+                               config.nthreads);
+    dd.incRef(e);
+  }
+  return e;
+}
+} // namespace
+
+template <class Config>
+VectorDD simulateHybrid(const QuantumComputation* qc, const VectorDD& in,
+                        Package<Config>& dd,
+                        const HybridSimulationConfig& config) {
+  auto permutation = qc->initialLayout;
+  auto e = applyHybrid(qc, in, dd, permutation, config);
 
-      // recursive case -- outcome 0
-      if (nonZeroP0) {
-        // save measurement result
-        measurements[bit] = '0';
-        // determine accumulated probability
-        auto probability = commonFactor * pzero;
-        // determine the next iteration point
-        auto nextIt = it + 1;
-        // actually collapse the state
-        auto measuredState = state;
-        dd.performCollapsingMeasurement(
-            measuredState, static_cast<Qubit>(permutation.at(target)), pzero,
-            true);
-        // recursive call from here
-        extractProbabilityVectorRecursive(qc, measuredState, nextIt,
-                                          permutation, measurements,
-                                          probability, probVector, dd);
+  // correct permutation if necessary
+  changePermutation(e, permutation, qc->outputPermutation, dd);
+  e = dd.reduceGarbage(e, qc->garbage);
+
+  return e;
+}
+
+template <class Config>
+std::map<std::string, std::size_t>
+simulateHybrid(const QuantumComputation* qc, const VectorDD& in,
+               Package<Config>& dd, std::size_t shots, std::size_t seed,
+               const HybridSimulationConfig& config) {
+  const auto analysis = analyzeMeasurements(qc);
+  if (analysis.isDynamicCircuit) {
+    // mid-circuit measurements split the simulation into branches, which are
+    // best handled by the DD-based simulation
+    return simulate(qc, in, dd, shots, seed);
+  }
+
+  auto mt = makeGenerator(seed);
+  auto e = simulateHybrid(qc, in, dd, config);
+  return sampleFinalState(qc, e, analysis, shots, mt, dd);
+}
+
+template <class Config>
+VectorDD approximateSimulate(const QuantumComputation* qc, const VectorDD& in,
+                             Package<Config>& dd, fp& fidelity,
+                             const ApproximationConfig& config) {
+  // number of halvings of the threshold before giving up on an approximation
+  constexpr std::size_t maxAttempts = 16U;
+
+  fidelity = 1.;
+  const auto minFidelity = 1. - config.fidelityBudget;
+  const auto interval = std::max<std::size_t>(config.checkInterval, 1U);
+  auto threshold = config.threshold;
+  std::size_t sinceCheck = 0U;
+
+  auto permutation = qc->initialLayout;
+  auto e = in;
+  dd.incRef(e);
+
+  for (const auto& op : *qc) {
+    // simply skip any non-unitary
+    if (!op->isUnitary()) {
+      continue;
+    }
+
+    auto tmp = dd.multiply(getDD(op.get(), dd, permutation), e);
+    dd.incRef(tmp);
+    dd.decRef(e);
+    e = tmp;
+
+    // determining the size traverses the whole DD
+    if (config.fidelityBudget > 0. && ++sinceCheck >= interval) {
+      sinceCheck = 0U;
+      if (e.size() > config.nodeLimit) {
+        auto candidateThreshold = threshold;
+        for (std::size_t attempt = 0U; attempt < maxAttempts; ++attempt) {
+          auto candidate = e;
+          dd.incRef(candidate);
+          fp f = 0.;
+          try {
+            f = dd.approximate(candidate, candidateThreshold);
+          } catch (const std::invalid_argument&) {
+            // the threshold would remove the entire state
+          }
+          if (f > 0. && fidelity * f >= minFidelity) {
+            dd.decRef(e);
+            e = candidate;
+            fidelity *= f;
+            threshold = candidateThreshold;
+            break;
+          }
+          dd.decRef(candidate);
+          candidateThreshold /= 2.;
+        }
       }
+    }
+
+    dd.garbageCollect();
+  }
+
+  // correct permutation if necessary
+  changePermutation(e, permutation, qc->outputPermutation, dd);
+  e = dd.reduceGarbage(e, qc->garbage);
+
+  return e;
+}
+
+template <class Config>
+VectorDD simulateTimeEvolution(
+    const QuantumComputation* step, const VectorDD& in, Package<Config>& dd,
+    const std::size_t steps,
+    const std::function<void(std::size_t, const VectorDD&)>& observer,
+    std::size_t stride) {
+  stride = std::clamp<std::size_t>(stride, 1U,
+                                   std::max<std::size_t>(steps, 1U));
+
+  // powers[k] holds U^(2^k) (each with a reference)
+  std::vector<MatrixDD> powers{buildFunctionality(step, dd)};
+  const auto power = [&powers, &dd](const std::size_t k) {
+    while (powers.size() <= k) {
+      const auto square = dd.multiply(powers.back(), powers.back());
+      dd.incRef(square);
+      powers.emplace_back(square);
+    }
+    return powers[k];
+  };
+
+  auto e = in;
+  dd.incRef(e);
+  const auto apply = [&e, &dd](const MatrixDD& u) {
+    auto tmp = dd.multiply(u, e);
+    dd.incRef(tmp);
+    dd.decRef(e);
+    e = tmp;
+    dd.garbageCollect();
+  };
 
-      // recursive case -- outcome 1
-      if (nonZeroP1) {
-        // save measurement result
-        measurements[bit] = '1';
-        // determine accumulated probability
-        auto probability = commonFactor * pone;
-        // determine the next iteration point
-        auto nextIt = it + 1;
-        // actually collapse the state
-        auto measuredState = state;
-        dd.performCollapsingMeasurement(
-            measuredState, static_cast<Qubit>(permutation.at(target)), pone,
-            false);
-        // recursive call from here
-        extractProbabilityVectorRecursive(qc, measuredState, nextIt,
-                                          permutation, measurements,
-                                          probability, probVector, dd);
+  // U^stride from the binary representation of the stride
+  auto strideUnitary = power(0U);
+  dd.incRef(strideUnitary);
+  if (stride > 1U) {
+    auto product = MatrixDD::one();
+    for (std::size_t k = 0U; (stride >> k) != 0U; ++k) {
+      if (((stride >> k) & 1U) != 0U) {
+        product = dd.multiply(power(k), product);
       }
+    }
+    dd.incRef(product);
+    dd.decRef(strideUnitary);
+    strideUnitary = product;
+    dd.garbageCollect();
+  }
 
-      // everything is said and done
-      return;
+  std::size_t applied = 0U;
+  for (; applied + stride <= steps; applied += stride) {
+    apply(strideUnitary);
+    if (observer) {
+      observer(applied + stride, e);
+    }
+  }
+  if (const auto remainder = steps - applied; remainder != 0U) {
+    for (std::size_t k = 0U; (remainder >> k) != 0U; ++k) {
+      if (((remainder >> k) & 1U) != 0U) {
+        apply(power(k));
+      }
     }
+    if (observer) {
+      observer(steps, e);
+    }
+  }
 
-    // any standard operation or classic-controlled operation is applied here
-    auto tmp = dd.multiply(getDD(op.get(), dd, permutation), state);
+  dd.decRef(strideUnitary);
+  for (const auto& u : powers) {
+    dd.decRef(u);
+  }
+  dd.garbageCollect();
+  return e;
+}
+
+namespace {
+/// Copy of a symbolic operation with all parameters instantiated
+std::unique_ptr<Operation> instantiate(const Operation* op,
+                                       const VariableAssignment& assignment) {
+  if (const auto* symbolic = dynamic_cast<const SymbolicOperation*>(op)) {
+    return std::make_unique<StandardOperation>(
+        symbolic->getInstantiatedOperation(assignment));
+  }
+  if (const auto* compound = dynamic_cast<const CompoundOperation*>(op)) {
+    std::vector<std::unique_ptr<Operation>> ops{};
+    ops.reserve(compound->size());
+    for (const auto& child : *compound) {
+      ops.emplace_back(child->isSymbolicOperation()
+                           ? instantiate(child.get(), assignment)
+                           : child->clone());
+    }
+    return std::make_unique<CompoundOperation>(std::move(ops),
+                                               compound->isCustomGate());
+  }
+  return op->clone();
+}
+
+/// Simulates the operations starting at `begin` for a parameter assignment
+template <class Config>
+VectorDD simulateSuffix(const QuantumComputation* qc, const std::size_t begin,
+                        const VectorDD& in, Permutation permutation,
+                        const VariableAssignment& assignment,
+                        Package<Config>& dd) {
+  auto e = in;
+  dd.incRef(e);
+  for (auto it = qc->begin() + static_cast<std::ptrdiff_t>(begin);
+       it != qc->end(); ++it) {
+    const auto* op = it->get();
+    // simply skip any non-unitary
+    if (!op->isUnitary()) {
+      continue;
+    }
+
+    const auto gate =
+        op->isSymbolicOperation()
+            ? getDD(instantiate(op, assignment).get(), dd, permutation)
+            : getDD(op, dd, permutation);
+    auto tmp = dd.multiply(gate, e);
     dd.incRef(tmp);
-    dd.decRef(state);
-    state = tmp;
+    dd.decRef(e);
+    e = tmp;
 
     dd.garbageCollect();
   }
+
+  // correct permutation if necessary
+  changePermutation(e, permutation, qc->outputPermutation, dd);
+  return dd.reduceGarbage(e, qc->garbage);
+}
+} // namespace
+
+template <class Config>
+std::vector<VectorDD>
+simulateSweep(const QuantumComputation* qc, const VectorDD& in,
+              Package<Config>& dd,
+              const std::vector<VariableAssignment>& assignments,
+              const std::size_t nthreads) {
+  // simulate the non-parametric prefix once
+  const auto split = static_cast<std::size_t>(
+      std::find_if(qc->begin(), qc->end(),
+                   [](const auto& op) { return op->isSymbolicOperation(); }) -
+      qc->begin());
+  auto permutation = qc->initialLayout;
+  auto prefix = in;
+  dd.incRef(prefix);
+  for (std::size_t i = 0U; i < split; ++i) {
+    const auto& op = qc->at(i);
+    if (!op->isUnitary()) {
+      continue;
+    }
+    auto tmp = dd.multiply(getDD(op.get(), dd, permutation), prefix);
+    dd.incRef(tmp);
+    dd.decRef(prefix);
+    prefix = tmp;
+
+    dd.garbageCollect();
+  }
+
+  std::vector<VectorDD> results(assignments.size());
+  const auto workers = numWorkers(nthreads, assignments.size());
+  if (workers <= 1U) {
+    for (std::size_t i = 0U; i < assignments.size(); ++i) {
+      results[i] = simulateSuffix(qc, split, prefix, permutation,
+                                  assignments[i], dd);
+    }
+  } else {
+    // every worker continues from a copy of the prefix state in its own
+    // package; the results are transferred back afterwards
+    std::vector<std::unique_ptr<Package<Config>>> packages(workers);
+    std::vector<VectorDD> starts(workers);
+    std::vector<VectorDD> local(assignments.size());
+    parallelFor(assignments.size(), workers,
+                [&](const std::size_t i, const std::size_t worker) {
+                  auto& package = packages[worker];
+                  if (!package) {
+                    package = std::make_unique<Package<Config>>(dd.qubits());
+                    starts[worker] = package->transfer(prefix);
+                    package->incRef(starts[worker]);
+                  }
+                  local[i] = simulateSuffix(qc, split, starts[worker],
+                                            permutation, assignments[i],
+                                            *package);
+                });
+    for (std::size_t i = 0U; i < assignments.size(); ++i) {
+      results[i] = dd.transfer(local[i]);
+      dd.incRef(results[i]);
+    }
+  }
+
+  dd.decRef(prefix);
+  dd.garbageCollect();
+  return results;
+}
+
+namespace {
+constexpr std::array<char, 8U> CHECKPOINT_MAGIC{'M', 'Q', 'T', 'D',
+                                                'D', 'C', 'K', 'P'};
+constexpr std::uint32_t CHECKPOINT_VERSION = 2U;
+/// the textual representation of a std::mt19937_64 has at most that many words
+constexpr std::size_t CHECKPOINT_GENERATOR_WORDS =
+    std::mt19937_64::state_size + 1U;
+/// qubit, and child index and weight of both successors
+constexpr std::size_t CHECKPOINT_NODE_SIZE =
+    sizeof(Qubit) + RADIX * (sizeof(std::uint32_t) + 2U * sizeof(fp));
+
+template <class T> void put(std::vector<char>& buffer, const T& value) {
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  const auto* bytes = reinterpret_cast<const char*>(&value);
+  buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+void putWeight(std::vector<char>& buffer, const Complex& w) {
+  const auto value = static_cast<ComplexValue>(w);
+  put(buffer, value.r);
+  put(buffer, value.i);
+}
+
+template <class T> T get(std::istream& is) {
+  T value{};
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  is.read(reinterpret_cast<char*>(&value), sizeof(T));
+  if (!is) {
+    throw std::runtime_error("Unexpected end of checkpoint.");
+  }
+  return value;
+}
+
+template <class T> T take(const char*& data) {
+  T value{};
+  std::memcpy(&value, data, sizeof(T));
+  data += sizeof(T);
+  return value;
+}
+
+/// Rejects checkpoint configurations that cannot be used
+void checkCheckpointConfig(const MeasurementAnalysis& analysis,
+                           const CheckpointConfig& config) {
+  if (analysis.isDynamicCircuit) {
+    throw std::invalid_argument(
+        "Checkpointing is not supported for dynamic circuits.");
+  }
+  // otherwise, the snapshots would silently be written to `.tmp`
+  if (config.filename.empty()) {
+    throw std::invalid_argument("Checkpointing requires a filename.");
+  }
+}
+
+/// Writes the checkpoint to a temporary file that replaces the previous one
+void saveCheckpoint(const CheckpointConfig& config,
+                    const SimulationCheckpoint& checkpoint) {
+  const auto temporary = config.filename + ".tmp";
+  {
+    std::ofstream ofs(temporary, std::ios::binary);
+    if (!ofs.good()) {
+      throw std::runtime_error("Cannot open checkpoint file: " + temporary);
+    }
+    writeCheckpoint(ofs, checkpoint);
+    ofs.close();
+    if (!ofs) {
+      throw std::runtime_error("Cannot write checkpoint file: " + temporary);
+    }
+  }
+  if (std::rename(temporary.c_str(), config.filename.c_str()) != 0) {
+    // renaming onto an existing file is not supported on all platforms
+    std::remove(config.filename.c_str());
+    if (std::rename(temporary.c_str(), config.filename.c_str()) != 0) {
+      throw std::runtime_error("Cannot replace checkpoint file: " +
+                               config.filename);
+    }
+  }
+}
+
+/**
+ * @brief Continues the simulation of a circuit without mid-circuit
+ * measurements from a checkpoint and samples the final state.
+ * @details The state of the checkpoint has to be reference counted.
+ */
+template <class Config>
+std::map<std::string, std::size_t>
+continueFromCheckpoint(const QuantumComputation* qc,
+                       SimulationCheckpoint& checkpoint,
+                       const MeasurementAnalysis& analysis,
+                       const std::size_t shots, const CheckpointConfig& config,
+                       Package<Config>& dd) {
+  using Clock = std::chrono::steady_clock;
+  const auto interval = std::chrono::duration<fp>(config.interval);
+  auto lastCheckpoint = Clock::now();
+
+  auto& e = checkpoint.state;
+  while (checkpoint.position < qc->size()) {
+    const auto& op = qc->at(checkpoint.position);
+    ++checkpoint.position;
+    // simply skip any non-unitary
+    if (op->isUnitary()) {
+      auto tmp = dd.multiply(getDD(op.get(), dd, checkpoint.permutation), e);
+      dd.incRef(tmp);
+      dd.decRef(e);
+      e = tmp;
+
+      dd.garbageCollect();
+    }
+
+    if (Clock::now() - lastCheckpoint >= interval) {
+      saveCheckpoint(config, checkpoint);
+      lastCheckpoint = Clock::now();
+    }
+  }
+  // sampling may take a while as well
+  saveCheckpoint(config, checkpoint);
+
+  // correct permutation if necessary
+  changePermutation(e, checkpoint.permutation, qc->outputPermutation, dd);
+  e = dd.reduceGarbage(e, qc->garbage);
+
+  return sampleFinalState(qc, e, analysis, shots, checkpoint.mt, dd);
+}
+} // namespace
+
+CircuitFingerprint fingerprintCircuit(const QuantumComputation& qc) {
+  std::size_t hash = std::hash<Permutation>{}(qc.initialLayout);
+  for (const auto& op : qc) {
+    qc::hashCombine(hash, std::hash<qc::Operation>{}(*op));
+  }
+  return {qc.getNqubits(), qc.size(), hash};
+}
+
+void writeCheckpoint(std::ostream& os, const SimulationCheckpoint& checkpoint) {
+  std::vector<char> buffer(CHECKPOINT_MAGIC.begin(), CHECKPOINT_MAGIC.end());
+  put(buffer, CHECKPOINT_VERSION);
+  put(buffer, checkpoint.circuit.nqubits);
+  put(buffer, checkpoint.circuit.nops);
+  put(buffer, checkpoint.circuit.hash);
+  put<std::uint64_t>(buffer, checkpoint.position);
+  put<std::uint64_t>(buffer, checkpoint.permutation.size());
+  for (const auto& [from, to] : checkpoint.permutation) {
+    put(buffer, from);
+    put(buffer, to);
+  }
+  // the state of the generator is only accessible via its textual
+  // representation, whose words are stored in binary
+  std::ostringstream generator;
+  generator << checkpoint.mt;
+  std::istringstream generatorText(generator.str());
+  std::vector<std::uint64_t> words{};
+  for (std::uint64_t word{}; generatorText >> word;) {
+    words.emplace_back(word);
+  }
+  put<std::uint64_t>(buffer, words.size());
+  for (const auto word : words) {
+    put(buffer, word);
+  }
+
+  // number the nodes in post-order so that every child precedes its parents
+  const auto& root = checkpoint.state;
+  std::vector<const vNode*> order{};
+  std::unordered_map<const vNode*, std::uint32_t> indices{};
+  std::vector<std::pair<const vNode*, bool>> stack{};
+  if (!root.isTerminal()) {
+    stack.emplace_back(root.p, false);
+  }
+  while (!stack.empty()) {
+    const auto [node, expanded] = stack.back();
+    if (indices.count(node) != 0U) {
+      stack.pop_back();
+      continue;
+    }
+    if (expanded) {
+      indices.emplace(node, static_cast<std::uint32_t>(order.size()));
+      order.emplace_back(node);
+      stack.pop_back();
+      continue;
+    }
+    stack.back().second = true;
+    for (const auto& child : node->e) {
+      if (!child.isTerminal() && indices.count(child.p) == 0U) {
+        stack.emplace_back(child.p, false);
+      }
+    }
+  }
+
+  putWeight(buffer, root.w);
+  put<std::uint64_t>(buffer, order.size());
+  buffer.reserve(buffer.size() + order.size() * CHECKPOINT_NODE_SIZE);
+  for (const auto* node : order) {
+    put(buffer, node->v);
+    for (const auto& child : node->e) {
+      // index 0 denotes the terminal
+      put<std::uint32_t>(buffer,
+                         child.isTerminal() ? 0U : indices.at(child.p) + 1U);
+      putWeight(buffer, child.w);
+    }
+  }
+  os.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+}
+
+template <class Config>
+SimulationCheckpoint readCheckpoint(std::istream& is, Package<Config>& dd) {
+  auto magic = decltype(CHECKPOINT_MAGIC){};
+  is.read(magic.data(), static_cast<std::streamsize>(magic.size()));
+  if (!is || magic != CHECKPOINT_MAGIC) {
+    throw std::runtime_error("Not a simulation checkpoint.");
+  }
+  if (const auto version = get<std::uint32_t>(is);
+      version != CHECKPOINT_VERSION) {
+    throw std::runtime_error(
+        "Wrong version of checkpoint. version of file: " +
+        std::to_string(version) +
+        "; current version: " + std::to_string(CHECKPOINT_VERSION));
+  }
+
+  SimulationCheckpoint checkpoint{};
+  checkpoint.circuit.nqubits = get<std::uint64_t>(is);
+  checkpoint.circuit.nops = get<std::uint64_t>(is);
+  checkpoint.circuit.hash = get<std::uint64_t>(is);
+  checkpoint.position = get<std::uint64_t>(is);
+  const auto permutationSize = get<std::uint64_t>(is);
+  for (std::uint64_t i = 0U; i < permutationSize; ++i) {
+    const auto from = get<qc::Qubit>(is);
+    checkpoint.permutation[from] = get<qc::Qubit>(is);
+  }
+  const auto generatorSize = get<std::uint64_t>(is);
+  if (generatorSize > CHECKPOINT_GENERATOR_WORDS) {
+    throw std::runtime_error("Corrupted generator state in checkpoint.");
+  }
+  std::ostringstream generatorText;
+  for (std::uint64_t i = 0U; i < generatorSize; ++i) {
+    generatorText << get<std::uint64_t>(is) << ' ';
+  }
+  std::istringstream generator(generatorText.str());
+  generator >> checkpoint.mt;
+  if (!is || !generator) {
+    throw std::runtime_error("Corrupted generator state in checkpoint.");
+  }
+
+  ComplexValue rootWeight{};
+  rootWeight.r = get<fp>(is);
+  rootWeight.i = get<fp>(is);
+  const auto count = get<std::uint64_t>(is);
+  std::vector<char> records(count * CHECKPOINT_NODE_SIZE);
+  is.read(records.data(), static_cast<std::streamsize>(records.size()));
+  if (!is) {
+    throw std::runtime_error("Unexpected end of checkpoint.");
+  }
+
+  std::vector<vCachedEdge> nodes{};
+  nodes.reserve(count);
+  const char* data = records.data();
+  for (std::uint64_t i = 0U; i < count; ++i) {
+    const auto v = take<Qubit>(data);
+    if (v >= dd.qubits()) {
+      throw std::invalid_argument(
+          "Checkpoint requires more qubits than the package provides.");
+    }
+    std::array<vCachedEdge, RADIX> edges{};
+    for (auto& edge : edges) {
+      const auto index = take<std::uint32_t>(data);
+      ComplexValue w{};
+      w.r = take<fp>(data);
+      w.i = take<fp>(data);
+      if (w.exactlyZero()) {
+        edge = vCachedEdge::zero();
+      } else if (index == 0U) {
+        edge = vCachedEdge::terminal(w);
+      } else if (index <= i) {
+        // the node itself may be normalized differently than when written
+        const auto& child = nodes[index - 1U];
+        edge = {child.p, child.w * w};
+      } else {
+        throw std::runtime_error("Corrupted node in checkpoint.");
+      }
+    }
+    nodes.emplace_back(dd.makeDDNode(v, edges));
+  }
+
+  if (nodes.empty()) {
+    checkpoint.state = rootWeight.exactlyZero()
+                           ? vEdge::zero()
+                           : vEdge::terminal(dd.cn.lookup(rootWeight));
+  } else {
+    const auto& top = nodes.back();
+    checkpoint.state = {top.p, dd.cn.lookup(top.w * rootWeight)};
+  }
+  return checkpoint;
+}
+
+template <class Config>
+std::map<std::string, std::size_t>
+simulateWithCheckpoints(const QuantumComputation* qc, const VectorDD& in,
+                        Package<Config>& dd, const std::size_t shots,
+                        const CheckpointConfig& config,
+                        const std::size_t seed) {
+  const auto analysis = analyzeMeasurements(qc);
+  checkCheckpointConfig(analysis, config);
+  SimulationCheckpoint checkpoint{in, 0U, qc->initialLayout,
+                                  makeGenerator(seed), fingerprintCircuit(*qc)};
+  dd.incRef(checkpoint.state);
+  return continueFromCheckpoint(qc, checkpoint, analysis, shots, config, dd);
+}
+
+template <class Config>
+std::map<std::string, std::size_t>
+resumeSimulation(const QuantumComputation* qc, Package<Config>& dd,
+                 const std::size_t shots, const CheckpointConfig& config) {
+  const auto analysis = analyzeMeasurements(qc);
+  checkCheckpointConfig(analysis, config);
+  std::ifstream ifs(config.filename, std::ios::binary);
+  if (!ifs.good()) {
+    throw std::invalid_argument("Cannot open checkpoint file: " +
+                                config.filename);
+  }
+  auto checkpoint = readCheckpoint(ifs, dd);
+  const auto& state = checkpoint.state;
+  const auto sameQubits =
+      std::equal(checkpoint.permutation.begin(), checkpoint.permutation.end(),
+                 qc->initialLayout.begin(), qc->initialLayout.end(),
+                 [](const auto& lhs, const auto& rhs) {
+                   return lhs.first == rhs.first;
+                 });
+  if (checkpoint.circuit != fingerprintCircuit(*qc) ||
+      checkpoint.position > qc->size() || !sameQubits ||
+      (!state.isTerminal() &&
+       static_cast<std::size_t>(state.p->v) + 1U != qc->getNqubits())) {
+    throw std::invalid_argument("Checkpoint does not match the circuit.");
+  }
+  dd.incRef(checkpoint.state);
+  return continueFromCheckpoint(qc, checkpoint, analysis, shots, config, dd);
 }
 
 template std::map<std::string, std::size_t>
 simulate<DDPackageConfig>(const QuantumComputation* qc, const VectorDD& in,
                           Package<DDPackageConfig>& dd, std::size_t shots,
                           std::size_t seed);
-template void extractProbabilityVector<DDPackageConfig>(
+template VectorDD
+simulateHybrid<DDPackageConfig>(const QuantumComputation* qc,
+                                const VectorDD& in,
+                                Package<DDPackageConfig>& dd,
+                                const HybridSimulationConfig& config);
+template std::map<std::string, std::size_t> simulateHybrid<DDPackageConfig>(
+    const QuantumComputation* qc, const VectorDD& in,
+    Package<DDPackageConfig>& dd, std::size_t shots, std::size_t seed,
+    const HybridSimulationConfig& config);
+template VectorDD approximateSimulate<DDPackageConfig>(
+    const QuantumComputation* qc, const VectorDD& in,
+    Package<DDPackageConfig>& dd, fp& fidelity,
+    const ApproximationConfig& config);
+template VectorDD simulateTimeEvolution<DDPackageConfig>(
+    const QuantumComputation* step, const VectorDD& in,
+    Package<DDPackageConfig>& dd, std::size_t steps,
+    const std::function<void(std::size_t, const VectorDD&)>& observer,
+    std::size_t stride);
+template std::vector<VectorDD> simulateSweep<DDPackageConfig>(
+    const QuantumComputation* qc, const VectorDD& in,
+    Package<DDPackageConfig>& dd,
+    const std::vector<VariableAssignment>& assignments, std::size_t nthreads);
+template SimulationCheckpoint
+readCheckpoint<DDPackageConfig>(std::istream& is,
+                                Package<DDPackageConfig>& dd);
+template std::map<std::string, std::size_t>
+simulateWithCheckpoints<DDPackageConfig>(const QuantumComputation* qc,
+                                         const VectorDD& in,
+                                         Package<DDPackageConfig>& dd,
+                                         std::size_t shots,
+                                         const CheckpointConfig& config,
+                                         std::size_t seed);
+template std::map<std::string, std::size_t> resumeSimulation<DDPackageConfig>(
+    const QuantumComputation* qc, Package<DDPackageConfig>& dd,
+    std::size_t shots, const CheckpointConfig& config);
+template fp extractProbabilityVector<DDPackageConfig>(
     const QuantumComputation* qc, const VectorDD& in, SparsePVec& probVector,
-    Package<DDPackageConfig>& dd);
+    Package<DDPackageConfig>& dd, fp pruneThreshold, std::size_t nthreads,
+    ProbabilityExtractionStats* stats);
 template void extractProbabilityVectorRecursive<DDPackageConfig>(
-    const QuantumComputation* qc, const VectorDD& in,
+    const QuantumComputation* qc, const VectorDD& currentState,
     decltype(qc->begin()) currentIt, Permutation& permutation,
     std::map<std::size_t, char> measurements, fp commonFactor,
     SparsePVec& probVector, Package<DDPackageConfig>& dd);
@@ -0,0 +1,100 @@
+#include "dd/statistics/Tracing.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+namespace dd {
+
+namespace {
+thread_local TraceBuffer* activeBuffer = nullptr;
+
+double toMicroseconds(const std::uint64_t ns) {
+  return static_cast<double>(ns) / 1000.;
+}
+} // namespace
+
+TraceBuffer::TraceBuffer(const std::size_t capacity)
+    : buffer(std::max<std::size_t>(capacity, 1U)) {}
+
+void TraceBuffer::record(TraceEvent event) {
+  buffer[next] = std::move(event);
+  next = (next + 1U) % buffer.size();
+  if (count < buffer.size()) {
+    ++count;
+  } else {
+    ++numDropped;
+  }
+}
+
+std::uint64_t TraceBuffer::since(const Clock::time_point time) const noexcept {
+  if (time <= origin) {
+    return 0U;
+  }
+  const auto elapsed =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(time - origin);
+  return static_cast<std::uint64_t>(elapsed.count());
+}
+
+std::vector<TraceEvent> TraceBuffer::events() const {
+  std::vector<TraceEvent> result{};
+  result.reserve(count);
+  const auto first = (next + buffer.size() - count) % buffer.size();
+  for (std::size_t i = 0U; i < count; ++i) {
+    result.emplace_back(buffer[(first + i) % buffer.size()]);
+  }
+  return result;
+}
+
+void TraceBuffer::clear() noexcept {
+  next = 0U;
+  count = 0U;
+  numDropped = 0U;
+  origin = Clock::now();
+}
+
+nlohmann::json TraceBuffer::chromeTrace() const {
+  auto traceEvents = nlohmann::json::array();
+  for (const auto& event : events()) {
+    nlohmann::json j{};
+    j["name"] = event.name;
+    j["cat"] = event.category;
+    j["ph"] = "X";
+    j["ts"] = toMicroseconds(event.start);
+    j["dur"] = toMicroseconds(event.duration);
+    j["pid"] = 0;
+    j["tid"] = 0;
+    if (event.category != "gc") {
+      j["args"] = {{"nodes", event.nodes},
+                   {"ct_lookups", event.lookups},
+                   {"ct_hits", event.hits},
+                   {"ct_misses", event.lookups - event.hits}};
+    }
+    traceEvents.emplace_back(std::move(j));
+  }
+  nlohmann::json trace{};
+  trace["traceEvents"] = std::move(traceEvents);
+  trace["displayTimeUnit"] = "ns";
+  trace["otherData"] = {{"dropped_events", numDropped}};
+  return trace;
+}
+
+void TraceBuffer::writeChromeTrace(std::ostream& os) const {
+  os << chromeTrace().dump();
+}
+
+TraceSession::TraceSession(TraceBuffer& buffer) noexcept
+    : previous(activeBuffer) {
+  activeBuffer = &buffer;
+}
+
+TraceSession::~TraceSession() { activeBuffer = previous; }
+
+TraceBuffer* TraceSession::active() noexcept { return activeBuffer; }
+
+} // namespace dd
@@ -37,6 +37,9 @@ def __flatten_dict(d: dict[Any, Any], parent_key: str = "", sep: str = ".") -> d
         new_key = f"{parent_key}{sep}{key}" if parent_key else key
         if isinstance(value, dict):
             items.update(__flatten_dict(value, new_key, sep=sep))
+        elif isinstance(value, list):
+            # logs (e.g., the decisions of the adaptive compute table sizing) are not comparable metrics
+            continue
         else:
             items[new_key] = value
     return items
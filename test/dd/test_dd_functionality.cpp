@@ -5,6 +5,7 @@
 #include "dd/Operations.hpp"
 #include "dd/Package.hpp"
 #include "dd/Simulation.hpp"
+#include "dd/statistics/Tracing.hpp"
 #include "ir/Permutation.hpp"
 #include "ir/QuantumComputation.hpp"
 #include "ir/operations/Control.hpp"
@@ -13,12 +14,19 @@
 
 #include <algorithm>
 #include <array>
+#include <cmath>
+#include <complex>
 #include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
 #include <gtest/gtest.h>
 #include <iostream>
 #include <memory>
+#include <nlohmann/json.hpp>
 #include <random>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -362,6 +370,100 @@ TEST_F(DDFunctionality, CircuitEquivalence) {
   EXPECT_EQ(dd1.p, dd2.p);
 }
 
+TEST_F(DDFunctionality, parallelFunctionalityConstruction) {
+  QuantumComputation qc(nqubits);
+  std::swap(qc.initialLayout[0], qc.initialLayout[1]);
+  for (Qubit layer = 0; layer < 4U; ++layer) {
+    for (Qubit q = 0; q < nqubits; ++q) {
+      qc.u(dist(mt), dist(mt), dist(mt), q);
+    }
+    qc.cx(layer, (layer + 1U) % 4U);
+    qc.swap(1, 3);
+    qc.rzz(dist(mt), 0, 2);
+  }
+  std::swap(qc.outputPermutation[0], qc.outputPermutation[2]);
+
+  const auto expected = buildFunctionality(&qc, *dd);
+  const auto reference = expected.getMatrix(nqubits);
+  for (const std::size_t nthreads : {1U, 2U, 3U, 8U}) {
+    const auto func = buildFunctionalityParallel(&qc, *dd, nthreads);
+    const auto matrix = func.getMatrix(nqubits);
+    for (std::size_t i = 0; i < matrix.size(); ++i) {
+      for (std::size_t j = 0; j < matrix.size(); ++j) {
+        EXPECT_NEAR(std::abs(matrix[i][j] - reference[i][j]), 0., 1e-10);
+      }
+    }
+    dd->decRef(func);
+  }
+  dd->decRef(expected);
+}
+
+TEST_F(DDFunctionality, alternatingEquivalenceChecking) {
+  nqubits = 7U;
+  dd = std::make_unique<dd::Package<>>(nqubits);
+  initialComplexCount = dd->cn.realCount();
+  // the size bound below is not guaranteed for every random circuit
+  mt.seed(0U); // NOLINT(cert-msc51-cpp)
+
+  QuantumComputation qc1(nqubits);
+  QuantumComputation qc2(nqubits);
+  const auto nq = static_cast<Qubit>(nqubits);
+  std::uniform_int_distribution<Qubit> qubit(0U, nq - 1U);
+  for (std::size_t layer = 0U; layer < 6U; ++layer) {
+    for (Qubit q = 0U; q < nq; ++q) {
+      const auto theta = dist(mt);
+      qc1.ry(theta, q);
+      qc2.ry(theta, q);
+    }
+    for (Qubit k = 0U; k < nq; ++k) {
+      const auto control = qubit(mt);
+      const auto target = (control + 1U + (qubit(mt) % (nq - 1U))) % nq;
+      qc1.cx(control, target);
+      // CX = (I ⊗ H) CZ (I ⊗ H)
+      qc2.h(target);
+      qc2.cz(control, target);
+      qc2.h(target);
+    }
+  }
+  // the second circuit additionally permutes its outputs
+  qc2.swap(0, 5);
+  std::swap(qc2.outputPermutation[0], qc2.outputPermutation[5]);
+
+  const auto functionality = buildFunctionality(&qc1, *dd);
+  const auto functionalitySize = functionality.size();
+  dd->decRef(functionality);
+  dd->garbageCollect(true);
+
+  for (const auto strategy : {dd::EquivalenceCheckingStrategy::Naive,
+                              dd::EquivalenceCheckingStrategy::OneToOne,
+                              dd::EquivalenceCheckingStrategy::Proportional,
+                              dd::EquivalenceCheckingStrategy::Lookahead}) {
+    const auto result = dd::checkEquivalence(&qc1, &qc2, *dd, {strategy});
+    EXPECT_TRUE(result.equivalent);
+    if (strategy == dd::EquivalenceCheckingStrategy::Proportional ||
+        strategy == dd::EquivalenceCheckingStrategy::Lookahead) {
+      // the miter stays close to the identity
+      EXPECT_LT(100U * result.peakNodes, functionalitySize);
+    }
+  }
+
+  // a single additional phase makes the circuits non-equivalent
+  qc2.t(3);
+  for (const auto strategy : {dd::EquivalenceCheckingStrategy::Proportional,
+                              dd::EquivalenceCheckingStrategy::Lookahead}) {
+    EXPECT_FALSE(dd::checkEquivalence(&qc1, &qc2, *dd, {strategy}).equivalent);
+  }
+
+  // a global phase does not matter
+  qc2.tdg(3);
+  qc2.gphase(dd::PI_4);
+  EXPECT_TRUE(dd::checkEquivalence(&qc1, &qc2, *dd).equivalent);
+
+  const QuantumComputation smaller(nqubits - 1U);
+  EXPECT_THROW(dd::checkEquivalence(&qc1, &smaller, *dd),
+               std::invalid_argument);
+}
+
 TEST_F(DDFunctionality, changePermutation) {
   const std::string testfile = "// o 1 0\n"
                                "OPENQASM 2.0;"
@@ -385,6 +487,408 @@ TEST_F(DDFunctionality, changePermutation) {
   EXPECT_TRUE(func.p->e[3].p->e[2].w.exactlyOne());
 }
 
+TEST_F(DDFunctionality, changePermutationBeyondState) {
+  // a two-qubit state |01> in a package for four qubits
+  auto state = dd->makeBasisState(2U, std::vector<bool>{true, false});
+  dd->incRef(state);
+
+  // swapping two qubits above the state leaves it untouched
+  qc::Permutation from{};
+  for (Qubit q = 0U; q < nqubits; ++q) {
+    from[q] = q;
+  }
+  qc::Permutation to = from;
+  std::swap(to[2], to[3]);
+  changePermutation(state, from, to, *dd);
+  EXPECT_EQ(from, to);
+  EXPECT_EQ(state.p->v, 1U);
+  EXPECT_EQ(state.getValueByIndex(1U), std::complex<dd::fp>{1.});
+
+  // moving a qubit of the state above it extends the state by |0> qubits
+  to = from;
+  std::swap(to[0], to[2]);
+  changePermutation(state, from, to, *dd);
+  EXPECT_EQ(from, to);
+  EXPECT_EQ(state.p->v, 3U);
+  const auto amplitudes = state.getVector();
+  for (std::size_t i = 0U; i < amplitudes.size(); ++i) {
+    EXPECT_EQ(amplitudes[i], std::complex<dd::fp>(i == 8U ? 1. : 0.));
+  }
+  dd->decRef(state);
+}
+
+TEST_F(DDFunctionality, dynamicCircuitSimulation) {
+  QuantumComputation qc(2U, 3U);
+  qc.h(0);
+  qc.measure(0, 0);
+  qc.classicControlled(qc::X, 1, {0, 1U}, 1U);
+  qc.measure(1, 1);
+  qc.reset(0);
+  qc.measure(0, 2);
+
+  constexpr std::size_t shots = 4096U;
+  const auto counts =
+      simulate(&qc, dd->makeZeroState(qc.getNqubits()), *dd, shots, 42U);
+  ASSERT_EQ(counts.size(), 2U);
+  EXPECT_EQ(counts.at("000") + counts.at("011"), shots);
+  EXPECT_NEAR(static_cast<double>(counts.at("011")) / shots, 0.5, 0.05);
+
+  // the same seed yields the same outcome
+  EXPECT_EQ(counts,
+            simulate(&qc, dd->makeZeroState(qc.getNqubits()), *dd, shots, 42U));
+}
+
+TEST_F(DDFunctionality, hybridSimulation) {
+  QuantumComputation qc(nqubits);
+  qc.initialLayout[0] = 1;
+  qc.initialLayout[1] = 0;
+  for (Qubit q = 0; q < nqubits; ++q) {
+    qc.h(q);
+    qc.rz(dist(mt), q);
+  }
+  qc.cx(qc::Control{2, qc::Control::Type::Neg}, 0);
+  qc.cswap(3, 0, 1);
+  qc.dcx(2, 1);
+  qc.rxx(dist(mt), 3, 0);
+  qc.swap(0, 2);
+  qc.gphase(dist(mt));
+  qc.u(dist(mt), dist(mt), dist(mt), 1);
+  qc.mcx({1, 2}, 3);
+  qc.ecr(1, 3);
+
+  const auto reference =
+      simulate(&qc, dd->makeZeroState(qc.getNqubits()), *dd);
+
+  // always dense, always switching back, and the default
+  for (const auto& config : {dd::HybridSimulationConfig{0., 0., 1U},
+                             dd::HybridSimulationConfig{0., 1., 1U},
+                             dd::HybridSimulationConfig{}}) {
+    const auto state = dd::simulateHybrid(
+        &qc, dd->makeZeroState(qc.getNqubits()), *dd, config);
+    EXPECT_NEAR(dd->fidelity(reference, state), 1., 1e-10);
+    EXPECT_TRUE(state.w.approximatelyEquals(reference.w));
+    dd->decRef(state);
+  }
+  dd->decRef(reference);
+}
+
+TEST_F(DDFunctionality, hybridSimulationSkipsHopelessRecompression) {
+  QuantumComputation qc(nqubits);
+  for (std::size_t layer = 0U; layer < 16U; ++layer) {
+    for (Qubit q = 0; q < nqubits; ++q) {
+      qc.u(dist(mt), dist(mt), dist(mt), q);
+    }
+    qc.cx(0, 1);
+    qc.cx(2, 3);
+  }
+  const auto reference =
+      simulate(&qc, dd->makeZeroState(qc.getNqubits()), *dd);
+
+  // always dense and checking after every operation, but the random state
+  // never gets compact enough to return to the DD
+  const auto lookups = [this]() {
+    return dd->vUniqueTable.getStats(0).lookups;
+  };
+  const auto before = lookups();
+  const auto state = dd::simulateHybrid(
+      &qc, dd->makeZeroState(qc.getNqubits()), *dd,
+      dd::HybridSimulationConfig{0., 1. / 1024., 1U});
+  // only the first operation and the final conversion touch the lowest level
+  // of the unique table, instead of a recompression after every operation
+  EXPECT_LT(lookups() - before, 4U * (1ULL << (nqubits - 1U)));
+  EXPECT_NEAR(dd->fidelity(reference, state), 1., 1e-10);
+  dd->decRef(state);
+  dd->decRef(reference);
+}
+
+TEST_F(DDFunctionality, hybridSimulationCounts) {
+  QuantumComputation qc(3U, 3U);
+  qc.h(0);
+  qc.cx(0, 1);
+  qc.cx(1, 2);
+  qc.measure(0, 2);
+  qc.measure(1, 1);
+  qc.measure(2, 0);
+
+  constexpr std::size_t shots = 1024U;
+  const auto counts = dd::simulateHybrid(
+      &qc, dd->makeZeroState(qc.getNqubits()), *dd, shots, 42U,
+      dd::HybridSimulationConfig{0., 0., 1U});
+  ASSERT_EQ(counts.size(), 2U);
+  EXPECT_EQ(counts.at("000") + counts.at("111"), shots);
+  EXPECT_EQ(counts,
+            simulate(&qc, dd->makeZeroState(qc.getNqubits()), *dd, shots, 42U));
+}
+
+TEST_F(DDFunctionality, approximateSimulation) {
+  QuantumComputation qc(nqubits);
+  for (Qubit q = 0; q < nqubits; ++q) {
+    qc.ry(0.1, q);
+  }
+  for (Qubit q = 1; q < nqubits; ++q) {
+    qc.cx(q - 1, q);
+    qc.rz(dist(mt), q);
+  }
+
+  const auto exact = simulate(&qc, dd->makeZeroState(qc.getNqubits()), *dd);
+
+  // without exceeding the node limit, the simulation is exact
+  dd::fp fidelity = 0.;
+  auto state = dd::approximateSimulate(
+      &qc, dd->makeZeroState(qc.getNqubits()), *dd, fidelity);
+  EXPECT_EQ(fidelity, 1.);
+  EXPECT_EQ(state.p, exact.p);
+  dd->decRef(state);
+
+  const auto config = dd::ApproximationConfig{1U, 0.05, 1e-2};
+  state = dd::approximateSimulate(&qc, dd->makeZeroState(qc.getNqubits()),
+                                  *dd, fidelity, config);
+  EXPECT_LT(fidelity, 1.);
+  EXPECT_GE(fidelity, 1. - config.fidelityBudget);
+  EXPECT_LT(state.size(), exact.size());
+  EXPECT_NEAR(dd->fidelity(exact, state), fidelity, 1e-6);
+  dd->decRef(state);
+
+  // a threshold removing the entire state is lowered instead of aborting
+  const auto coarse = dd::ApproximationConfig{1U, 0.05, 2., 1U};
+  state = dd::approximateSimulate(&qc, dd->makeZeroState(qc.getNqubits()),
+                                  *dd, fidelity, coarse);
+  EXPECT_LT(fidelity, 1.);
+  EXPECT_GE(fidelity, 1. - coarse.fidelityBudget);
+  EXPECT_NEAR(dd->fidelity(exact, state), fidelity, 1e-6);
+  dd->decRef(state);
+  dd->decRef(exact);
+}
+
+TEST_F(DDFunctionality, timeEvolution) {
+  // a Trotter step of a transverse-field Ising chain
+  QuantumComputation step(nqubits);
+  for (Qubit q = 1; q < nqubits; ++q) {
+    step.rzz(0.1, q - 1, q);
+  }
+  for (Qubit q = 0; q < nqubits; ++q) {
+    step.rx(0.2, q);
+  }
+  constexpr std::size_t steps = 11U;
+  const auto observable = dd::WeightedPauliSum{{1., dd::makePauliString("Z")}};
+
+  // reference: gate-by-gate simulation of every step
+  std::vector<dd::fp> expected{};
+  auto reference = dd->makeZeroState(nqubits);
+  dd->incRef(reference);
+  for (std::size_t i = 0; i < steps; ++i) {
+    const auto next = simulate(&step, reference, *dd);
+    dd->decRef(reference);
+    reference = next;
+    expected.emplace_back(dd->expectationValue(observable, reference));
+  }
+
+  for (const std::size_t stride : {1U, 4U}) {
+    std::vector<std::size_t> observed{};
+    const auto state = dd::simulateTimeEvolution(
+        &step, dd->makeZeroState(nqubits), *dd, steps,
+        [&](const std::size_t applied, const qc::VectorDD& current) {
+          observed.emplace_back(applied);
+          EXPECT_NEAR(dd->expectationValue(observable, current),
+                      expected[applied - 1U], 1e-8);
+        },
+        stride);
+    EXPECT_EQ(observed.size(), (steps + stride - 1U) / stride);
+    EXPECT_EQ(observed.back(), steps);
+    EXPECT_NEAR(dd->fidelity(state, reference), 1., 1e-8);
+    dd->decRef(state);
+  }
+  dd->decRef(reference);
+}
+
+TEST_F(DDFunctionality, parameterSweep) {
+  const sym::Variable x{"x"};
+  const sym::Variable y{"y"};
+  QuantumComputation qc(nqubits);
+  for (Qubit q = 0; q < nqubits; ++q) {
+    qc.h(q);
+  }
+  for (Qubit q = 1; q < nqubits; ++q) {
+    qc.cx(q - 1, q);
+  }
+  qc.rz(qc::Symbolic(sym::Term{x, 1.0}), 0);
+  qc.cx(0, 2);
+  qc.ry(qc::Symbolic(sym::Term{y, 2.0}), 1);
+  qc.rzz(qc::Symbolic(sym::Term{x, -0.5}), 1, 3);
+
+  std::vector<VariableAssignment> assignments{};
+  for (std::size_t i = 0; i < 5U; ++i) {
+    assignments.push_back({{x, dist(mt)}, {y, dist(mt)}});
+  }
+
+  for (const std::size_t nthreads : {1U, 2U}) {
+    const auto states = dd::simulateSweep(
+        &qc, dd->makeZeroState(nqubits), *dd, assignments, nthreads);
+    ASSERT_EQ(states.size(), assignments.size());
+    for (std::size_t i = 0; i < assignments.size(); ++i) {
+      const auto instance = qc.instantiate(assignments[i]);
+      const auto expected =
+          simulate(&instance, dd->makeZeroState(nqubits), *dd);
+      EXPECT_NEAR(dd->fidelity(states[i], expected), 1., 1e-10);
+      dd->decRef(expected);
+      dd->decRef(states[i]);
+    }
+  }
+}
+
+TEST_F(DDFunctionality, simulationCheckpoints) {
+  QuantumComputation qc(nqubits, nqubits);
+  for (Qubit q = 0; q < nqubits; ++q) {
+    qc.ry(dist(mt), q);
+  }
+  qc.cx(0, 1);
+  qc.swap(1, 2);
+  qc.cz(2, 3);
+  qc.rx(dist(mt), 3);
+  qc.cx(3, 0);
+  qc.measureAll(false);
+
+  constexpr std::size_t shots = 1024U;
+  constexpr std::size_t seed = 42U;
+  const dd::CheckpointConfig config{"simulation_checkpoint_test.bin", 0.};
+  const auto expected =
+      simulate(&qc, dd->makeZeroState(nqubits), *dd, shots, seed);
+
+  // a snapshot is taken after every operation
+  EXPECT_EQ(dd::simulateWithCheckpoints(&qc, dd->makeZeroState(nqubits), *dd,
+                                        shots, config, seed),
+            expected);
+  // resuming from the final snapshot only repeats the sampling
+  EXPECT_EQ(dd::resumeSimulation(&qc, *dd, shots, config), expected);
+
+  // simulate a preemption after half of the circuit
+  dd::SimulationCheckpoint checkpoint{dd->makeZeroState(nqubits), 0U,
+                                      qc.initialLayout, std::mt19937_64{seed},
+                                      dd::fingerprintCircuit(qc)};
+  auto& state = checkpoint.state;
+  dd->incRef(state);
+  for (; checkpoint.position < qc.size() / 2U; ++checkpoint.position) {
+    auto tmp = dd->multiply(
+        getDD(qc.at(checkpoint.position).get(), *dd, checkpoint.permutation),
+        state);
+    dd->incRef(tmp);
+    dd->decRef(state);
+    state = tmp;
+  }
+
+  std::stringstream ss{};
+  dd::writeCheckpoint(ss, checkpoint);
+  const auto restored = dd::readCheckpoint(ss, *dd);
+  EXPECT_EQ(restored.position, checkpoint.position);
+  EXPECT_EQ(restored.permutation, checkpoint.permutation);
+  EXPECT_EQ(restored.mt, checkpoint.mt);
+  EXPECT_EQ(restored.circuit, checkpoint.circuit);
+  EXPECT_NEAR(dd->fidelity(restored.state, state), 1., 1e-10);
+  EXPECT_EQ(restored.state.size(), state.size());
+
+  {
+    std::ofstream ofs(config.filename, std::ios::binary);
+    dd::writeCheckpoint(ofs, checkpoint);
+  }
+  dd->decRef(state);
+  EXPECT_EQ(dd::resumeSimulation(&qc, *dd, shots, config), expected);
+
+  // the snapshot cannot be used for another circuit
+  auto other = qc;
+  other.rz(0.5, 0);
+  EXPECT_THROW(dd::resumeSimulation(&other, *dd, shots, config),
+               std::invalid_argument);
+  QuantumComputation wider(nqubits + 1U, nqubits + 1U);
+  for (const auto& op : qc) {
+    wider.emplace_back(op->clone());
+  }
+  EXPECT_THROW(dd::resumeSimulation(&wider, *dd, shots, config),
+               std::invalid_argument);
+  std::remove(config.filename.c_str());
+
+  // the snapshots need a file to be written to
+  auto unnamed = config;
+  unnamed.filename.clear();
+  EXPECT_THROW(dd::simulateWithCheckpoints(&qc, dd->makeZeroState(nqubits),
+                                           *dd, shots, unnamed, seed),
+               std::invalid_argument);
+  EXPECT_THROW(dd::resumeSimulation(&qc, *dd, shots, unnamed),
+               std::invalid_argument);
+
+  // dynamic circuits cannot be checkpointed
+  qc.h(0);
+  EXPECT_THROW(dd::simulateWithCheckpoints(&qc, dd->makeZeroState(nqubits),
+                                           *dd, shots, config, seed),
+               std::invalid_argument);
+}
+
+TEST_F(DDFunctionality, probabilityExtraction) {
+  // after the reset, both branches of the first measurement reach the same
+  // state, so the second half of the circuit is only explored once
+  QuantumComputation qc(2U, 3U);
+  qc.ry(2. * std::asin(std::sqrt(0.1)), 0);
+  qc.measure(0, 0);
+  qc.reset(0);
+  qc.h(0);
+  qc.measure(0, 1);
+  qc.classicControlled(qc::X, 1, {1, 1U}, 1U);
+  qc.measure(1, 2);
+
+  for (const std::size_t nthreads : {1U, 2U}) {
+    dd::SparsePVec probs{};
+    dd::ProbabilityExtractionStats stats{};
+    const auto discarded =
+        extractProbabilityVector(&qc, dd->makeZeroState(qc.getNqubits()),
+                                 probs, *dd, 0., nthreads, &stats);
+    EXPECT_NEAR(discarded, 0., 1e-12);
+    if (nthreads == 1U) {
+      // one branch at the first, one (shared) at the second and two at the
+      // last measurement
+      EXPECT_EQ(stats.explored, 4U);
+      EXPECT_EQ(stats.reused, 1U);
+    }
+    ASSERT_EQ(probs.size(), 4U);
+    EXPECT_NEAR(probs.at(0b000), 0.45, 1e-8);
+    EXPECT_NEAR(probs.at(0b110), 0.45, 1e-8);
+    EXPECT_NEAR(probs.at(0b001), 0.05, 1e-8);
+    EXPECT_NEAR(probs.at(0b111), 0.05, 1e-8);
+
+    // the branch of the unlikely first outcome is pruned
+    probs.clear();
+    const auto pruned = extractProbabilityVector(
+        &qc, dd->makeZeroState(qc.getNqubits()), probs, *dd, 0.2, nthreads);
+    EXPECT_NEAR(pruned, 0.1, 1e-8);
+    ASSERT_EQ(probs.size(), 2U);
+    EXPECT_NEAR(probs.at(0b000), 0.45, 1e-8);
+    EXPECT_NEAR(probs.at(0b110), 0.45, 1e-8);
+  }
+}
+
+TEST_F(DDFunctionality, probabilityExtractionPrunesByPath) {
+  // both outcomes of the first measurement reach the same state after the
+  // reset, first via the unlikely outcome 0 and then via the likely outcome 1
+  QuantumComputation qc(1U, 2U);
+  qc.ry(2. * std::asin(std::sqrt(0.9)), 0);
+  qc.measure(0, 0);
+  qc.reset(0);
+  qc.ry(2. * std::asin(std::sqrt(0.3)), 0);
+  qc.measure(0, 1);
+
+  dd::SparsePVec probs{};
+  dd::ProbabilityExtractionStats stats{};
+  const auto discarded = extractProbabilityVector(
+      &qc, dd->makeZeroState(qc.getNqubits()), probs, *dd, 0.05, 1U, &stats);
+  // only the outcome with probability 0.1 * 0.3 falls below the threshold
+  EXPECT_NEAR(discarded, 0.03, 1e-8);
+  ASSERT_EQ(probs.size(), 3U);
+  EXPECT_NEAR(probs.at(0b00), 0.07, 1e-8);
+  EXPECT_NEAR(probs.at(0b01), 0.63, 1e-8);
+  EXPECT_NEAR(probs.at(0b11), 0.27, 1e-8);
+  // the second measurement is explored again for the more likely path
+  EXPECT_EQ(stats.explored, 3U);
+  EXPECT_EQ(stats.reused, 0U);
+}
+
 TEST_F(DDFunctionality, basicTensorDumpTest) {
   QuantumComputation qc(2);
   qc.h(1);
@@ -514,3 +1018,125 @@ TEST_F(DDFunctionality, FuseSingleQubitGatesAcrossOtherGates) {
   EXPECT_EQ(qc.getNops(), 2);
   EXPECT_EQ(e, f);
 }
+
+TEST(DDTracing, RingBufferKeepsNewestEvents) {
+  dd::TraceBuffer buffer(3U);
+  for (std::uint64_t i = 0U; i < 5U; ++i) {
+    buffer.record({"op" + std::to_string(i), "operation", i * 1000U, 500U,
+                   i + 1U, 4U, 3U});
+  }
+  EXPECT_EQ(buffer.size(), 3U);
+  EXPECT_EQ(buffer.dropped(), 2U);
+
+  const auto events = buffer.events();
+  ASSERT_EQ(events.size(), 3U);
+  EXPECT_EQ(events.front().name, "op2");
+  EXPECT_EQ(events.back().name, "op4");
+
+  const auto trace = buffer.chromeTrace();
+  ASSERT_EQ(trace["traceEvents"].size(), 3U);
+  const auto& first = trace["traceEvents"][0];
+  EXPECT_EQ(first["ph"], "X");
+  EXPECT_DOUBLE_EQ(first["ts"].get<double>(), 2.);
+  EXPECT_DOUBLE_EQ(first["dur"].get<double>(), .5);
+  EXPECT_EQ(first["args"]["nodes"], 3U);
+  EXPECT_EQ(first["args"]["ct_misses"], 1U);
+  EXPECT_EQ(trace["otherData"]["dropped_events"], 2U);
+
+  std::stringstream ss;
+  buffer.writeChromeTrace(ss);
+  EXPECT_EQ(nlohmann::json::parse(ss.str()), trace);
+
+  buffer.clear();
+  EXPECT_EQ(buffer.size(), 0U);
+  EXPECT_TRUE(buffer.events().empty());
+}
+
+TEST_F(DDFunctionality, TraceFunctionalityConstruction) {
+  QuantumComputation qc(nqubits);
+  qc.h(0);
+  for (Qubit q = 1U; q < nqubits; ++q) {
+    qc.cx(0, q);
+  }
+
+  dd::TraceBuffer buffer{};
+  {
+    const dd::TraceSession session(buffer);
+    EXPECT_EQ(dd::TraceSession::active(), &buffer);
+    e = buildFunctionality(&qc, *dd);
+  }
+  EXPECT_EQ(dd::TraceSession::active(), nullptr);
+
+  if constexpr (!dd::TRACING_ENABLED) {
+    // the instrumentation is compiled out
+    EXPECT_EQ(buffer.size(), 0U);
+    return;
+  }
+  const auto events = buffer.events();
+  ASSERT_EQ(events.size(), qc.getNops());
+  for (std::size_t i = 0U; i < events.size(); ++i) {
+    EXPECT_EQ(events[i].name, qc.at(i)->getName());
+    EXPECT_EQ(events[i].category, "operation");
+    EXPECT_GT(events[i].nodes, 0U);
+    EXPECT_LE(events[i].hits, events[i].lookups);
+    if (i > 0U) {
+      EXPECT_GE(events[i].start, events[i - 1U].start);
+    }
+  }
+  EXPECT_EQ(events.back().nodes, e.size());
+
+  const auto trace = buffer.chromeTrace();
+  const auto& traceEvents = trace["traceEvents"];
+  ASSERT_EQ(traceEvents.size(), events.size());
+  for (std::size_t i = 0U; i < events.size(); ++i) {
+    EXPECT_EQ(traceEvents[i]["name"], events[i].name);
+    EXPECT_EQ(traceEvents[i]["cat"], "operation");
+    EXPECT_EQ(traceEvents[i]["ph"], "X");
+    EXPECT_EQ(traceEvents[i]["args"]["nodes"], events[i].nodes);
+    EXPECT_EQ(traceEvents[i]["args"]["ct_misses"],
+              events[i].lookups - events[i].hits);
+  }
+  EXPECT_EQ(trace["otherData"]["dropped_events"], 0U);
+}
+
+TEST_F(DDFunctionality, TraceSimulation) {
+  QuantumComputation qc(nqubits);
+  qc.h(0);
+  for (Qubit q = 1U; q < nqubits; ++q) {
+    qc.cx(q - 1, q);
+  }
+
+  dd::TraceBuffer buffer{};
+  qc::VectorDD out{};
+  {
+    const dd::TraceSession session(buffer);
+    out = simulate(&qc, dd->makeZeroState(nqubits), *dd);
+  }
+  EXPECT_NEAR(std::norm(out.getValueByIndex(0U)), 0.5, 1e-9);
+
+  if constexpr (!dd::TRACING_ENABLED) {
+    EXPECT_EQ(buffer.size(), 0U);
+    return;
+  }
+  std::vector<dd::TraceEvent> operations{};
+  for (const auto& event : buffer.events()) {
+    if (event.category == "operation") {
+      operations.emplace_back(event);
+    }
+  }
+  ASSERT_EQ(operations.size(), qc.getNops());
+  for (std::size_t i = 0U; i < operations.size(); ++i) {
+    EXPECT_EQ(operations[i].name, qc.at(i)->getName());
+  }
+  EXPECT_EQ(operations.back().nodes, out.size());
+
+  std::stringstream ss;
+  buffer.writeChromeTrace(ss);
+  const auto trace = nlohmann::json::parse(ss.str());
+  ASSERT_EQ(trace["traceEvents"].size(), buffer.size());
+  EXPECT_EQ(trace["displayTimeUnit"], "ns");
+  for (const auto& event : trace["traceEvents"]) {
+    EXPECT_EQ(event["ph"], "X");
+    EXPECT_GE(event["dur"].get<double>(), 0.);
+  }
+}
@@ -4,6 +4,7 @@
 #include "dd/NoiseFunctionality.hpp"
 #include "dd/Operations.hpp"
 #include "dd/Package.hpp"
+#include "dd/Simulation.hpp"
 #include "ir/QuantumComputation.hpp"
 #include "ir/operations/OpType.hpp"
 
@@ -16,8 +17,10 @@
 #include <gtest/gtest.h>
 #include <map>
 #include <memory>
+#include <set>
 #include <stdexcept>
 #include <utility>
+#include <vector>
 
 using namespace qc;
 
@@ -130,6 +133,219 @@ TEST_F(DDNoiseFunctionalityTest, DetSimulateAdder4TrackD) {
   }
 }
 
+TEST_F(DDNoiseFunctionalityTest, DetSimulateAdder4LayerNoise) {
+  const auto layers = dd::groupIntoDisjointLayers(qc);
+  ASSERT_LT(layers.size(), qc.size());
+
+  auto dd = std::make_unique<DensityMatrixTestPackage>(qc.getNqubits());
+  auto noise = dd::DeterministicNoiseFunctionality(
+      dd, qc.getNqubits(), 0.01, 0.02, 0.02, 0.04, "APDI");
+
+  auto perOperation = dd->makeZeroDensityOperator(qc.getNqubits());
+  dd->incRef(perOperation);
+  auto batched = dd->makeZeroDensityOperator(qc.getNqubits());
+  dd->incRef(batched);
+  for (const auto& layer : layers) {
+    std::vector<std::set<Qubit>> usedQubits{};
+    for (const auto i : layer) {
+      const auto& op = qc.at(i);
+      dd->applyOperationToDensity(perOperation, dd::getDD(op.get(), *dd));
+      noise.applyNoiseEffects(perOperation, op);
+      dd->applyOperationToDensity(batched, dd::getDD(op.get(), *dd));
+      usedQubits.emplace_back(op->getUsedQubits());
+    }
+    noise.applyNoiseEffects(batched, usedQubits);
+  }
+  EXPECT_GT(dd->densityNoise.getStats().hits, 0U);
+
+  const auto expected =
+      perOperation.getSparseProbabilityVectorStrKeys(qc.getNqubits());
+  auto actual = batched.getSparseProbabilityVectorStrKeys(qc.getNqubits());
+  ASSERT_EQ(expected.size(), actual.size());
+  for (const auto& [state, prob] : expected) {
+    EXPECT_NEAR(actual[state], prob, 1e-10);
+  }
+
+  EXPECT_THROW(noise.applyNoiseEffects(batched, {{0U, 1U}, {1U, 2U}}),
+               std::invalid_argument);
+}
+
+TEST_F(DDNoiseFunctionalityTest, DetSimulateAdder4KrausChannels) {
+  auto model = dd::KrausNoiseModel{};
+  for (Qubit q = 0U; q < qc.getNqubits(); ++q) {
+    model.qubitChannels[q] = {dd::KrausChannel::amplitudeDamping(0.02),
+                              dd::KrausChannel::phaseFlip(0.01),
+                              dd::KrausChannel::depolarization(0.01)};
+  }
+
+  auto dd = std::make_unique<DensityMatrixTestPackage>(qc.getNqubits());
+  auto kraus = dd::KrausNoiseFunctionality(dd, qc.getNqubits(), model);
+  auto deterministic = dd::DeterministicNoiseFunctionality(
+      dd, qc.getNqubits(), 0.01, 0.01, 0.02, 0.02, "APD");
+
+  auto expected = dd->makeZeroDensityOperator(qc.getNqubits());
+  dd->incRef(expected);
+  auto actual = dd->makeZeroDensityOperator(qc.getNqubits());
+  dd->incRef(actual);
+  for (auto const& op : qc) {
+    dd->applyOperationToDensity(expected, dd::getDD(op.get(), *dd));
+    deterministic.applyNoiseEffects(expected, op);
+    dd->applyOperationToDensity(actual, dd::getDD(op.get(), *dd));
+    kraus.applyNoiseEffects(actual, op);
+  }
+
+  const auto reference =
+      expected.getSparseProbabilityVectorStrKeys(qc.getNqubits());
+  auto probabilities =
+      actual.getSparseProbabilityVectorStrKeys(qc.getNqubits());
+  ASSERT_EQ(reference.size(), probabilities.size());
+  for (const auto& [state, prob] : reference) {
+    EXPECT_NEAR(probabilities[state], prob, 1e-10);
+  }
+
+  // applying a channel to the same density matrix again hits the cache
+  const auto channel = dd::KrausChannel::bitFlip(0.1);
+  auto first = actual;
+  dd::dEdge::alignDensityEdge(first);
+  dd->incRef(first);
+  dd::dEdge::setDensityMatrixTrue(first);
+  kraus.applyChannel(first, channel, {1U});
+  const auto hits = dd->densityChannel.getStats().hits;
+  kraus.applyChannel(actual, channel, {1U});
+  EXPECT_EQ(dd->densityChannel.getStats().hits, hits + 1U);
+  EXPECT_EQ(first, actual);
+}
+
+TEST_F(DDNoiseFunctionalityTest, DetSimulateCorrelatedKrausChannel) {
+  constexpr auto p = 0.1;
+  const auto keep = std::sqrt(1. - p);
+  const auto flip = std::sqrt(p);
+  auto correlatedFlip = dd::KrausChannel{};
+  correlatedFlip.twoQubitOperators.emplace_back();
+  correlatedFlip.twoQubitOperators.emplace_back();
+  for (std::size_t i = 0U; i < dd::NEDGE; ++i) {
+    correlatedFlip.twoQubitOperators[0][i][i] = keep;
+    correlatedFlip.twoQubitOperators[1][i][dd::NEDGE - 1U - i] = flip;
+  }
+  EXPECT_TRUE(correlatedFlip.isTracePreserving());
+  EXPECT_TRUE(
+      dd::KrausChannel::twoQubitDepolarization(0.3).isTracePreserving());
+
+  auto model = dd::KrausNoiseModel{};
+  model.gateChannels[qc::X] = {correlatedFlip};
+
+  auto circuit = QuantumComputation(2U);
+  circuit.cx(0, 1);
+  auto dd = std::make_unique<DensityMatrixTestPackage>(circuit.getNqubits());
+  auto kraus = dd::KrausNoiseFunctionality(dd, circuit.getNqubits(), model);
+  auto rho = dd->makeZeroDensityOperator(circuit.getNqubits());
+  dd->incRef(rho);
+  for (auto const& op : circuit) {
+    dd->applyOperationToDensity(rho, dd::getDD(op.get(), *dd));
+    kraus.applyNoiseEffects(rho, op);
+  }
+  auto probabilities =
+      rho.getSparseProbabilityVectorStrKeys(circuit.getNqubits());
+  EXPECT_NEAR(probabilities["00"], 1. - p, 1e-10);
+  EXPECT_NEAR(probabilities["11"], p, 1e-10);
+  EXPECT_NEAR(probabilities["01"], 0., 1e-10);
+  EXPECT_NEAR(probabilities["10"], 0., 1e-10);
+
+  // two-qubit channels need operations on two qubits
+  circuit.x(0);
+  EXPECT_THROW(kraus.applyNoiseEffects(rho, circuit.back()),
+               std::invalid_argument);
+
+  auto invalid = dd::KrausNoiseModel{};
+  invalid.qubitChannels[0] = {
+      dd::KrausChannel{{dd::GateMatrix{1, 0, 0, 0}}, {}}};
+  EXPECT_THROW(dd::KrausNoiseFunctionality(dd, 2U, invalid),
+               std::invalid_argument);
+  invalid.qubitChannels.clear();
+  invalid.qubitChannels[2] = {dd::KrausChannel::bitFlip(0.1)};
+  EXPECT_THROW(dd::KrausNoiseFunctionality(dd, 2U, invalid),
+               std::invalid_argument);
+}
+
+TEST_F(DDNoiseFunctionalityTest, KrausChannelsMatchDenseConjugation) {
+  constexpr std::size_t nq = 2U;
+  constexpr std::size_t dim = 1U << nq;
+  auto circuit = QuantumComputation(nq);
+  circuit.h(0);
+  circuit.cx(0, 1);
+  circuit.ry(0.7, 1);
+  circuit.t(0);
+
+  auto dd = std::make_unique<DensityMatrixTestPackage>(nq);
+  auto kraus = dd::KrausNoiseFunctionality(dd, nq, {});
+  auto rho = dd->makeZeroDensityOperator(nq);
+  dd->incRef(rho);
+  for (auto const& op : circuit) {
+    dd->applyOperationToDensity(rho, dd::getDD(op.get(), *dd));
+  }
+
+  // sum_k K_k rho K_k^dagger computed on dense matrices
+  const auto conjugate = [](const dd::CMat& r,
+                            const std::vector<dd::CMat>& operators) {
+    dd::CMat result(dim, dd::CVec(dim, 0.));
+    for (const auto& k : operators) {
+      for (std::size_t i = 0U; i < dim; ++i) {
+        for (std::size_t j = 0U; j < dim; ++j) {
+          for (std::size_t a = 0U; a < dim; ++a) {
+            for (std::size_t b = 0U; b < dim; ++b) {
+              result[i][j] += k[i][a] * r[a][b] * std::conj(k[j][b]);
+            }
+          }
+        }
+      }
+    }
+    return result;
+  };
+  const auto expectEqual = [](const dd::CMat& expected,
+                              const dd::CMat& actual) {
+    for (std::size_t i = 0U; i < dim; ++i) {
+      for (std::size_t j = 0U; j < dim; ++j) {
+        EXPECT_NEAR(std::abs(expected[i][j] - actual[i][j]), 0., 1e-10)
+            << "entry (" << i << ", " << j << ")";
+      }
+    }
+  };
+
+  const auto damping = dd::KrausChannel::amplitudeDamping(0.3);
+  std::vector<dd::CMat> operators{};
+  for (const auto& op : damping.singleQubitOperators) {
+    operators.emplace_back(dd->makeGateDD(op, 1U).getMatrix(nq));
+  }
+  auto expected = conjugate(rho.getMatrix(nq), operators);
+  // the state has coherences, so off-diagonal entries are compared as well
+  ASSERT_GT(std::abs(expected[0][3]), 1e-3);
+  kraus.applyChannel(rho, damping, {1U});
+  expectEqual(expected, rho.getMatrix(nq));
+
+  const auto depolarization = dd::KrausChannel::twoQubitDepolarization(0.2);
+  operators.clear();
+  for (const auto& op : depolarization.twoQubitOperators) {
+    operators.emplace_back(dd->makeTwoQubitGateDD(op, 0U, 1U).getMatrix(nq));
+  }
+  expected = conjugate(rho.getMatrix(nq), operators);
+  kraus.applyChannel(rho, depolarization, {0U, 1U});
+  expectEqual(expected, rho.getMatrix(nq));
+
+  // channels mixing single- and two-qubit operators are rejected
+  auto mixed = dd::KrausChannel::twoQubitDepolarization(0.2);
+  mixed.singleQubitOperators =
+      dd::KrausChannel::bitFlip(0.1).singleQubitOperators;
+  auto model = dd::KrausNoiseModel{};
+  model.gateChannels[qc::X] = {mixed};
+  EXPECT_THROW(dd::KrausNoiseFunctionality(dd, nq, model),
+               std::invalid_argument);
+  EXPECT_THROW(kraus.applyChannel(rho, mixed, {0U, 1U}),
+               std::invalid_argument);
+  // applying a channel directly checks trace preservation as well
+  const auto lossy = dd::KrausChannel{{dd::GateMatrix{1, 0, 0, 0}}, {}};
+  EXPECT_THROW(kraus.applyChannel(rho, lossy, {0U}), std::invalid_argument);
+}
+
 TEST_F(DDNoiseFunctionalityTest, testingMeasure) {
   qc::QuantumComputation qcOp{};
 
@@ -296,6 +512,66 @@ TEST_F(DDNoiseFunctionalityTest, StochSimulateAdder4IdentityError) {
   EXPECT_NEAR(measSummary["1111"], 0., tolerance);
 }
 
+TEST_F(DDNoiseFunctionalityTest, StochTrajectoriesParallel) {
+  const dd::WeightedPauliSum observables{
+      {1., {dd::Pauli::Z, dd::Pauli::Z, dd::Pauli::I, dd::Pauli::I}},
+      {0.5, {dd::Pauli::X, dd::Pauli::I, dd::Pauli::I, dd::Pauli::Y}}};
+
+  auto config = dd::TrajectoryConfig{};
+  config.trajectories = 200U;
+  config.shotsPerTrajectory = 2U;
+  config.seed = 12345U;
+  config.gateNoiseProbability = 0.01;
+  config.amplitudeDampingProbability = 0.02;
+  config.noiseEffects = "APDI";
+
+  config.nthreads = 1U;
+  const auto sequential =
+      dd::simulateTrajectories(qc, config, {observables, {observables[0]}});
+  config.nthreads = 3U;
+  const auto parallel =
+      dd::simulateTrajectories(qc, config, {observables, {observables[0]}});
+
+  // trajectories are seeded individually, hence the threads do not matter
+  EXPECT_EQ(sequential.counts, parallel.counts);
+  ASSERT_EQ(parallel.observables.size(), 2U);
+  for (std::size_t i = 0U; i < parallel.observables.size(); ++i) {
+    EXPECT_EQ(sequential.observables[i].mean, parallel.observables[i].mean);
+    EXPECT_EQ(sequential.observables[i].halfWidth,
+              parallel.observables[i].halfWidth);
+    EXPECT_GT(parallel.observables[i].halfWidth, 0.);
+  }
+  std::size_t shots = 0U;
+  for (const auto& [outcome, count] : parallel.counts) {
+    EXPECT_EQ(outcome.size(), qc.getNqubits());
+    shots += count;
+  }
+  EXPECT_EQ(shots, config.trajectories * config.shotsPerTrajectory);
+  ASSERT_EQ(parallel.runtimes.size(), config.trajectories);
+  for (const auto runtime : parallel.runtimes) {
+    EXPECT_GE(runtime, 0.);
+  }
+
+  // without noise, all trajectories coincide with the ideal simulation
+  config.gateNoiseProbability = 0.;
+  config.amplitudeDampingProbability = 0.;
+  config.noiseEffects = "";
+  const auto ideal = dd::simulateTrajectories(qc, config, {observables});
+  auto dd = std::make_unique<dd::Package<>>(qc.getNqubits());
+  const auto state =
+      dd::simulate(&qc, dd->makeZeroState(qc.getNqubits()), *dd);
+  EXPECT_NEAR(ideal.observables[0].mean,
+              dd->expectationValue(observables, state), 1e-10);
+  EXPECT_NEAR(ideal.observables[0].halfWidth, 0., 1e-10);
+
+  config.trajectories = 0U;
+  EXPECT_THROW(dd::simulateTrajectories(qc, config, {observables}),
+               std::invalid_argument);
+
+  qc.measureAll();
+  EXPECT_THROW(dd::simulateTrajectories(qc, config), std::invalid_argument);
+}
+
 TEST_F(DDNoiseFunctionalityTest, testingUsedQubits) {
   const std::size_t nqubits = 1;
   auto standardOp = StandardOperation(1, qc::Z);
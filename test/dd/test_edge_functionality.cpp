@@ -3,16 +3,21 @@
 #include "dd/Node.hpp"
 #include "dd/Package.hpp"
 #include "dd/RealNumber.hpp"
+#include "ir/operations/Control.hpp"
 
 #include <cmath>
+#include <complex>
 #include <cstddef>
 #include <gtest/gtest.h>
 #include <iomanip>
 #include <memory>
 #include <sstream>
+#include <vector>
 
 namespace dd {
 
+using namespace qc::literals;
+
 ///-----------------------------------------------------------------------------
 ///                     \n Tests for vector DDs \n
 ///-----------------------------------------------------------------------------
@@ -38,6 +43,41 @@ TEST(VectorFunctionality, GetValueByIndexEndianness) {
   }
 }
 
+TEST(VectorFunctionality, GetValuesByIndicesTerminal) {
+  const std::vector<std::size_t> indices = {0, 1, 0};
+  EXPECT_EQ(vEdge::zero().getValuesByIndices(indices), (CVec{0., 0., 0.}));
+  EXPECT_EQ(vEdge::one().getValuesByIndices(indices), (CVec{1., 0., 1.}));
+}
+
+TEST(VectorFunctionality, GetValuesByIndicesConsistency) {
+  auto dd = std::make_unique<dd::Package<>>(3);
+  const CVec state = {std::sqrt(0.1), 0., std::sqrt(0.2), 0., 0.,
+                      std::sqrt(0.3), 0., {0., std::sqrt(0.4)}};
+  const auto stateDD = dd->makeStateFromVector(state);
+
+  // unsorted, duplicate and out-of-range indices
+  const std::vector<std::size_t> indices = {7, 0, 5, 5, 2, 9, 1, 6, 3, 4, 0};
+  for (const auto nthreads : {1U, 4U}) {
+    const auto values = stateDD.getValuesByIndices(indices, nthreads);
+    ASSERT_EQ(values.size(), indices.size());
+    for (std::size_t k = 0U; k < indices.size(); ++k) {
+      EXPECT_EQ(values[k], stateDD.getValueByIndex(indices[k]));
+    }
+  }
+}
+
+TEST(VectorFunctionality, GetValuesByIndicesAllBits) {
+  // every index is in range for a 64-qubit state
+  constexpr std::size_t nqubits = 64U;
+  auto dd = std::make_unique<dd::Package<>>(nqubits);
+  std::vector<bool> bits(nqubits, false);
+  bits.back() = true;
+  const auto stateDD = dd->makeBasisState(nqubits, bits);
+  const std::vector<std::size_t> indices = {0U, 1ULL << (nqubits - 1U),
+                                            ~std::size_t{0}};
+  EXPECT_EQ(stateDD.getValuesByIndices(indices), (CVec{0., 1., 0.}));
+}
+
 TEST(VectorFunctionality, GetVectorTerminal) {
   EXPECT_EQ(vEdge::zero().getVector(), CVec{0.});
   EXPECT_EQ(vEdge::one().getVector(), CVec{1.});
@@ -64,6 +104,21 @@ TEST(VectorFunctionality, GetVectorTolerance) {
   EXPECT_EQ(stateVec2[0], 0.);
 }
 
+TEST(VectorFunctionality, WriteVectorParallel) {
+  auto dd = std::make_unique<dd::Package<>>(3);
+  const CVec state = {std::sqrt(0.1), 0., std::sqrt(0.2), 0., 0.,
+                      std::sqrt(0.3), 0., {0., std::sqrt(0.4)}};
+  const auto stateDD = dd->makeStateFromVector(state);
+
+  for (const auto nthreads : {1U, 4U}) {
+    // every entry of the buffer is overwritten
+    CVec vec(state.size(), 42.);
+    stateDD.writeVector(vec.data(), 0., nthreads);
+    EXPECT_EQ(vec, state);
+    EXPECT_EQ(stateDD.getVector(0., nthreads), state);
+  }
+}
+
 TEST(VectorFunctionality, GetSparseVectorTerminal) {
   const auto zero = SparseCVec{{0, 0}};
   EXPECT_EQ(vEdge::zero().getSparseVector(), zero);
@@ -269,6 +324,81 @@ TEST(MatrixFunctionality, GetSparseMatrixConsistency) {
   }
 }
 
+TEST(MatrixFunctionality, GetSparseMatrixWeightOnSkippedLevels) {
+  constexpr std::size_t nq = 3U;
+  auto dd = std::make_unique<dd::Package<>>(nq);
+  // the root edge carries the 1/sqrt(2) of the Hadamard and skips two levels
+  const auto matDD = dd->makeGateDD(dd::H_MAT, 0);
+  ASSERT_EQ(matDD.p->v, 0);
+  ASSERT_FALSE(matDD.w.exactlyOne());
+
+  const auto dense = matDD.getMatrix(nq);
+  const auto sparse = matDD.getSparseMatrix(nq);
+  const std::size_t dim = 1ULL << nq;
+  std::size_t nonZero = 0U;
+  for (std::size_t i = 0U; i < dim; ++i) {
+    for (std::size_t j = 0U; j < dim; ++j) {
+      const auto it = sparse.find({i, j});
+      const auto val = it == sparse.end() ? std::complex<fp>{} : it->second;
+      EXPECT_NEAR(std::abs(dense[i][j] - val), 0., 1e-12);
+      nonZero += std::abs(dense[i][j]) > 0. ? 1U : 0U;
+    }
+  }
+  EXPECT_EQ(sparse.size(), nonZero);
+  EXPECT_NEAR(std::abs(dense[0][0]), SQRT2_2, 1e-12);
+}
+
+TEST(MatrixFunctionality, WriteMatrixParallel) {
+  constexpr std::size_t nq = 3U;
+  auto dd = std::make_unique<dd::Package<>>(nq);
+  const auto matDD = dd->multiply(dd->makeGateDD(dd::H_MAT, 1),
+                                  dd->makeGateDD(dd::Y_MAT, 0_pc, 2));
+  const std::size_t dim = 1ULL << nq;
+
+  for (const auto nthreads : {1U, 4U}) {
+    // every entry of the buffer is overwritten
+    CVec mat(dim * dim, 42.);
+    matDD.writeMatrix(nq, mat.data(), 0., nthreads);
+    const auto matDense = matDD.getMatrix(nq, 0., nthreads);
+    for (std::size_t i = 0U; i < dim; ++i) {
+      for (std::size_t j = 0U; j < dim; ++j) {
+        const auto val = matDD.getValueByIndex(nq, i, j);
+        EXPECT_EQ(mat[(i * dim) + j], val);
+        EXPECT_EQ(matDense[i][j], val);
+      }
+    }
+  }
+}
+
+TEST(MatrixFunctionality, GetSparseMatrixCSRConsistency) {
+  constexpr std::size_t nq = 3U;
+  auto dd = std::make_unique<dd::Package<>>(nq);
+  const auto matDD = dd->multiply(dd->makeGateDD(dd::H_MAT, 1),
+                                  dd->makeGateDD(dd::Y_MAT, 0_pc, 2));
+  const std::size_t dim = 1ULL << nq;
+
+  for (const auto nthreads : {1U, 4U}) {
+    const auto csr = matDD.getSparseMatrixCSR(nq, 0., nthreads);
+    ASSERT_EQ(csr.dim, dim);
+    ASSERT_EQ(csr.rowPtr.size(), dim + 1U);
+    ASSERT_EQ(csr.rowPtr.back(), csr.values.size());
+    for (std::size_t i = 0U; i < dim; ++i) {
+      std::size_t k = csr.rowPtr[i];
+      for (std::size_t j = 0U; j < dim; ++j) {
+        const auto val = matDD.getValueByIndex(nq, i, j);
+        if (val == 0.) {
+          continue;
+        }
+        ASSERT_LT(k, csr.rowPtr[i + 1U]);
+        EXPECT_EQ(csr.colIdx[k], j);
+        EXPECT_EQ(csr.values[k], val);
+        ++k;
+      }
+      EXPECT_EQ(k, csr.rowPtr[i + 1U]);
+    }
+  }
+}
+
 TEST(MatrixFunctionality, GetSparseMatrixTolerance) {
   auto dd = std::make_unique<dd::Package<>>(2);
   // clang-format off
@@ -1,4 +1,6 @@
 #include "Definitions.hpp"
+#include "dd/ComputeTable.hpp"
+#include "dd/ComputeTableAdaptation.hpp"
 #include "dd/DDDefinitions.hpp"
 #include "dd/DDpackageConfig.hpp"
 #include "dd/Export.hpp"
@@ -31,6 +33,26 @@
 
 using namespace qc::literals;
 
+namespace {
+/// A normalized vector whose unnormalized amplitudes are
+/// (i mod realPeriod) + i (i mod imagPeriod)
+dd::CVec periodicAmplitudes(const std::size_t size,
+                            const std::size_t realPeriod = 5U,
+                            const std::size_t imagPeriod = 3U) {
+  dd::CVec amplitudes(size);
+  dd::fp norm = 0.;
+  for (std::size_t i = 0; i < amplitudes.size(); ++i) {
+    amplitudes[i] = {static_cast<dd::fp>(i % realPeriod),
+                     static_cast<dd::fp>(i % imagPeriod)};
+    norm += std::norm(amplitudes[i]);
+  }
+  for (auto& amplitude : amplitudes) {
+    amplitude /= std::sqrt(norm);
+  }
+  return amplitudes;
+}
+} // namespace
+
 TEST(DDPackageTest, RequestInvalidPackageSize) {
   EXPECT_THROW(auto dd = std::make_unique<dd::Package<>>(
                    dd::Package<>::MAX_POSSIBLE_QUBITS + 2),
@@ -418,6 +440,98 @@ TEST(DDPackageTest, PartialTraceComplexity) {
   }
 }
 
+TEST(DDPackageTest, ReducedDensityMatrixMatchesAmplitudes) {
+  const std::size_t numQubits = 4;
+  auto dd = std::make_unique<dd::Package<>>(numQubits);
+  auto state = dd->makeZeroState(numQubits);
+  const std::vector<dd::mEdge> operations = {
+      dd->makeGateDD(dd::H_MAT, 0),
+      dd->makeGateDD(dd::rxMat(0.7), 2),
+      dd->makeGateDD(dd::X_MAT, 0, 3),
+      dd->makeGateDD(dd::T_MAT, 3),
+      dd->makeGateDD(dd::X_MAT, 2, 1),
+      dd->makeGateDD(dd::H_MAT, 1),
+  };
+  for (const auto& op : operations) {
+    state = dd->multiply(op, state);
+  }
+
+  // keep qubits 1 and 3
+  const std::vector<bool> eliminate = {true, false, true, false};
+  const auto rho = dd->reducedDensityMatrix(state, eliminate);
+  const auto actual = rho.getMatrix(2);
+
+  const auto amplitudes = state.getVector();
+  const auto reduced = [](const std::size_t i) {
+    return ((i >> 1U) & 1U) | (((i >> 3U) & 1U) << 1U);
+  };
+  const auto traced = [](const std::size_t i) { return i & 0b0101U; };
+  dd::CMat expected(4, dd::CVec(4, 0.));
+  for (std::size_t i = 0; i < amplitudes.size(); ++i) {
+    for (std::size_t j = 0; j < amplitudes.size(); ++j) {
+      if (traced(i) == traced(j)) {
+        expected[reduced(i)][reduced(j)] +=
+            amplitudes[i] * std::conj(amplitudes[j]);
+      }
+    }
+  }
+  for (std::size_t i = 0; i < 4; ++i) {
+    for (std::size_t j = 0; j < 4; ++j) {
+      EXPECT_NEAR(actual[i][j].real(), expected[i][j].real(), 1e-10);
+      EXPECT_NEAR(actual[i][j].imag(), expected[i][j].imag(), 1e-10);
+    }
+  }
+}
+
+TEST(DDPackageTest, EntanglementEntropyOfLargeStates) {
+  const std::size_t numQubits = 60;
+  auto dd = std::make_unique<dd::Package<>>(numQubits);
+
+  // a single qubit of a GHZ state is maximally mixed
+  const auto ghz = dd->makeGHZState(numQubits);
+  std::vector<bool> eliminate(numQubits, true);
+  eliminate[numQubits - 1] = false;
+  EXPECT_NEAR(dd->renyi2Entropy(ghz, eliminate), 1., 1e-10);
+  EXPECT_NEAR(dd->vonNeumannEntropy(ghz, eliminate), 1., 1e-10);
+
+  // the outermost qubits are classically correlated
+  eliminate[0] = false;
+  const auto rho = dd->reducedDensityMatrix(ghz, eliminate).getMatrix(2);
+  for (std::size_t i = 0; i < 4; ++i) {
+    for (std::size_t j = 0; j < 4; ++j) {
+      const auto expected = (i == j && (i == 0 || i == 3)) ? 0.5 : 0.;
+      EXPECT_NEAR(std::abs(rho[i][j]), expected, 1e-10);
+    }
+  }
+  EXPECT_NEAR(dd->vonNeumannEntropy(ghz, eliminate), 1., 1e-10);
+
+  // product states are not entangled
+  const auto zero = dd->makeZeroState(numQubits);
+  EXPECT_NEAR(dd->renyi2Entropy(zero, eliminate), 0., 1e-10);
+  EXPECT_NEAR(dd->vonNeumannEntropy(zero, eliminate), 0., 1e-10);
+
+  // a single qubit of a W state has the spectrum {1 - 1/n, 1/n}
+  const auto w = dd->makeWState(numQubits);
+  std::fill(eliminate.begin(), eliminate.end(), true);
+  eliminate[7] = false;
+  const auto p = 1. / static_cast<dd::fp>(numQubits);
+  EXPECT_NEAR(dd->renyi2Entropy(w, eliminate),
+              -std::log2((p * p) + ((1. - p) * (1. - p))), 1e-10);
+  EXPECT_NEAR(dd->vonNeumannEntropy(w, eliminate),
+              -(p * std::log2(p)) - ((1. - p) * std::log2(1. - p)), 1e-10);
+
+  // the mask must cover exactly the qubits of the state
+  const auto small = dd->makeGHZState(2U);
+  EXPECT_THROW(dd->reducedDensityMatrix(small, {true}), std::invalid_argument);
+  EXPECT_THROW(dd->reducedDensityMatrix(small, {true, false, false}),
+               std::invalid_argument);
+  EXPECT_THROW(dd->renyi2Entropy(small, {false, true, true}),
+               std::invalid_argument);
+  EXPECT_THROW(dd->vonNeumannEntropy(small, eliminate),
+               std::invalid_argument);
+  EXPECT_NEAR(dd->vonNeumannEntropy(small, {false, true}), 1., 1e-10);
+}
+
 TEST(DDPackageTest, StateGenerationManipulation) {
   const std::size_t nqubits = 6;
   auto dd = std::make_unique<dd::Package<>>(nqubits);
@@ -1064,6 +1178,67 @@ TEST(DDPackageTest, KroneckerIdentityHandling) {
   EXPECT_EQ(matrix, expectedMatrix);
 }
 
+TEST(DDPackageTest, KroneckerRespectsNumberOfQubits) {
+  auto dd = std::make_unique<dd::Package<>>(4U);
+  const auto x = dd->makeGateDD(dd::X_MAT, 0U);
+  // Z on the lower of two qubits, i.e., with a skipped identity on top
+  const auto z = dd->makeGateDD(dd::Z_MAT, 0U);
+  EXPECT_EQ(dd->kronecker(x, z, 2U),
+            dd->multiply(dd->makeGateDD(dd::X_MAT, 2U), z));
+  // the compute table must not return the product for the previous offset
+  EXPECT_EQ(dd->kronecker(x, z, 1U),
+            dd->multiply(dd->makeGateDD(dd::X_MAT, 1U), z));
+  // products for different offsets coexist in the compute table
+  const auto hits = dd->matrixKronecker.getStats().hits;
+  EXPECT_EQ(dd->kronecker(x, z, 2U),
+            dd->multiply(dd->makeGateDD(dd::X_MAT, 2U), z));
+  EXPECT_EQ(dd->kronecker(x, z, 1U),
+            dd->multiply(dd->makeGateDD(dd::X_MAT, 1U), z));
+  EXPECT_EQ(dd->matrixKronecker.getStats().hits, hits + 2U);
+
+  const auto id = dd->makeIdent();
+  EXPECT_EQ(dd->kronecker(x, id, 1U), dd->makeGateDD(dd::X_MAT, 1U));
+  EXPECT_EQ(dd->kronecker(x, id, 3U), dd->makeGateDD(dd::X_MAT, 3U));
+}
+
+TEST(DDPackageTest, InsertQubitsIntoMatrix) {
+  auto dd = std::make_unique<dd::Package<>>(5U);
+  const auto cx = dd->makeGateDD(dd::X_MAT, 2U, 0U);
+  // idle qubits in between the control and the target
+  const auto inserted = dd->insertQubits(cx, 1, 2U);
+  EXPECT_EQ(inserted, dd->makeGateDD(dd::X_MAT, 4U, 0U));
+  // the sub-diagrams below the insertion point are reused
+  EXPECT_EQ(inserted.p->e[3].p, cx.p->e[3].p);
+
+  // qubits above the top of a matrix are implicitly idle
+  const auto extended = dd->insertQubits(cx, 3, 2U);
+  EXPECT_EQ(extended, cx);
+}
+
+TEST(DDPackageTest, InsertQubitsIntoVector) {
+  auto dd = std::make_unique<dd::Package<>>(5U);
+  auto bell = dd->makeZeroState(2U);
+  bell = dd->multiply(dd->makeGateDD(dd::H_MAT, 1U), bell);
+  bell = dd->multiply(dd->makeGateDD(dd::X_MAT, 1U, 0U), bell);
+
+  // two ancillae in |0> between the qubits of the Bell pair
+  const auto inserted = dd->insertQubits(bell, 1, 2U);
+  const auto amplitudes = inserted.getVector();
+  ASSERT_EQ(amplitudes.size(), 16U);
+  for (std::size_t i = 0U; i < amplitudes.size(); ++i) {
+    const auto expected = (i == 0U || i == 0b1001U) ? dd::SQRT2_2 : 0.;
+    EXPECT_NEAR(std::abs(amplitudes[i]), expected, 1e-10);
+  }
+
+  // ancillae on top only add new levels
+  const auto extended = dd->insertQubits(bell, 2, 3U);
+  EXPECT_EQ(extended.p->v, 4);
+  EXPECT_EQ(extended.p->e[0].p->e[0].p->e[0].p, bell.p);
+  EXPECT_EQ(extended, dd->kronecker(dd->makeZeroState(3U), bell, 2U));
+
+  EXPECT_THROW(dd->insertQubits(bell, 3, 1U), std::invalid_argument);
+}
+
 TEST(DDPackageTest, NearZeroNormalize) {
   auto dd = std::make_unique<dd::Package<>>(2);
   const dd::fp nearZero = dd::RealNumber::eps / 10;
@@ -1190,6 +1365,119 @@ TEST(DDPackageTest, DestructiveMeasurementOneArbitraryNormalization) {
   ASSERT_EQ(vAfter[3], 0.);
 }
 
+TEST(DDPackageTest, MeasurementProbabilitiesReuseNodeProbabilities) {
+  auto dd = std::make_unique<dd::Package<>>(3);
+  dd::CVec amplitudes = {0.1, 0.2, {0., 0.3}, 0.4, 0.5, 0., 0.3, {0.4, -0.1}};
+  for (auto& amplitude : amplitudes) {
+    amplitude /= 0.9;
+  }
+  auto state = dd->makeStateFromVector(amplitudes);
+  dd->incRef(state);
+
+  for (dd::Qubit q = 0; q < 3; ++q) {
+    dd::fp pzero = 0.;
+    dd::fp pone = 0.;
+    for (std::size_t i = 0; i < amplitudes.size(); ++i) {
+      const auto p = std::norm(amplitudes[i]);
+      if (((i >> q) & 1U) == 0U) {
+        pzero += p;
+      } else {
+        pone += p;
+      }
+    }
+    const auto [p0, p1] =
+        dd->determineMeasurementProbabilities(state, q, false);
+    EXPECT_NEAR(p0, pzero, 1e-10);
+    EXPECT_NEAR(p1, pone, 1e-10);
+    EXPECT_TRUE(dd->getNodeProbabilities().isCached(state));
+  }
+
+  // collapsing the state yields a new state for which the cache is recomputed
+  std::mt19937_64 mt{0}; // NOLINT(cert-msc51-cpp)
+  const auto m = dd->measureOneCollapsing(state, 2, false, mt);
+  // assuming normalized nodes, only the levels above the qubit are visited
+  const auto [p0, p1] = dd->determineMeasurementProbabilities(state, 2, true);
+  EXPECT_EQ(dd->getNodeProbabilities().size(), 1U);
+  EXPECT_NEAR(m == '0' ? p0 : p1, 1., 1e-10);
+  EXPECT_NEAR(m == '0' ? p1 : p0, 0., 1e-10);
+  const auto [q0, q1] = dd->determineMeasurementProbabilities(state, 0, false);
+  EXPECT_NEAR(q0 + q1, 1., 1e-10);
+  EXPECT_EQ(dd->getNodeProbabilities().size(), state.size() - 1U);
+
+  // collecting vector nodes invalidates the cache
+  dd->decRef(state);
+  dd->garbageCollect(true);
+  EXPECT_FALSE(dd->getNodeProbabilities().isCached(state));
+}
+
+TEST(DDPackageTest, MarginalProbabilities) {
+  auto dd = std::make_unique<dd::Package<>>(4);
+  const auto amplitudes = periodicAmplitudes(16U);
+  auto state = dd->makeStateFromVector(amplitudes);
+  dd->incRef(state);
+
+  const std::vector<std::vector<dd::Qubit>> subsets = {
+      {}, {0}, {3}, {2, 0}, {1, 3, 2}, {3, 2, 1, 0}};
+  for (const auto& qubits : subsets) {
+    std::vector<dd::fp> expected(1ULL << qubits.size(), 0.);
+    for (std::size_t i = 0; i < amplitudes.size(); ++i) {
+      std::size_t outcome = 0;
+      for (std::size_t j = 0; j < qubits.size(); ++j) {
+        outcome |= ((i >> qubits[j]) & 1U) << j;
+      }
+      expected[outcome] += std::norm(amplitudes[i]);
+    }
+    const auto marginal = dd->marginalProbabilities(state, qubits);
+    ASSERT_EQ(marginal.size(), expected.size());
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+      EXPECT_NEAR(marginal[i], expected[i], 1e-10);
+    }
+  }
+
+  EXPECT_THROW(dd->marginalProbabilities(state, {4}), std::invalid_argument);
+  EXPECT_THROW(dd->marginalProbabilities(state, {1, 1}),
+               std::invalid_argument);
+  // the outcomes of 64 qubits cannot be indexed
+  EXPECT_THROW(
+      dd->marginalProbabilities(state, std::vector<dd::Qubit>(64U, 0U)),
+      std::invalid_argument);
+}
+
+TEST(DDPackageTest, ApproximateState) {
+  auto dd = std::make_unique<dd::Package<>>(3);
+  // two dominant amplitudes and a few small ones
+  dd::CVec amplitudes{{0.7, 0.}, 0.01, {0., 0.02}, 0., 0.05, 0., 0., {0., 0.7}};
+  dd::fp norm = 0.;
+  for (const auto& amplitude : amplitudes) {
+    norm += std::norm(amplitude);
+  }
+  for (auto& amplitude : amplitudes) {
+    amplitude /= std::sqrt(norm);
+  }
+  const auto original = dd->makeStateFromVector(amplitudes);
+  dd->incRef(original);
+  auto state = original;
+  dd->incRef(state);
+
+  // nothing to remove
+  EXPECT_NEAR(dd->approximate(state, 1e-6), 1., 1e-10);
+  EXPECT_EQ(state.p, original.p);
+
+  // removes the amplitudes at indices 1 and 2, but keeps the one at index 4
+  const auto fidelity = dd->approximate(state, 1e-3);
+  EXPECT_LT(fidelity, 1.);
+  EXPECT_NEAR(fidelity, dd->fidelity(original, state), 1e-10);
+  const auto vec = state.getVector();
+  EXPECT_EQ(vec[1], 0.);
+  EXPECT_EQ(vec[2], 0.);
+  EXPECT_NE(vec[4], 0.);
+  EXPECT_NEAR(dd::ComplexNumbers::mag2(state.w), 1., 1e-10);
+
+  EXPECT_THROW(dd->approximate(state, 2.), std::invalid_argument);
+  dd->decRef(state);
+  dd->decRef(original);
+}
+
 TEST(DDPackageTest, ExportPolarPhaseFormatted) {
   std::ostringstream phaseString;
 
@@ -1580,6 +1868,60 @@ TEST(DDPackageTest, dNodeMultiply2) {
   }
 }
 
+TEST(DDPackageTest, dNodeApplyOperationMatchesExplicitProducts) {
+  // U·ρ·U† computed in a single Hermiticity-exploiting traversal has to agree
+  // with the explicit products U·(ρ·U†)
+  const auto nrQubits = 4U;
+  auto dd =
+      std::make_unique<dd::Package<dd::DensityMatrixSimulatorDDPackageConfig>>(
+          nrQubits);
+  auto state = dd->makeZeroDensityOperator(dd->qubits());
+  dd->incRef(state);
+  auto reference = state;
+  dd->incRef(reference);
+
+  std::vector<dd::mEdge> operations = {};
+  operations.emplace_back(dd->makeGateDD(dd::H_MAT, 0));
+  operations.emplace_back(dd->makeGateDD(dd::rxMat(0.3), 3));
+  operations.emplace_back(dd->makeGateDD(dd::X_MAT, 0, 2));
+  operations.emplace_back(dd->makeGateDD(dd::T_MAT, 1));
+  operations.emplace_back(dd->makeGateDD(dd::SX_MAT, 3, 1));
+  operations.emplace_back(dd->makeGateDD(dd::rxMat(1.1), 0));
+  operations.emplace_back(dd->makeGateDD(dd::Y_MAT, 2, 3));
+  operations.emplace_back(dd->makeGateDD(dd::H_MAT, 1));
+
+  for (const auto& op : operations) {
+    dd->applyOperationToDensity(state, op);
+
+    const auto adjoint = dd->conjugateTranspose(op);
+    const auto tmp =
+        dd->multiply(reference, dd::densityFromMatrixEdge(adjoint), false);
+    const auto result =
+        dd->multiply(dd::densityFromMatrixEdge(op), tmp, true);
+    dd->incRef(result);
+    dd::dEdge::alignDensityEdge(reference);
+    dd->decRef(reference);
+    reference = result;
+    dd::dEdge::setDensityMatrixTrue(reference);
+  }
+
+  const auto actual = state.getMatrix(dd->qubits());
+  const auto expected = reference.getMatrix(dd->qubits());
+  constexpr auto tolerance = 1e-10;
+  auto trace = 0.;
+  for (std::size_t i = 0; i < (1 << nrQubits); ++i) {
+    trace += actual[i][i].real();
+    for (std::size_t j = 0; j < (1 << nrQubits); ++j) {
+      EXPECT_NEAR(actual[i][j].real(), expected[i][j].real(), tolerance);
+      EXPECT_NEAR(actual[i][j].imag(), expected[i][j].imag(), tolerance);
+      EXPECT_NEAR(actual[i][j].real(), actual[j][i].real(), tolerance);
+      EXPECT_NEAR(actual[i][j].imag(), -actual[j][i].imag(), tolerance);
+    }
+  }
+  EXPECT_NEAR(trace, 1., tolerance);
+  EXPECT_GT(dd->densityOperationApplication.getStats().lookups, 0U);
+}
+
 TEST(DDPackageTest, dNodeMulCache1) {
   // Make caching test with dNodes
   const auto nrQubits = 1U;
@@ -1742,6 +2084,29 @@ TEST(DDPackageTest, stateFromVectorNoPowerOfTwo) {
   EXPECT_THROW(dd->makeStateFromVector(v), std::invalid_argument);
 }
 
+TEST(DDPackageTest, stateFromVectorParallel) {
+  auto dd = std::make_unique<dd::Package<>>(5);
+  const auto v = periodicAmplitudes(32U, 7U, 2U);
+  const auto serial = dd->makeStateFromVector(v);
+  const auto parallel = dd->makeStateFromVector(v, 0., 4);
+  EXPECT_EQ(parallel.p, serial.p);
+  EXPECT_TRUE(parallel.w.approximatelyEquals(serial.w));
+  EXPECT_EQ(parallel.getVector(), serial.getVector());
+}
+
+TEST(DDPackageTest, stateFromVectorThreshold) {
+  auto dd = std::make_unique<dd::Package<>>(2);
+  const auto v = dd::CVec{dd::SQRT2_2, 1e-12, 1e-12, dd::SQRT2_2};
+  for (const auto nthreads : {1U, 4U}) {
+    const auto s = dd->makeStateFromVector(v, 1e-9, nthreads);
+    const auto vec = s.getVector();
+    EXPECT_EQ(vec[1], 0.);
+    EXPECT_EQ(vec[2], 0.);
+    EXPECT_NEAR(vec[0].real(), dd::SQRT2_2, 1e-10);
+    EXPECT_NEAR(vec[3].real(), dd::SQRT2_2, 1e-10);
+  }
+}
+
 TEST(DDPackageTest, stateFromScalar) {
   auto dd = std::make_unique<dd::Package<>>(1);
   auto s = dd->makeStateFromVector({1});
@@ -1810,6 +2175,143 @@ TEST(DDPackageTest, expectationValueExceptions) {
   EXPECT_ANY_THROW(dd->expectationValue(xGate, zeroState));
 }
 
+TEST(DDPackageTest, expectationValuePauliStrings) {
+  const auto nrQubits = 3U;
+  auto dd = std::make_unique<dd::Package<>>(nrQubits);
+
+  const auto amplitudes = periodicAmplitudes(1ULL << nrQubits);
+  const auto state = dd->makeStateFromVector(amplitudes);
+  dd->incRef(state);
+
+  const std::array<dd::GateMatrix, 4> matrices{dd::I_MAT, dd::X_MAT, dd::Y_MAT,
+                                               dd::Z_MAT};
+  dd::WeightedPauliSum observable{};
+  for (std::size_t k = 0; k < (1ULL << (2U * nrQubits)); ++k) {
+    dd::PauliString pauli(nrQubits);
+    auto matrix = dd->makeIdent();
+    for (dd::Qubit q = 0; q < nrQubits; ++q) {
+      const auto p = (k >> (2U * q)) & 3U;
+      pauli[q] = static_cast<dd::Pauli>(p);
+      matrix = dd->multiply(dd->makeGateDD(matrices[p], q), matrix);
+    }
+    EXPECT_NEAR(dd->expectationValue(pauli, state),
+                dd->expectationValue(matrix, state), 1e-10);
+    observable.emplace_back(0.1 * static_cast<dd::fp>(k), pauli);
+  }
+  dd::fp expected = 0.;
+  for (const auto& [coefficient, pauli] : observable) {
+    expected += coefficient * dd->expectationValue(pauli, state);
+  }
+  EXPECT_NEAR(dd->expectationValue(observable, state), expected, 1e-10);
+
+  // strings shorter than the state are padded with identities
+  EXPECT_NEAR(dd->expectationValue(dd::makePauliString("Z"), state),
+              dd->expectationValue(dd::makePauliString("IIZ"), state), 1e-12);
+  EXPECT_THROW(dd->expectationValue(dd::makePauliString("XIII"), state),
+               std::invalid_argument);
+  EXPECT_THROW(static_cast<void>(dd::makePauliString("XA")),
+               std::invalid_argument);
+  dd->decRef(state);
+}
+
+TEST(DDPackageTest, PauliSumDD) {
+  const auto nrQubits = 3U;
+  auto dd = std::make_unique<dd::Package<>>(nrQubits);
+
+  const dd::WeightedPauliSum observable{{0.5, dd::makePauliString("XYZ")},
+                                        {-1.25, dd::makePauliString("ZZ")},
+                                        {0.75, dd::makePauliString("YIY")},
+                                        {0.1, dd::makePauliString("XYZ")},
+                                        {2., dd::makePauliString("")},
+                                        {-0.3, dd::makePauliString("IXI")}};
+  const std::array<dd::GateMatrix, 4> matrices{dd::I_MAT, dd::X_MAT, dd::Y_MAT,
+                                               dd::Z_MAT};
+  auto expected = dd::mEdge::zero();
+  for (const auto& [coefficient, pauli] : observable) {
+    auto term = dd->makeIdent();
+    for (std::size_t q = 0; q < pauli.size(); ++q) {
+      term = dd->multiply(
+          dd->makeGateDD(matrices[static_cast<std::size_t>(pauli[q])],
+                         static_cast<dd::Qubit>(q)),
+          term);
+    }
+    term.w = dd->cn.lookup(term.w * coefficient);
+    expected = dd->add(expected, term);
+  }
+
+  const auto sum = dd->makePauliSumDD(observable);
+  const auto actual = sum.getMatrix(nrQubits);
+  const auto reference = expected.getMatrix(nrQubits);
+  for (std::size_t i = 0; i < actual.size(); ++i) {
+    for (std::size_t j = 0; j < actual.size(); ++j) {
+      EXPECT_NEAR(std::abs(actual[i][j] - reference[i][j]), 0., 1e-12);
+    }
+  }
+
+  // a single Pauli string on the lowest qubit skips the identities above
+  const auto z = dd->makePauliSumDD({{1., dd::makePauliString("Z")}});
+  EXPECT_EQ(z, dd->makeGateDD(dd::Z_MAT, 0));
+
+  EXPECT_THROW(dd->makePauliSumDD({{1., dd::makePauliString("XIII")}}),
+               std::runtime_error);
+}
+
+TEST(DDPackageTest, PermuteQubits) {
+  const auto nrQubits = 4U;
+  auto dd = std::make_unique<dd::Package<>>(nrQubits);
+  std::mt19937_64 mt(42U);
+  std::normal_distribution<dd::fp> dist{};
+
+  // bit l of an index moves to bit permutation[l]
+  const std::vector<dd::Qubit> permutation{2U, 0U, 3U, 1U};
+  const auto relabel = [&permutation](const std::size_t index) {
+    std::size_t result = 0U;
+    for (std::size_t l = 0; l < permutation.size(); ++l) {
+      result |= ((index >> l) & 1U) << permutation[l];
+    }
+    return result;
+  };
+
+  dd::CVec amplitudes(1U << nrQubits);
+  for (auto& amplitude : amplitudes) {
+    amplitude = {dist(mt), dist(mt)};
+  }
+  const auto state = dd->makeStateFromVector(amplitudes);
+  const auto vector = state.getVector();
+  const auto permuted = dd->permuteQubits(state, permutation).getVector();
+  for (std::size_t i = 0; i < vector.size(); ++i) {
+    EXPECT_NEAR(std::abs(permuted[relabel(i)] - vector[i]), 0., 1e-12);
+  }
+  EXPECT_THROW(dd->permuteQubits(state, {1U, 0U}), std::invalid_argument);
+
+  // a dense matrix and one that skips the identities on most qubits
+  const auto dim = std::size_t{1U} << nrQubits;
+  dd::CMat entries(dim, dd::CVec(dim));
+  for (auto& row : entries) {
+    for (auto& entry : row) {
+      entry = {dist(mt), dist(mt)};
+    }
+  }
+  for (const auto& op :
+       {dd->makeDDFromMatrix(entries), dd->makeGateDD(dd::Y_MAT, 1U)}) {
+    const auto matrix = op.getMatrix(nrQubits);
+    const auto rows =
+        dd->permuteQubits(op, permutation, true, false).getMatrix(nrQubits);
+    const auto columns =
+        dd->permuteQubits(op, permutation, false, true).getMatrix(nrQubits);
+    const auto both = dd->permuteQubits(op, permutation).getMatrix(nrQubits);
+    for (std::size_t i = 0; i < dim; ++i) {
+      for (std::size_t j = 0; j < dim; ++j) {
+        const auto expected = matrix[i][j];
+        EXPECT_NEAR(std::abs(rows[relabel(i)][j] - expected), 0., 1e-12);
+        EXPECT_NEAR(std::abs(columns[i][relabel(j)] - expected), 0., 1e-12);
+        EXPECT_NEAR(std::abs(both[relabel(i)][relabel(j)] - expected), 0.,
+                    1e-12);
+      }
+    }
+  }
+}
+
 TEST(DDPackageTest, DDFromSingleQubitMatrix) {
   const auto inputMatrix =
       dd::CMat{{dd::SQRT2_2, dd::SQRT2_2}, {dd::SQRT2_2, -dd::SQRT2_2}};
@@ -1848,6 +2350,35 @@ TEST(DDPackageTest, DDFromTwoQubitAsymmetricalMatrix) {
   EXPECT_EQ(inputMatrix, outputMatrix);
 }
 
+TEST(DDPackageTest, DDFromMatrixParallel) {
+  const auto nrQubits = 3U;
+  const auto dd = std::make_unique<dd::Package<>>(nrQubits);
+  const std::size_t dim = 1ULL << nrQubits;
+  auto inputMatrix = dd::CMat(dim, dd::CVec(dim));
+  for (std::size_t i = 0; i < dim; ++i) {
+    for (std::size_t j = 0; j < dim; ++j) {
+      inputMatrix[i][j] = {static_cast<dd::fp>((i * j) % 5),
+                           static_cast<dd::fp>((i + j) % 3)};
+    }
+  }
+  // a tiny entry that is pruned during the construction
+  inputMatrix[1][2] = 1e-12;
+
+  const auto serial = dd->makeDDFromMatrix(inputMatrix, 1e-9);
+  const auto parallel = dd->makeDDFromMatrix(inputMatrix, 1e-9, 4);
+  EXPECT_EQ(parallel.p, serial.p);
+  EXPECT_TRUE(parallel.w.approximatelyEquals(serial.w));
+
+  inputMatrix[1][2] = 0.;
+  const auto outputMatrix = parallel.getMatrix(nrQubits);
+  for (std::size_t i = 0; i < dim; ++i) {
+    for (std::size_t j = 0; j < dim; ++j) {
+      EXPECT_NEAR(outputMatrix[i][j].real(), inputMatrix[i][j].real(), 1e-10);
+      EXPECT_NEAR(outputMatrix[i][j].imag(), inputMatrix[i][j].imag(), 1e-10);
+    }
+  }
+}
+
 TEST(DDPackageTest, DDFromThreeQubitMatrix) {
   const auto inputMatrix =
       dd::CMat{{1, 0, 0, 0, 0, 0, 0, 0}, {0, 1, 0, 0, 0, 0, 0, 0},
@@ -2492,6 +3023,135 @@ TEST(DDPackageTest, DDStatistics) {
   EXPECT_GT(uniqueTableStats["total"]["num_buckets"], 0);
 }
 
+TEST(DDPackageTest, ComputeTableResize) {
+  dd::ComputeTable<dd::mNode*, dd::vNode*, dd::vCachedEdge, 1024U> table{};
+  EXPECT_EQ(table.getNumBuckets(), 1024U);
+  auto* node = reinterpret_cast<dd::vNode*>(0x40);
+  table.insert(nullptr, node, dd::vCachedEdge::one());
+  ASSERT_NE(table.lookup(nullptr, node), nullptr);
+
+  EXPECT_THROW(table.resize(1000U), std::invalid_argument);
+  table.resize(4096U);
+  EXPECT_EQ(table.getNumBuckets(), 4096U);
+  EXPECT_EQ(table.getStats().numBuckets, 4096U);
+  EXPECT_EQ(table.getStats().numEntries, 0U);
+  EXPECT_EQ(table.lookup(nullptr, node), nullptr);
+  EXPECT_EQ(table.getStats().lookups, 2U);
+}
+
+TEST(DDPackageTest, ComputeTableAdaptationPolicy) {
+  // 1 KiB entries, so that 1024 buckets use 1 MiB
+  const auto makeStats = [](const std::size_t buckets) {
+    dd::TableStatistics stats{};
+    stats.entrySize = 1U << 10U;
+    stats.numBuckets = buckets;
+    return stats;
+  };
+  auto hot = makeStats(1024U);
+  auto cold = makeStats(4096U);
+  const auto disabled = makeStats(1U);
+  const std::vector<dd::ComputeTableUsage> tables{
+      {"hot", &hot}, {"cold", &cold}, {"disabled", &disabled}};
+
+  dd::ComputeTableAdaptation adaptation{};
+  adaptation.config.enabled = true;
+  adaptation.config.interval = 2U;
+  adaptation.config.memoryBudgetMiB = 6.;
+  adaptation.config.minLookups = 100U;
+  EXPECT_FALSE(adaptation.tick());
+  EXPECT_TRUE(adaptation.tick());
+
+  const auto round = [&]() {
+    hot.lookups += 10000U;
+    hot.hits += 2000U;
+    hot.collisions += 5000U;
+    const auto sizes = adaptation.adapt(tables);
+    hot.numBuckets = sizes[0];
+    cold.numBuckets = sizes[1];
+    return sizes;
+  };
+  EXPECT_EQ(round(), (std::vector<std::size_t>{2048U, 2048U, 1U}));
+  EXPECT_EQ(round(), (std::vector<std::size_t>{4096U, 1024U, 1U}));
+  // growing further would exceed the memory budget
+  EXPECT_EQ(round(), (std::vector<std::size_t>{4096U, 1024U, 1U}));
+
+  const auto& decisions = adaptation.getDecisions();
+  ASSERT_EQ(decisions.size(), 5U);
+  EXPECT_EQ(decisions[0].table, "cold");
+  EXPECT_EQ(decisions[0].reason, "cold");
+  EXPECT_EQ(decisions[1].table, "hot");
+  EXPECT_EQ(decisions[1].reason, "collisions");
+  EXPECT_DOUBLE_EQ(decisions[1].colRatio, .5);
+  EXPECT_DOUBLE_EQ(decisions[1].hitRatio, .2);
+  EXPECT_EQ(decisions[4].reason, "budget");
+  EXPECT_EQ(decisions[4].round, 3U);
+  EXPECT_EQ(decisions[4].fromBuckets, decisions[4].toBuckets);
+
+  const auto j = adaptation.json();
+  EXPECT_EQ(j["rounds"], 3U);
+  EXPECT_EQ(j["grows"], 2U);
+  EXPECT_EQ(j["shrinks"], 2U);
+  EXPECT_EQ(j["denied_grows"], 1U);
+  EXPECT_DOUBLE_EQ(j["memory_MiB"].get<double>(), 5.);
+  EXPECT_EQ(j["tables"]["hot"]["num_buckets"], 4096U);
+  EXPECT_FALSE(j["tables"].contains("disabled"));
+  EXPECT_EQ(j["decisions"].size(), 5U);
+}
+
+TEST(DDPackageTest, AdaptiveComputeTablesPreserveResults) {
+  const auto nqubits = 6U;
+  auto reference = std::make_unique<dd::Package<>>(nqubits);
+  auto dd = std::make_unique<dd::Package<>>(nqubits);
+  dd->computeTableAdaptation.config.enabled = true;
+  dd->computeTableAdaptation.config.interval = 1U;
+  dd->computeTableAdaptation.config.minLookups = 1U;
+  dd->computeTableAdaptation.config.growCollisionRatio = 0.;
+
+  const auto simulate = [](dd::Package<>& package) {
+    auto state = package.makeZeroState(nqubits);
+    package.incRef(state);
+    for (std::size_t layer = 0U; layer < 4U; ++layer) {
+      for (qc::Qubit q = 0U; q < nqubits; ++q) {
+        auto gate = package.makeGateDD(dd::H_MAT, q);
+        if (q > 0U) {
+          const auto lambda = 0.1 * static_cast<dd::fp>(layer + 1U);
+          gate = package.multiply(
+              package.makeGateDD(dd::pMat(lambda), qc::Control{q - 1U}, q),
+              gate);
+        }
+        auto next = package.multiply(gate, state);
+        package.incRef(next);
+        package.decRef(state);
+        state = next;
+        package.garbageCollect();
+      }
+    }
+    return state;
+  };
+
+  const auto expected = simulate(*reference).getVector();
+  const auto state = simulate(*dd);
+  const auto actual = state.getVector();
+  ASSERT_EQ(actual.size(), expected.size());
+  for (std::size_t i = 0U; i < actual.size(); ++i) {
+    EXPECT_NEAR(actual[i].real(), expected[i].real(), 1e-10);
+    EXPECT_NEAR(actual[i].imag(), expected[i].imag(), 1e-10);
+  }
+
+  // unused tables shrink down to the minimum size
+  EXPECT_EQ(dd->matrixKronecker.getNumBuckets(),
+            dd->computeTableAdaptation.config.minBuckets);
+  const auto stats = dd::getStatistics(dd.get());
+  ASSERT_TRUE(stats.contains("compute_table_adaptation"));
+  const auto& adaptation = stats["compute_table_adaptation"];
+  EXPECT_EQ(adaptation["rounds"], 4U * nqubits);
+  EXPECT_FALSE(adaptation["decisions"].empty());
+  EXPECT_LE(adaptation["memory_MiB"].get<double>(),
+            dd->computeTableAdaptation.config.memoryBudgetMiB);
+  EXPECT_FALSE(dd::getStatistics(reference.get())
+                   .contains("compute_table_adaptation"));
+}
+
 TEST(DDPackageTest, ReduceAncillaRegression) {
   auto dd = std::make_unique<dd::Package<>>(2);
   const auto inputMatrix =
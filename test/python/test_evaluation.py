@@ -23,6 +23,8 @@ def test_flatten_dict() -> None:
     assert __flatten_dict(d1) == {"a.b.main": 1}
     d2 = {"a": {"b": {"main": 1, "feature": 2}}, "d": {"main": 2}}
     assert __flatten_dict(d2) == {"a.b.main": 1, "a.b.feature": 2, "d.main": 2}
+    d3 = {"a": {"grows": 2, "decisions": [{"table": "vector_add"}]}}
+    assert __flatten_dict(d3) == {"a.grows": 2}
 
 
 def test_post_processing() -> None: